@@ -0,0 +1,196 @@
+#ifndef __ARENA__
+#define __ARENA__
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace cAllocator {
+
+/**
+ * @brief 单调（bump-pointer）内存区域
+ *
+ * 在当前内存块中顺序分配，块用完时从上游资源申请新块，块大小按 2 倍增长直到 kMaxBlockSize；
+ * 单独释放不做任何事情，Reset 时一次性回收，适合按请求创建、请求结束即整体丢弃的临时对象。
+ * 本身是 std::pmr::memory_resource，可直接用于 std::pmr 容器或其他接受 memory_resource 的组件。
+ * 不是线程安全的，每个线程/请求使用自己的 Arena
+ */
+class Arena : public std::pmr::memory_resource {
+   public:
+    static constexpr size_t kDefaultBlockSize = 4096;
+    static constexpr size_t kMaxBlockSize = 1024 * 1024;
+
+    /**
+     * @param block_size 第一个内存块的大小
+     * @param upstream 申请内存块使用的上游资源
+     */
+    explicit Arena(size_t block_size = kDefaultBlockSize,
+                   std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream), next_block_size_(std::max<size_t>(block_size, sizeof(Block) * 2)) {}
+
+    /**
+     * @brief 使用调用者提供的初始缓冲区（例如栈上数组），用完后再向上游申请；缓冲区由调用者负责释放
+     */
+    Arena(void* buffer, size_t size, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : Arena(std::max<size_t>(size * 2, kDefaultBlockSize), upstream) {
+        initial_buffer_ = static_cast<char*>(buffer);
+        initial_size_ = size;
+        SetCurrent(initial_buffer_, initial_size_);
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() override { Release(); }
+
+    /**
+     * @brief 分配 bytes 字节，alignment 需为 2 的幂
+     */
+    void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        void* ptr = TryCarve(bytes, alignment);
+        if (ptr == nullptr) {
+            Grow(bytes + alignment);
+            ptr = TryCarve(bytes, alignment);
+        }
+        used_bytes_ += bytes;
+        return ptr;
+    }
+
+    /**
+     * @brief 在 Arena 上构造对象，非平凡析构的对象会在 Reset/析构时按构造的逆序析构
+     */
+    template <typename T, typename... Args>
+    T* Create(Args&&... args) {
+        if constexpr (std::is_trivially_destructible<T>::value) {
+            return ::new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        } else {
+            // 先分配析构记录，保证对象构造成功后登记不会失败
+            void* node_memory = Allocate(sizeof(DestructorNode), alignof(DestructorNode));
+            T* object = ::new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            destructors_ = ::new (node_memory) DestructorNode{&DestroyObject<T>, object, destructors_};
+            return object;
+        }
+    }
+
+    /**
+     * @brief 析构 Create 创建的对象并回收所有内存，只保留最后（最大）的一个内存块供之后复用
+     */
+    void Reset() {
+        RunDestructors();
+        Block* keep = head_;
+        if (keep != nullptr) {
+            FreeBlocks(keep->prev);
+            keep->prev = nullptr;
+            SetCurrent(reinterpret_cast<char*>(keep) + sizeof(Block), keep->size - sizeof(Block));
+            reserved_bytes_ = keep->size;
+        } else {
+            SetCurrent(initial_buffer_, initial_size_);
+        }
+        used_bytes_ = 0;
+    }
+
+    /**
+     * @brief 析构 Create 创建的对象并把所有内存块还给上游资源
+     */
+    void Release() {
+        RunDestructors();
+        FreeBlocks(head_);
+        head_ = nullptr;
+        reserved_bytes_ = 0;
+        used_bytes_ = 0;
+        SetCurrent(initial_buffer_, initial_size_);
+    }
+
+    // 已分配给调用者的字节数
+    size_t GetUsedBytes() const { return used_bytes_; }
+
+    // 从上游申请的字节数（不包括初始缓冲区）
+    size_t GetReservedBytes() const { return reserved_bytes_; }
+
+   protected:
+    void* do_allocate(size_t bytes, size_t alignment) override { return Allocate(bytes, alignment); }
+
+    // 单独释放不回收内存，Reset 时统一回收
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+   private:
+    struct Block {
+        Block* prev;
+        size_t size;  // 包括 Block 头部在内的总大小
+    };
+
+    struct DestructorNode {
+        void (*destroy)(void*);
+        void* object;
+        DestructorNode* next;
+    };
+
+    template <typename T>
+    static void DestroyObject(void* object) {
+        static_cast<T*>(object)->~T();
+    }
+
+    void SetCurrent(char* begin, size_t size) {
+        current_ = begin;
+        end_ = begin != nullptr ? begin + size : nullptr;
+    }
+
+    void* TryCarve(size_t bytes, size_t alignment) {
+        if (current_ == nullptr) {
+            return nullptr;
+        }
+        uintptr_t pos = reinterpret_cast<uintptr_t>(current_);
+        uintptr_t aligned = (pos + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        if (aligned + bytes > reinterpret_cast<uintptr_t>(end_)) {
+            return nullptr;
+        }
+        current_ = reinterpret_cast<char*>(aligned + bytes);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    void Grow(size_t min_bytes) {
+        size_t size = std::max(next_block_size_, min_bytes + sizeof(Block));
+        void* memory = upstream_->allocate(size, alignof(std::max_align_t));
+        head_ = ::new (memory) Block{head_, size};
+        reserved_bytes_ += size;
+        SetCurrent(static_cast<char*>(memory) + sizeof(Block), size - sizeof(Block));
+        next_block_size_ = std::min(next_block_size_ * 2, std::max(kMaxBlockSize, next_block_size_));
+    }
+
+    void FreeBlocks(Block* block) {
+        while (block != nullptr) {
+            Block* prev = block->prev;
+            upstream_->deallocate(block, block->size, alignof(std::max_align_t));
+            block = prev;
+        }
+    }
+
+    void RunDestructors() {
+        while (destructors_ != nullptr) {
+            DestructorNode* node = destructors_;
+            destructors_ = node->next;
+            node->destroy(node->object);
+        }
+    }
+
+    std::pmr::memory_resource* upstream_;
+    size_t next_block_size_;
+    Block* head_ = nullptr;
+    char* current_ = nullptr;
+    char* end_ = nullptr;
+    char* initial_buffer_ = nullptr;
+    size_t initial_size_ = 0;
+    DestructorNode* destructors_ = nullptr;
+    size_t used_bytes_ = 0;
+    size_t reserved_bytes_ = 0;
+};
+
+}  // namespace cAllocator
+
+#endif  // __ARENA__
@@ -0,0 +1,146 @@
+#ifndef __SIZE_CLASS_POOL__
+#define __SIZE_CLASS_POOL__
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace cAllocator {
+
+/**
+ * @brief 不加锁的互斥量，用于单线程的 SizeClassPool
+ */
+struct NullMutex {
+    void lock() {}
+    void unlock() {}
+};
+
+/**
+ * @brief 按大小分级的内存池
+ *
+ * 请求按 2 的幂归入 16 ~ kMaxClassSize 字节的若干级别，每个级别维护一条空闲链表，
+ * 链表为空时从上游申请 chunk_size 字节的大块切分；释放的内存回到对应级别的空闲链表，析构或 Release 时统一归还上游。
+ * 超过 kMaxClassSize 或对齐要求超过 max_align_t 的请求直接转给上游资源。
+ * 本身是 std::pmr::memory_resource
+ * @tparam Mutex 保护空闲链表的互斥量，NullMutex 表示只在单线程中使用
+ */
+template <typename Mutex>
+class BasicSizeClassPool : public std::pmr::memory_resource {
+   public:
+    static constexpr size_t kMinClassSize = 16;
+    static constexpr size_t kMaxClassSize = 4096;
+    static constexpr size_t kClassNum = 9;  // 16, 32, ..., 4096
+    static constexpr size_t kDefaultChunkSize = 64 * 1024;
+
+    /**
+     * @param chunk_size 每次向上游申请的大块大小
+     * @param upstream 上游资源
+     */
+    explicit BasicSizeClassPool(size_t chunk_size = kDefaultChunkSize,
+                                std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream), chunk_size_(std::max(chunk_size, kMaxClassSize)) {}
+
+    BasicSizeClassPool(const BasicSizeClassPool&) = delete;
+    BasicSizeClassPool& operator=(const BasicSizeClassPool&) = delete;
+
+    ~BasicSizeClassPool() override { Release(); }
+
+    /**
+     * @brief 把所有大块还给上游资源，之前分配出去的内存全部失效
+     */
+    void Release() {
+        std::lock_guard<Mutex> lock(mutex_);
+        for (void* chunk : chunks_) {
+            upstream_->deallocate(chunk, chunk_size_, alignof(std::max_align_t));
+        }
+        chunks_.clear();
+        std::fill(free_lists_, free_lists_ + kClassNum, nullptr);
+    }
+
+    // 已向上游申请的大块数量
+    size_t GetChunkCount() const {
+        std::lock_guard<Mutex> lock(mutex_);
+        return chunks_.size();
+    }
+
+    // bytes 所属级别的块大小，超过 kMaxClassSize 时返回 0
+    static constexpr size_t GetClassSize(size_t bytes) {
+        return bytes > kMaxClassSize ? 0 : kMinClassSize << ClassIndex(bytes);
+    }
+
+   protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (bytes > kMaxClassSize || alignment > alignof(std::max_align_t)) {
+            return upstream_->allocate(bytes, alignment);
+        }
+        size_t index = ClassIndex(bytes);
+        std::lock_guard<Mutex> lock(mutex_);
+        if (free_lists_[index] == nullptr) {
+            Refill(index);
+        }
+        FreeNode* node = free_lists_[index];
+        free_lists_[index] = node->next;
+        return node;
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        if (bytes > kMaxClassSize || alignment > alignof(std::max_align_t)) {
+            upstream_->deallocate(ptr, bytes, alignment);
+            return;
+        }
+        size_t index = ClassIndex(bytes);
+        std::lock_guard<Mutex> lock(mutex_);
+        FreeNode* node = static_cast<FreeNode*>(ptr);
+        node->next = free_lists_[index];
+        free_lists_[index] = node;
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+   private:
+    struct FreeNode {
+        FreeNode* next;
+    };
+
+    static constexpr size_t ClassIndex(size_t bytes) {
+        size_t index = 0;
+        size_t size = kMinClassSize;
+        while (size < bytes) {
+            size <<= 1;
+            ++index;
+        }
+        return index;
+    }
+
+    // 申请一个大块并切分到 index 级别的空闲链表，调用者需持有 mutex_
+    void Refill(size_t index) {
+        char* chunk = static_cast<char*>(upstream_->allocate(chunk_size_, alignof(std::max_align_t)));
+        chunks_.push_back(chunk);
+        size_t block_size = kMinClassSize << index;
+        for (size_t offset = chunk_size_ / block_size * block_size; offset > 0;) {
+            offset -= block_size;
+            FreeNode* node = reinterpret_cast<FreeNode*>(chunk + offset);
+            node->next = free_lists_[index];
+            free_lists_[index] = node;
+        }
+    }
+
+    std::pmr::memory_resource* upstream_;
+    size_t chunk_size_;
+    mutable Mutex mutex_;
+    FreeNode* free_lists_[kClassNum] = {};
+    std::vector<void*> chunks_;
+};
+
+// 单线程使用的分级内存池
+using SizeClassPool = BasicSizeClassPool<NullMutex>;
+
+// 线程安全的分级内存池，可以在不同线程分配和释放
+using SyncSizeClassPool = BasicSizeClassPool<std::mutex>;
+
+}  // namespace cAllocator
+
+#endif  // __SIZE_CLASS_POOL__
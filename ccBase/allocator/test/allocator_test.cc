@@ -0,0 +1,174 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include "arena.h"
+#include "async_callback.h"
+#include "pub_sub.h"
+#include "size_class_pool.h"
+#include "thread_pool.h"
+
+using namespace cAllocator;
+using std::cout;
+using std::endl;
+
+void TestArena() {
+    cout << "\n========== 测试1: 单调内存区域 ==========" << endl;
+
+    Arena arena(256);
+    void* a = arena.Allocate(3, 1);
+    void* b = arena.Allocate(sizeof(double), alignof(double));
+    void* c = arena.Allocate(1000, 64);
+    cout << "对齐检查: " << (reinterpret_cast<uintptr_t>(b) % alignof(double) == 0 ? "通过" : "失败") << ", "
+         << (reinterpret_cast<uintptr_t>(c) % 64 == 0 ? "通过" : "失败") << endl;
+    cout << "a/b 连续分配: " << (static_cast<char*>(b) - static_cast<char*>(a) < 16 ? "是" : "否") << endl;
+    cout << "已使用 " << arena.GetUsedBytes() << " 字节，已申请 " << arena.GetReservedBytes() << " 字节" << endl;
+
+    // 非平凡析构的对象在 Reset 时析构
+    static int destroyed = 0;
+    struct Tracked {
+        std::string name;
+        explicit Tracked(std::string n) : name(std::move(n)) {}
+        ~Tracked() { destroyed++; }
+    };
+    for (int i = 0; i < 10; ++i) {
+        arena.Create<Tracked>("对象 " + std::to_string(i));
+    }
+    arena.Reset();
+    cout << "Reset 析构对象数: " << destroyed << "（期望 10），保留 " << arena.GetReservedBytes() << " 字节" << endl;
+
+    // 栈上初始缓冲区 + pmr 容器
+    char buffer[1024];
+    Arena stack_arena(buffer, sizeof(buffer));
+    std::pmr::vector<int> numbers(&stack_arena);
+    for (int i = 0; i < 100; ++i) {
+        numbers.push_back(i);
+    }
+    cout << "栈缓冲区容纳 pmr::vector 后向上游申请: " << stack_arena.GetReservedBytes() << " 字节" << endl;
+}
+
+void TestSizeClassPool() {
+    cout << "\n========== 测试2: 分级内存池 ==========" << endl;
+
+    SizeClassPool pool;
+    void* first = pool.allocate(40);
+    pool.deallocate(first, 40);
+    void* second = pool.allocate(60);
+    cout << "同一级别复用释放的内存: " << (first == second ? "是" : "否") << endl;
+    pool.deallocate(second, 60);
+    cout << "40 字节所属级别: " << SizeClassPool::GetClassSize(40) << "，大块数量: " << pool.GetChunkCount() << endl;
+
+    void* large = pool.allocate(10000);
+    pool.deallocate(large, 10000);
+    cout << "大于 " << SizeClassPool::kMaxClassSize << " 字节的请求交给上游，大块数量仍为 " << pool.GetChunkCount()
+         << endl;
+
+    std::pmr::unordered_map<int, std::pmr::string> map(&pool);
+    for (int i = 0; i < 1000; ++i) {
+        map.emplace(i, "value with a string longer than sso " + std::to_string(i));
+    }
+    cout << "pmr::unordered_map 插入 1000 项后大块数量: " << pool.GetChunkCount() << endl;
+}
+
+void TestPerformance() {
+    cout << "\n========== 测试3: 性能对比 ==========" << endl;
+
+    const int rounds = 1000;
+    const int allocs = 100;
+    auto run = [&](std::pmr::memory_resource* resource, auto&& after_round) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < rounds; ++r) {
+            std::pmr::vector<std::pmr::string> strings(resource);
+            for (int i = 0; i < allocs; ++i) {
+                strings.emplace_back("a string that does not fit in the small buffer");
+            }
+            strings = std::pmr::vector<std::pmr::string>(resource);
+            after_round();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    };
+
+    auto heap_us = run(std::pmr::new_delete_resource(), []() {});
+    Arena arena;
+    auto arena_us = run(&arena, [&arena]() { arena.Reset(); });
+    SizeClassPool pool;
+    auto pool_us = run(&pool, []() {});
+    cout << "new/delete: " << heap_us << " us, Arena: " << arena_us << " us, SizeClassPool: " << pool_us << " us"
+         << endl;
+}
+
+void TestComponentResources() {
+    cout << "\n========== 测试4: 组件使用内存资源 ==========" << endl;
+
+    // 线程池：大任务从线程安全的分级内存池分配
+    SyncSizeClassPool task_pool;
+    cThread::ThreadPool::ThreadPoolConfig config{2, 2, 64, std::chrono::seconds(4)};
+    config.task_resource = &task_pool;
+    cThread::ThreadPool thread_pool(config);
+    thread_pool.Start();
+    std::atomic<int> sum{0};
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < 100; ++i) {
+        char payload[128] = {};
+        payload[0] = static_cast<char>(i);
+        futures.push_back(thread_pool.Submit([payload, &sum]() {
+            sum += payload[0];
+            return static_cast<int>(payload[0]);
+        }));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+    thread_pool.ShutDown();
+    cout << "线程池任务结果: " << sum.load() << "（期望 4950），分级内存池大块数量: " << task_pool.GetChunkCount()
+         << endl;
+
+    // 发布订阅：复制订阅者列表使用分级内存池
+    SyncSizeClassPool publish_pool;
+    cPubSub::PubSub<std::string> pubsub(&publish_pool);
+    int received = 0;
+    for (int i = 0; i < 4; ++i) {
+        pubsub.Subscribe("request", [&received](const std::string&, const std::string&) { received++; });
+    }
+    pubsub.Publish("request", "hello");
+    cout << "订阅者收到消息: " << received << "（期望 4）" << endl;
+
+    // 异步回调：回调队列使用 Arena
+    Arena arena;
+    {
+        cAsync::AsyncCallback callbacks(&arena);
+        std::atomic<int> done{0};
+        for (int i = 0; i < 10; ++i) {
+            callbacks.Post([&done]() { done++; });
+        }
+        callbacks.WaitAll();
+        cout << "异步回调完成: " << done.load() << "（期望 10），Arena 已使用 " << arena.GetUsedBytes() << " 字节"
+             << endl;
+    }
+}
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "    内存分配模块测试程序" << endl;
+    cout << "========================================" << endl;
+
+    try {
+        TestArena();
+        TestSizeClassPool();
+        TestPerformance();
+        TestComponentResources();
+
+        cout << "\n========================================" << endl;
+        cout << "    所有测试完成！" << endl;
+        cout << "========================================" << endl;
+    } catch (const std::exception& e) {
+        cout << "测试异常: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
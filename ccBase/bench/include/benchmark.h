@@ -0,0 +1,384 @@
+#ifndef __BENCHMARK__
+#define __BENCHMARK__
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "metrics.h"
+
+namespace cBench {
+
+/**
+ * @brief 一次运行中所有线程共享的数据：起跑栅栏、计时、计数器和延迟直方图
+ */
+struct RunContext {
+    int threads = 1;
+    int waiting = 0;
+    bool started = false;
+    uint64_t start_ns = 0;
+    uint64_t stop_ns = 0;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::map<std::string, double> counters;
+    cMetrics::Histogram latency_ns;
+};
+
+/**
+ * @brief 传给性能测试函数的状态，用法与 google benchmark 相同：
+ *   void Bench(cBench::State& state) { 准备; for (auto _ : state) { 被测代码; } }
+ * 所有线程都进入循环后才开始计时，最后一个线程走完循环时停止计时，循环之外的准备工作不计入耗时
+ */
+class State {
+   public:
+    // 循环变量的类型，标记为 maybe_unused 避免 for (auto _ : state) 产生未使用变量的警告
+    struct [[maybe_unused]] Value {};
+
+    struct Iterator {
+        State* state;
+        size_t remaining;
+
+        bool operator!=(const Iterator&) {
+            if (remaining != 0) {
+                return true;
+            }
+            state->Finish();
+            return false;
+        }
+        void operator++() { --remaining; }
+        Value operator*() const { return {}; }
+    };
+
+    State(RunContext* context, int thread_index, size_t iterations, int64_t arg, uint64_t seed)
+        : context_(context), thread_index_(thread_index), iterations_(iterations), arg_(arg), seed_(seed | 1) {}
+
+    Iterator begin() {
+        Start();
+        return {this, iterations_};
+    }
+    Iterator end() { return {this, 0}; }
+
+    // 每个线程的循环次数
+    size_t iterations() const { return iterations_; }
+    int threads() const { return context_->threads; }
+    // 线程下标，Setup/Teardown 中为 -1
+    int thread_index() const { return thread_index_; }
+    // Arg 设置的参数，没有设置时为 0
+    int64_t arg() const { return arg_; }
+
+    /**
+     * @brief 由固定种子生成的伪随机数，同一线程下标每次运行得到相同的序列
+     */
+    uint64_t Random() {
+        seed_ ^= seed_ << 13;
+        seed_ ^= seed_ >> 7;
+        seed_ ^= seed_ << 17;
+        return seed_;
+    }
+
+    /**
+     * @brief 记录一次操作的延迟（纳秒），结果中输出所有线程合并后的 p50/p99
+     */
+    void RecordLatency(uint64_t latency_ns) { context_->latency_ns.Record(latency_ns); }
+
+    /**
+     * @brief 设置结果中额外输出的指标，例如丢弃数、命中率，同名指标以最后一次设置为准
+     */
+    void SetCounter(const std::string& name, double value) {
+        std::lock_guard<std::mutex> lock(context_->mutex);
+        context_->counters[name] = value;
+    }
+
+    /**
+     * @brief 输出组件自身记录的直方图（例如 ThreadPool::Metrics::queue_wait_ns）的 p50/p99，没有记录时不输出
+     */
+    void SetHistogram(const std::string& name, const cMetrics::HistogramSnapshot& snapshot) {
+        if (snapshot.count == 0) {
+            return;
+        }
+        SetCounter(name + ".p50", static_cast<double>(snapshot.Percentile(50)));
+        SetCounter(name + ".p99", static_cast<double>(snapshot.Percentile(99)));
+    }
+
+   private:
+    // 起跑栅栏：最后一个到达的线程开始计时并放行所有线程
+    void Start() {
+        std::unique_lock<std::mutex> lock(context_->mutex);
+        if (++context_->waiting == context_->threads) {
+            context_->started = true;
+            context_->start_ns = cMetrics::NowNs();
+            context_->cv.notify_all();
+        } else {
+            context_->cv.wait(lock, [this] { return context_->started; });
+        }
+    }
+
+    void Finish() {
+        uint64_t now = cMetrics::NowNs();
+        std::lock_guard<std::mutex> lock(context_->mutex);
+        context_->stop_ns = std::max(context_->stop_ns, now);
+    }
+
+    RunContext* context_;
+    int thread_index_;
+    size_t iterations_;
+    int64_t arg_;
+    uint64_t seed_;
+};
+
+/**
+ * @brief 一个性能测试及其参数，由 CBENCH 注册，支持链式设置
+ */
+class Benchmark {
+   public:
+    using Function = std::function<void(State&)>;
+
+    Benchmark(std::string name, Function function) : name_(std::move(name)), function_(std::move(function)) {}
+
+    // 追加一种线程数，多次调用形成线程数扫描
+    Benchmark* Threads(int threads) {
+        threads_.push_back(std::max(threads, 1));
+        return this;
+    }
+
+    // 从 min 到 max 按 2 的倍数扫描线程数
+    Benchmark* ThreadRange(int min, int max) {
+        for (int threads = std::max(min, 1); threads <= max; threads *= 2) {
+            threads_.push_back(threads);
+        }
+        return this;
+    }
+
+    // 追加一个参数，通过 State::arg 读取，多个参数分别运行
+    Benchmark* Arg(int64_t arg) {
+        args_.push_back(arg);
+        return this;
+    }
+
+    // 每个线程的循环次数
+    Benchmark* Iterations(size_t iterations) {
+        iterations_ = std::max<size_t>(iterations, 1);
+        return this;
+    }
+
+    // 每次运行前在主线程中调用，用于创建所有线程共享的被测对象
+    Benchmark* Setup(Function setup) {
+        setup_ = std::move(setup);
+        return this;
+    }
+
+    // 每次运行后在主线程中调用，此时所有线程已经结束，可以读取组件指标并 SetCounter
+    Benchmark* Teardown(Function teardown) {
+        teardown_ = std::move(teardown);
+        return this;
+    }
+
+    const std::string& name() const { return name_; }
+
+   private:
+    friend class Runner;
+
+    std::string name_;
+    Function function_;
+    Function setup_;
+    Function teardown_;
+    std::vector<int> threads_;
+    std::vector<int64_t> args_;
+    size_t iterations_ = 100000;
+};
+
+inline std::vector<std::unique_ptr<Benchmark>>& Benchmarks() {
+    static std::vector<std::unique_ptr<Benchmark>> benchmarks;
+    return benchmarks;
+}
+
+inline Benchmark* Register(const char* name, Benchmark::Function function) {
+    Benchmarks().push_back(std::make_unique<Benchmark>(name, std::move(function)));
+    return Benchmarks().back().get();
+}
+
+/**
+ * @brief 运行注册的性能测试并输出结果
+ * 每种 参数 x 线程数 先预热一次，再运行 repetitions 次，ns/op 和 ops/s 取中位数，
+ * 延迟分位数由所有重复合并后计算，其余指标取最后一次运行
+ */
+class Runner {
+   public:
+    struct Options {
+        std::string filter;
+        int repetitions = 3;
+        bool warmup = true;
+        uint64_t seed = 42;
+        bool csv = false;
+    };
+
+    explicit Runner(Options options) : options_(std::move(options)) {}
+
+    int RunAll() {
+        if (options_.csv) {
+            std::printf("name,threads,iterations,ns_per_op,ops_per_sec,cv,p50_ns,p99_ns,counters\n");
+        } else {
+            std::printf("%-48s %12s %14s %6s %10s %10s  %s\n", "Benchmark", "ns/op", "ops/s", "cv", "p50(ns)",
+                        "p99(ns)", "counters");
+            std::printf("%s\n", std::string(120, '-').c_str());
+        }
+        for (const auto& benchmark : Benchmarks()) {
+            if (!options_.filter.empty() && benchmark->name().find(options_.filter) == std::string::npos) {
+                continue;
+            }
+            std::vector<int> thread_counts = benchmark->threads_.empty() ? std::vector<int>{1} : benchmark->threads_;
+            std::vector<int64_t> args = benchmark->args_.empty() ? std::vector<int64_t>{0} : benchmark->args_;
+            for (int64_t arg : args) {
+                for (int threads : thread_counts) {
+                    RunOne(*benchmark, arg, threads);
+                }
+            }
+        }
+        return 0;
+    }
+
+   private:
+    struct RunResult {
+        double ns_per_op = 0;
+        std::map<std::string, double> counters;
+        cMetrics::HistogramSnapshot latency_ns;
+    };
+
+    RunResult RunOnce(Benchmark& benchmark, int64_t arg, int threads) {
+        RunContext context;
+        context.threads = threads;
+        State main_state(&context, -1, benchmark.iterations_, arg, options_.seed);
+        if (benchmark.setup_) {
+            benchmark.setup_(main_state);
+        }
+        std::vector<std::thread> workers;
+        for (int i = 0; i < threads; ++i) {
+            workers.emplace_back([&benchmark, &context, this, arg, i]() {
+                State state(&context, i, benchmark.iterations_, arg, options_.seed + 0x9e3779b97f4a7c15ULL * (i + 1));
+                benchmark.function_(state);
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        if (benchmark.teardown_) {
+            benchmark.teardown_(main_state);
+        }
+        RunResult result;
+        double total_ops = static_cast<double>(benchmark.iterations_) * threads;
+        result.ns_per_op = static_cast<double>(context.stop_ns - context.start_ns) / total_ops;
+        result.counters = context.counters;
+        result.latency_ns = context.latency_ns.Snapshot();
+        return result;
+    }
+
+    void RunOne(Benchmark& benchmark, int64_t arg, int threads) {
+        if (options_.warmup) {
+            RunOnce(benchmark, arg, threads);
+        }
+        std::vector<double> ns_per_op;
+        RunResult last;
+        cMetrics::HistogramSnapshot latency_ns;
+        for (int i = 0; i < std::max(options_.repetitions, 1); ++i) {
+            last = RunOnce(benchmark, arg, threads);
+            ns_per_op.push_back(last.ns_per_op);
+            latency_ns.Merge(last.latency_ns);
+        }
+        std::sort(ns_per_op.begin(), ns_per_op.end());
+        double median = ns_per_op[ns_per_op.size() / 2];
+        double mean = 0;
+        for (double value : ns_per_op) {
+            mean += value;
+        }
+        mean /= static_cast<double>(ns_per_op.size());
+        double variance = 0;
+        for (double value : ns_per_op) {
+            variance += (value - mean) * (value - mean);
+        }
+        double cv = mean > 0 ? std::sqrt(variance / static_cast<double>(ns_per_op.size())) / mean : 0;
+
+        std::string name = benchmark.name();
+        if (!benchmark.args_.empty()) {
+            name += "/" + std::to_string(arg);
+        }
+        name += "/threads:" + std::to_string(threads);
+        std::string counters;
+        for (const auto& counter : last.counters) {
+            // 整数原样输出，比例等小数保留 3 位
+            char value[64];
+            if (counter.second == std::floor(counter.second)) {
+                std::snprintf(value, sizeof(value), "%.0f", counter.second);
+            } else {
+                std::snprintf(value, sizeof(value), "%.3f", counter.second);
+            }
+            counters += (counters.empty() ? "" : options_.csv ? ";" : " ") + counter.first + "=" + value;
+        }
+        double ops_per_sec = median > 0 ? 1e9 / median : 0;
+        if (options_.csv) {
+            std::printf("%s,%d,%zu,%.2f,%.0f,%.3f,%llu,%llu,%s\n", name.c_str(), threads, benchmark.iterations_,
+                        median, ops_per_sec, cv, static_cast<unsigned long long>(latency_ns.Percentile(50)),
+                        static_cast<unsigned long long>(latency_ns.Percentile(99)), counters.c_str());
+        } else {
+            std::string p50 = latency_ns.count == 0 ? "-" : std::to_string(latency_ns.Percentile(50));
+            std::string p99 = latency_ns.count == 0 ? "-" : std::to_string(latency_ns.Percentile(99));
+            std::printf("%-48s %12.1f %14.0f %5.1f%% %10s %10s  %s\n", name.c_str(), median, ops_per_sec, cv * 100,
+                        p50.c_str(), p99.c_str(), counters.c_str());
+        }
+        std::fflush(stdout);
+    }
+
+    Options options_;
+};
+
+/**
+ * @brief 解析 --filter=子串 --repetitions=N --seed=N --no_warmup --format=csv 并运行
+ */
+inline int RunMain(int argc, char** argv) {
+    Runner::Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&arg](const char* prefix) { return arg.substr(std::strlen(prefix)); };
+        if (arg.rfind("--filter=", 0) == 0) {
+            options.filter = value("--filter=");
+        } else if (arg.rfind("--repetitions=", 0) == 0) {
+            options.repetitions = std::atoi(value("--repetitions=").c_str());
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            options.seed = std::strtoull(value("--seed=").c_str(), nullptr, 10);
+        } else if (arg == "--no_warmup") {
+            options.warmup = false;
+        } else if (arg == "--format=csv") {
+            options.csv = true;
+        } else {
+            std::fprintf(stderr, "usage: %s [--filter=NAME] [--repetitions=N] [--seed=N] [--no_warmup] [--format=csv]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+    return Runner(options).RunAll();
+}
+
+}  // namespace cBench
+
+#define CBENCH_CONCAT_IMPL(a, b) a##b
+#define CBENCH_CONCAT(a, b) CBENCH_CONCAT_IMPL(a, b)
+
+/**
+ * 注册性能测试：CBENCH(BenchFunc)->ThreadRange(1, 8)->Iterations(100000);
+ */
+#define CBENCH(function) \
+    static ::cBench::Benchmark* CBENCH_CONCAT(cbench_registered_, __LINE__) = ::cBench::Register(#function, function)
+
+#define CBENCH_MAIN() \
+    int main(int argc, char** argv) { return ::cBench::RunMain(argc, argv); }
+
+#endif  // __BENCHMARK__
@@ -0,0 +1,79 @@
+#include <cstdint>
+#include <string>
+#include "benchmark.h"
+#include "logger.h"
+
+using cLogger::Logger;
+using cLogger::LoggerConfig;
+
+namespace {
+
+// Logger 是单例，指标在多次运行之间累计，每次运行开始时记下当时的指标，结束时输出差值
+cLogger::LoggerMetrics baseline;
+
+// 不输出到控制台和文件，只测试格式化、入队和后台线程的消费
+void StartLogger(bool async_mode, cLogger::OverflowPolicy policy, bool deferred_mode = false) {
+    LoggerConfig config;
+    config.enable_console = false;
+    config.async_mode = async_mode;
+    config.overflow_policy = policy;
+    config.async_queue_size = 1024;
+    config.deferred_mode = deferred_mode;
+    Logger::GetInstance().Initialize(config);
+    baseline = Logger::GetInstance().GetMetrics();
+}
+
+void StopLogger(cBench::State& state) {
+    Logger& logger = Logger::GetInstance();
+    cLogger::LoggerMetrics metrics = logger.GetMetrics();
+    state.SetCounter("queue_depth", static_cast<double>(metrics.queue_depth));
+    logger.Flush();
+    metrics = logger.GetMetrics();
+    metrics.emit_ns.Subtract(baseline.emit_ns);
+    metrics.block_wait_ns.Subtract(baseline.block_wait_ns);
+    state.SetHistogram("emit_ns", metrics.emit_ns);
+    state.SetHistogram("block_wait_ns", metrics.block_wait_ns);
+    state.SetCounter("dropped", static_cast<double>(metrics.dropped - baseline.dropped));
+    state.SetCounter("blocked", static_cast<double>(metrics.blocked - baseline.blocked));
+    logger.Shutdown();
+}
+
+void LogSync(cBench::State& state) {
+    for (auto _ : state) {
+        LOG_INFO("benchmark message with some payload");
+    }
+}
+
+void LogAsyncDrop(cBench::State& state) {
+    for (auto _ : state) {
+        LOG_INFO("benchmark message with some payload");
+    }
+}
+
+void LogAsyncBlock(cBench::State& state) {
+    for (auto _ : state) {
+        LOG_INFO("benchmark message with some payload");
+    }
+}
+
+// 延迟格式化：调用线程只编码参数
+void LogDeferred(cBench::State& state) {
+    uint64_t value = state.Random();
+    for (auto _ : state) {
+        LOGF_INFO("request {} finished in {} us", value, 42);
+    }
+}
+
+void SetupSync(cBench::State&) { StartLogger(false, cLogger::OverflowPolicy::BLOCK); }
+void SetupAsyncDrop(cBench::State&) { StartLogger(true, cLogger::OverflowPolicy::DROP_AND_COUNT); }
+void SetupAsyncBlock(cBench::State&) { StartLogger(true, cLogger::OverflowPolicy::BLOCK); }
+void SetupDeferred(cBench::State&) { StartLogger(true, cLogger::OverflowPolicy::BLOCK, true); }
+
+}  // namespace
+
+CBENCH(LogSync)->ThreadRange(1, 8)->Iterations(100000)->Setup(SetupSync)->Teardown(StopLogger);
+CBENCH(LogAsyncDrop)->ThreadRange(1, 8)->Iterations(100000)->Setup(SetupAsyncDrop)->Teardown(StopLogger);
+CBENCH(LogAsyncBlock)->ThreadRange(1, 8)->Iterations(100000)->Setup(SetupAsyncBlock)->Teardown(StopLogger);
+CBENCH(LogDeferred)->ThreadRange(1, 8)->Iterations(100000)->Setup(SetupDeferred)->Teardown(StopLogger);
+
+CBENCH_MAIN()
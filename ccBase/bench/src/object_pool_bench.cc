@@ -0,0 +1,61 @@
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "benchmark.h"
+#include "object_pool.h"
+
+using cObjectPool::ObjectPool;
+
+namespace {
+
+struct Buffer {
+    std::vector<uint8_t> data = std::vector<uint8_t>(4096);
+};
+
+std::unique_ptr<ObjectPool<Buffer>> pool;
+
+// 最多 max_size 个对象，预先全部创建好，运行中的获取都是复用
+void StartPool(size_t max_size) {
+    pool = std::make_unique<ObjectPool<Buffer>>([]() { return std::make_unique<Buffer>(); }, nullptr, max_size);
+    pool->Reserve(max_size);
+}
+
+void StopPool(cBench::State& state) {
+    cObjectPool::ObjectPoolStats stats = pool->GetStats();
+    state.SetCounter("hit_ratio", stats.HitRatio());
+    state.SetCounter("failures", static_cast<double>(stats.failures));
+    state.SetCounter("peak_outstanding", static_cast<double>(stats.peak_outstanding));
+    state.SetHistogram("wait_ns", pool->GetWaitHistogram());
+    pool.reset();
+}
+
+// 对象足够时的获取/归还，测试锁竞争
+void AcquireRelease(cBench::State& state) {
+    for (auto _ : state) {
+        auto buffer = pool->Acquire();
+        buffer->data[0]++;
+    }
+}
+
+// 对象少于线程数，获取不到时最多等待 1ms，测试等待时间和失败率
+void AcquireForContended(cBench::State& state) {
+    for (auto _ : state) {
+        uint64_t start_ns = cMetrics::NowNs();
+        auto buffer = pool->AcquireFor(std::chrono::milliseconds(1));
+        state.RecordLatency(cMetrics::NowNs() - start_ns);
+        if (buffer) {
+            buffer->data[0]++;
+        }
+    }
+}
+
+void SetupUnbounded(cBench::State& state) { StartPool(static_cast<size_t>(state.threads())); }
+void SetupScarce(cBench::State&) { StartPool(2); }
+
+}  // namespace
+
+CBENCH(AcquireRelease)->ThreadRange(1, 8)->Iterations(200000)->Setup(SetupUnbounded)->Teardown(StopPool);
+CBENCH(AcquireForContended)->ThreadRange(2, 8)->Iterations(50000)->Setup(SetupScarce)->Teardown(StopPool);
+
+CBENCH_MAIN()
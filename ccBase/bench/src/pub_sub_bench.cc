@@ -0,0 +1,106 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include "benchmark.h"
+#include "pub_sub.h"
+#include "thread_pool.h"
+
+using cPubSub::PubSub;
+using cPubSub::PublishMode;
+
+namespace {
+
+std::unique_ptr<PubSub<uint64_t>> pubsub;
+std::unique_ptr<cThread::ThreadPool> pool;
+cPubSub::TopicHandle handle;
+std::atomic<uint64_t> received{0};
+
+// 主题 "orders" 上有 arg 个同步订阅者
+void StartPubSub(PublishMode mode, int64_t subscribers) {
+    pubsub = std::make_unique<PubSub<uint64_t>>(mode);
+    handle = pubsub->Intern("orders");
+    for (int64_t i = 0; i < subscribers; ++i) {
+        pubsub->Subscribe(handle, [](const std::string&, const uint64_t& value) {
+            received.fetch_add(value & 1, std::memory_order_relaxed);
+        });
+    }
+}
+
+void StopPubSub(cBench::State& state) {
+    pubsub->WaitAsyncIdle();
+    cPubSub::PubSubMetrics metrics = pubsub->GetMetrics();
+    state.SetHistogram("publish_ns", metrics.publish_ns);
+    state.SetCounter("delivered_per_publish",
+                     static_cast<double>(metrics.delivered) / static_cast<double>(std::max<uint64_t>(metrics.published, 1)));
+    if (metrics.async_enqueued > 0) {
+        state.SetCounter("async_dropped", static_cast<double>(metrics.async_dropped));
+        state.SetCounter("async_delivered", static_cast<double>(metrics.async_delivered));
+    }
+    pubsub.reset();
+    if (pool) {
+        pool->ShutDown();
+        pool.reset();
+    }
+}
+
+// 扇出成本：每次发布同步调用 arg 个订阅者
+void PublishLocked(cBench::State& state) {
+    uint64_t value = state.Random();
+    for (auto _ : state) {
+        pubsub->Publish(handle, value++);
+    }
+}
+
+void PublishReadMostly(cBench::State& state) {
+    uint64_t value = state.Random();
+    for (auto _ : state) {
+        pubsub->Publish(handle, value++);
+    }
+}
+
+// 按主题名称发布，包括一次哈希查找
+void PublishByName(cBench::State& state) {
+    const std::string topic = "orders";
+    uint64_t value = state.Random();
+    for (auto _ : state) {
+        pubsub->Publish(topic, value++);
+    }
+}
+
+// 异步订阅者在线程池上批量投递，队列满时丢弃最早的消息
+void PublishAsyncDropOldest(cBench::State& state) {
+    uint64_t value = state.Random();
+    for (auto _ : state) {
+        pubsub->Publish(handle, value++);
+    }
+}
+
+void SetupLocked(cBench::State& state) { StartPubSub(PublishMode::kLocked, state.arg()); }
+void SetupReadMostly(cBench::State& state) { StartPubSub(PublishMode::kReadMostly, state.arg()); }
+
+void SetupAsync(cBench::State& state) {
+    StartPubSub(PublishMode::kReadMostly, 0);
+    cThread::ThreadPool::ThreadPoolConfig config{2, 2, 1 << 20, std::chrono::seconds(4)};
+    pool = std::make_unique<cThread::ThreadPool>(config);
+    pool->Start();
+    cPubSub::AsyncSubscribeOptions options;
+    options.queue_capacity = 4096;
+    options.policy = cPubSub::BackpressurePolicy::kDropOldest;
+    for (int64_t i = 0; i < state.arg(); ++i) {
+        pubsub->SubscribeAsync(
+            handle, [](const std::string&, const uint64_t*, size_t count) { received.fetch_add(count); }, *pool,
+            options);
+    }
+}
+
+}  // namespace
+
+CBENCH(PublishLocked)->Arg(1)->Arg(16)->Arg(256)->ThreadRange(1, 8)->Iterations(20000)->Setup(SetupLocked)->Teardown(
+    StopPubSub);
+CBENCH(PublishReadMostly)->Arg(1)->Arg(16)->Arg(256)->ThreadRange(1, 8)->Iterations(20000)->Setup(SetupReadMostly)
+    ->Teardown(StopPubSub);
+CBENCH(PublishByName)->Arg(16)->ThreadRange(1, 8)->Iterations(50000)->Setup(SetupReadMostly)->Teardown(StopPubSub);
+CBENCH(PublishAsyncDropOldest)->Arg(4)->ThreadRange(1, 4)->Iterations(50000)->Setup(SetupAsync)->Teardown(StopPubSub);
+
+CBENCH_MAIN()
@@ -0,0 +1,122 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "benchmark.h"
+#include "thread_pool.h"
+
+using cThread::ThreadPool;
+
+namespace {
+
+std::unique_ptr<ThreadPool> pool;
+
+// 每次运行重新创建 4 个核心线程的线程池，指标从零开始
+void StartPool(ThreadPool::SchedulerMode mode) {
+    ThreadPool::ThreadPoolConfig config{4, 4, 1 << 20, std::chrono::seconds(4)};
+    config.scheduler_mode = mode;
+    pool = std::make_unique<ThreadPool>(config);
+    pool->Start();
+}
+
+// 等待已提交的任务（包括任务中再提交的任务）全部执行完，输出线程池自己记录的指标后销毁
+void StopPool(cBench::State& state) {
+    for (;;) {
+        ThreadPool::Metrics metrics = pool->GetMetrics();
+        if (metrics.queue_depth == 0 && metrics.completed >= metrics.submitted) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pool->ShutDown();
+    ThreadPool::Metrics metrics = pool->GetMetrics();
+    state.SetHistogram("queue_wait_ns", metrics.queue_wait_ns);
+    state.SetHistogram("idle_wait_ns", metrics.idle_wait_ns);
+    state.SetCounter("rejected", static_cast<double>(metrics.rejected));
+    if (metrics.steal_attempts > 0) {
+        state.SetCounter("steal_hit_ratio",
+                         static_cast<double>(metrics.steal_hits) / static_cast<double>(metrics.steal_attempts));
+    }
+    pool.reset();
+}
+
+// 多个外部线程同时 Post 空任务，测试入队的竞争
+void PostGlobalQueue(cBench::State& state) {
+    for (auto _ : state) {
+        pool->Post([]() {});
+    }
+}
+
+void PostWorkStealing(cBench::State& state) {
+    for (auto _ : state) {
+        pool->Post([]() {});
+    }
+}
+
+// 每次提交 arg 个任务并等待全部执行完，测试包括执行在内的吞吐，ns/op 为一批任务的耗时
+void RunBatch(cBench::State& state) {
+    const int64_t batch = state.arg();
+    std::atomic<int64_t> remaining{0};
+    for (auto _ : state) {
+        remaining.store(batch, std::memory_order_relaxed);
+        for (int64_t i = 0; i < batch; ++i) {
+            pool->Post([&remaining]() { remaining.fetch_sub(1, std::memory_order_release); });
+        }
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// 每次提交后等待结果，测试一次往返的延迟
+void SubmitRoundTrip(cBench::State& state) {
+    for (auto _ : state) {
+        uint64_t start_ns = cMetrics::NowNs();
+        pool->Submit([]() {}).get();
+        state.RecordLatency(cMetrics::NowNs() - start_ns);
+    }
+}
+
+// 每个任务在线程池内再提交 8 个子任务，子任务进入本地队列，由空闲线程窃取
+void NestedFanOut(cBench::State& state) {
+    for (auto _ : state) {
+        pool->Post([]() {
+            for (int i = 0; i < 8; ++i) {
+                pool->Post([]() {});
+            }
+        });
+    }
+}
+
+// 宏观场景：一次 ParallelFor 处理 64K 个元素
+void ParallelForSum(cBench::State& state) {
+    std::vector<uint64_t> values(65536);
+    for (uint64_t& value : values) {
+        value = state.Random() & 0xff;
+    }
+    std::atomic<uint64_t> total{0};
+    for (auto _ : state) {
+        uint64_t start_ns = cMetrics::NowNs();
+        pool->ParallelFor(size_t(0), values.size(), [&values, &total](size_t i) {
+                 total.fetch_add(values[i], std::memory_order_relaxed);
+             })
+            .get();
+        state.RecordLatency(cMetrics::NowNs() - start_ns);
+    }
+}
+
+void SetupGlobalQueue(cBench::State&) { StartPool(ThreadPool::SchedulerMode::kGlobalQueue); }
+void SetupWorkStealing(cBench::State&) { StartPool(ThreadPool::SchedulerMode::kWorkStealing); }
+
+}  // namespace
+
+CBENCH(PostGlobalQueue)->ThreadRange(1, 8)->Iterations(200000)->Setup(SetupGlobalQueue)->Teardown(StopPool);
+CBENCH(PostWorkStealing)->ThreadRange(1, 8)->Iterations(200000)->Setup(SetupWorkStealing)->Teardown(StopPool);
+CBENCH(RunBatch)->Arg(64)->Arg(1024)->ThreadRange(1, 4)->Iterations(500)->Setup(SetupGlobalQueue)->Teardown(StopPool);
+CBENCH(SubmitRoundTrip)->ThreadRange(1, 8)->Iterations(20000)->Setup(SetupGlobalQueue)->Teardown(StopPool);
+CBENCH(NestedFanOut)->Threads(1)->Threads(4)->Iterations(20000)->Setup(SetupWorkStealing)->Teardown(StopPool);
+CBENCH(ParallelForSum)->Threads(1)->Iterations(200)->Setup(SetupGlobalQueue)->Teardown(StopPool);
+
+CBENCH_MAIN()
@@ -93,6 +93,11 @@ echo "  - 状态机测试: $BUILD_DIR/design_patterns/state_machine_test"
 echo "  - 单例模式测试: $BUILD_DIR/design_patterns/singleton_test"
 echo "  - 工厂模式测试: $BUILD_DIR/design_patterns/factory_test"
 echo "  - 日志模块测试: $BUILD_DIR/logger/logger_test"
+echo "  - 内存分配测试: $BUILD_DIR/allocator/allocator_test"
+echo "  - 协程测试: $BUILD_DIR/coroutine/task_test"
+echo "  - 定时器测试: $BUILD_DIR/timer/timing_wheel_test"
+echo "  - 运行指标测试: $BUILD_DIR/metrics/metrics_test"
+echo "  - 性能测试: $BUILD_DIR/bench/*_bench"
 echo ""
 echo "运行测试:"
 echo "  cd $BUILD_DIR"
@@ -108,4 +113,11 @@ echo "  ./design_patterns/state_machine_test"
 echo "  ./design_patterns/singleton_test"
 echo "  ./design_patterns/factory_test"
 echo "  ./logger/logger_test"
+echo "  ./allocator/allocator_test"
+echo "  ./coroutine/task_test"
+echo "  ./timer/timing_wheel_test"
+echo "  ./metrics/metrics_test"
+echo ""
+echo "运行性能测试:"
+echo "  cmake --build $BUILD_DIR --target bench"
 
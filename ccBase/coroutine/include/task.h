@@ -0,0 +1,339 @@
+#ifndef __TASK__
+#define __TASK__
+
+#if !defined(__cpp_impl_coroutine)
+#error "task.h 需要 C++20 协程支持（-std=c++20）"
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cCoroutine {
+
+template <typename T = void>
+class Task;
+
+/**
+ * @brief Task 的 promise 公共部分：协程创建后先挂起，co_await 时才开始执行；
+ * 执行结束时直接切换到等待它的协程（对称转移），不经过调度器；开启优化后编译器把切换实现为尾调用，
+ * 嵌套很深的 co_await 链也不会耗尽栈
+ */
+class TaskPromiseBase {
+   public:
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            std::coroutine_handle<> continuation = handle.promise().continuation_;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { exception_ = std::current_exception(); }
+
+    void SetContinuation(std::coroutine_handle<> continuation) noexcept { continuation_ = continuation; }
+
+   protected:
+    void RethrowIfFailed() const {
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+    }
+
+   private:
+    std::coroutine_handle<> continuation_;
+    std::exception_ptr exception_;
+};
+
+template <typename T>
+class TaskPromise : public TaskPromiseBase {
+   public:
+    Task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& value) {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    T GetResult() {
+        RethrowIfFailed();
+        return std::move(*value_);
+    }
+
+   private:
+    std::optional<T> value_;
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase {
+   public:
+    Task<void> get_return_object() noexcept;
+
+    void return_void() const noexcept {}
+
+    void GetResult() { RethrowIfFailed(); }
+};
+
+/**
+ * @brief 惰性协程任务
+ * 协程函数返回 Task<T> 时，函数体在第一次被 co_await 时才开始执行，co_await 的结果是 co_return 的值，
+ * 协程中未捕获的异常在 co_await 处重新抛出。Task 拥有协程帧，析构时销毁。
+ * 在普通函数中用 SyncWait 阻塞等待结果
+ * @tparam T 结果类型，需要可移动；void 表示没有结果
+ */
+template <typename T>
+class [[nodiscard]] Task {
+   public:
+    using promise_type = TaskPromise<T>;
+
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> handle) noexcept : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    // 协程是否已经执行完毕
+    bool IsReady() const noexcept { return !handle_ || handle_.done(); }
+
+    /**
+     * @brief 获取结果，只能在 IsReady() 后调用一次；协程抛出异常时重新抛出
+     */
+    T Get() { return handle_.promise().GetResult(); }
+
+    auto operator co_await() noexcept {
+        struct Awaiter : ReadyAwaiter {
+            T await_resume() { return this->handle.promise().GetResult(); }
+        };
+        return Awaiter{{handle_}};
+    }
+
+    /**
+     * @brief 等待协程执行完毕但不取结果，也不抛出协程中的异常，之后用 Get 取结果
+     */
+    auto WhenReady() noexcept { return ReadyAwaiter{handle_}; }
+
+   private:
+    struct ReadyAwaiter {
+        std::coroutine_handle<promise_type> handle;
+
+        bool await_ready() const noexcept { return !handle || handle.done(); }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            handle.promise().SetContinuation(awaiting);
+            return handle;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+/**
+ * @brief 立即开始执行、执行完自动销毁的协程，只在本文件内部用于启动 Task
+ */
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+/**
+ * @brief 在当前线程启动 task 并阻塞等待结果，用于在普通函数中进入协程
+ */
+template <typename T>
+T SyncWait(Task<T> task) {
+    struct Latch {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool done = false;
+    } latch;
+    auto run = [](Task<T>& task, Latch& latch) -> DetachedTask {
+        co_await task.WhenReady();
+        std::lock_guard<std::mutex> lock(latch.mutex);
+        latch.done = true;
+        latch.cv.notify_all();
+    };
+    run(task, latch);
+    {
+        std::unique_lock<std::mutex> lock(latch.mutex);
+        latch.cv.wait(lock, [&latch] { return latch.done; });
+    }
+    return task.Get();
+}
+
+/**
+ * @brief 同时启动一组 Task，全部完成后恢复等待者
+ * 计数初值多 1，由 await_suspend 在启动完所有任务后减去；任务全部同步完成时不挂起
+ */
+template <typename T>
+class WhenAllAwaiter {
+   public:
+    explicit WhenAllAwaiter(std::vector<Task<T>>& tasks) : tasks_(tasks), remaining_(tasks.size() + 1) {}
+
+    bool await_ready() const noexcept { return tasks_.empty(); }
+
+    bool await_suspend(std::coroutine_handle<> continuation) {
+        continuation_ = continuation;
+        for (Task<T>& task : tasks_) {
+            Run(task, this);
+        }
+        return remaining_.fetch_sub(1) != 1;
+    }
+
+    void await_resume() const noexcept {}
+
+   private:
+    static DetachedTask Run(Task<T>& task, WhenAllAwaiter* awaiter) {
+        co_await task.WhenReady();
+        if (awaiter->remaining_.fetch_sub(1) == 1) {
+            awaiter->continuation_.resume();
+        }
+    }
+
+    std::vector<Task<T>>& tasks_;
+    std::atomic<size_t> remaining_;
+    std::coroutine_handle<> continuation_;
+};
+
+/**
+ * @brief 等待所有任务完成
+ * 任务在同一线程中依次启动，遇到第一个挂起点（例如 co_await pool.Schedule()）后才会并发执行
+ * @return 按任务顺序排列的结果；有任务抛出异常时在 co_await 处重新抛出第一个失败任务的异常
+ */
+template <typename T>
+Task<std::vector<T>> WhenAll(std::vector<Task<T>> tasks) {
+    co_await WhenAllAwaiter<T>(tasks);
+    std::vector<T> results;
+    results.reserve(tasks.size());
+    for (Task<T>& task : tasks) {
+        results.push_back(task.Get());
+    }
+    co_return results;
+}
+
+inline Task<void> WhenAll(std::vector<Task<void>> tasks) {
+    co_await WhenAllAwaiter<void>(tasks);
+    for (Task<void>& task : tasks) {
+        task.Get();
+    }
+}
+
+/**
+ * @brief 同时启动一组 Task，第一个完成的任务恢复等待者
+ * 其余任务继续执行直到结束，任务和共享状态由最后一个结束的任务释放
+ */
+template <typename T>
+class WhenAnyAwaiter {
+   public:
+    struct State {
+        std::vector<Task<T>> tasks;
+        std::atomic<size_t> winner{kNone};
+        std::atomic<int> arrivals{2};  // 胜出的任务和 await_suspend 各减一次，后到的一方恢复等待者
+        std::coroutine_handle<> continuation;
+    };
+
+    static constexpr size_t kNone = static_cast<size_t>(-1);
+
+    explicit WhenAnyAwaiter(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> continuation) {
+        state_->continuation = continuation;
+        for (size_t i = 0; i < state_->tasks.size(); ++i) {
+            Run(state_, i);
+        }
+        return state_->arrivals.fetch_sub(1) != 1;
+    }
+
+    size_t await_resume() const noexcept { return state_->winner.load(); }
+
+   private:
+    static DetachedTask Run(std::shared_ptr<State> state, size_t index) {
+        co_await state->tasks[index].WhenReady();
+        size_t expected = kNone;
+        if (state->winner.compare_exchange_strong(expected, index) && state->arrivals.fetch_sub(1) == 1) {
+            state->continuation.resume();
+        }
+    }
+
+    std::shared_ptr<State> state_;
+};
+
+/**
+ * @brief 等待任意一个任务完成
+ * @return 第一个完成的任务下标及其结果；该任务抛出异常时在 co_await 处重新抛出
+ * @throws std::invalid_argument tasks 为空
+ */
+template <typename T>
+Task<std::pair<size_t, T>> WhenAny(std::vector<Task<T>> tasks) {
+    if (tasks.empty()) {
+        throw std::invalid_argument("WhenAny requires at least one task");
+    }
+    auto state = std::make_shared<typename WhenAnyAwaiter<T>::State>();
+    state->tasks = std::move(tasks);
+    size_t index = co_await WhenAnyAwaiter<T>(state);
+    co_return std::pair<size_t, T>(index, state->tasks[index].Get());
+}
+
+/**
+ * @return 第一个完成的任务下标
+ */
+inline Task<size_t> WhenAny(std::vector<Task<void>> tasks) {
+    if (tasks.empty()) {
+        throw std::invalid_argument("WhenAny requires at least one task");
+    }
+    auto state = std::make_shared<WhenAnyAwaiter<void>::State>();
+    state->tasks = std::move(tasks);
+    size_t index = co_await WhenAnyAwaiter<void>(state);
+    state->tasks[index].Get();
+    co_return index;
+}
+
+}  // namespace cCoroutine
+
+#endif  // __TASK__
@@ -0,0 +1,205 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "async_callback.h"
+#include "task.h"
+#include "thread_pool.h"
+
+using namespace cCoroutine;
+using std::cout;
+using std::endl;
+
+Task<int> Add(int a, int b) { co_return a + b; }
+
+Task<int> Sum(int n) {
+    int total = 0;
+    for (int i = 0; i < n; ++i) {
+        total += co_await Add(i, 1);
+    }
+    co_return total;
+}
+
+Task<int> Depth(int n) {
+    if (n == 0) {
+        co_return 0;
+    }
+    co_return 1 + co_await Depth(n - 1);
+}
+
+Task<std::string> Fail() {
+    throw std::runtime_error("协程异常");
+    co_return "";
+}
+
+void TestBasicTask() {
+    cout << "\n========== 测试1: 基本协程任务 ==========" << endl;
+
+    cout << "Sum(100): " << SyncWait(Sum(100)) << "（期望 5050）" << endl;
+
+    // 嵌套的 co_await 链
+    cout << "Depth(1000): " << SyncWait(Depth(1000)) << "（期望 1000）" << endl;
+
+    try {
+        SyncWait(Fail());
+    } catch (const std::exception& e) {
+        cout << "捕获异常: " << e.what() << endl;
+    }
+
+    // 惰性执行：创建时不运行，co_await 时才运行
+    bool started = false;
+    auto lazy = [&started]() -> Task<void> {
+        started = true;
+        co_return;
+    };
+    Task<void> task = lazy();
+    cout << "创建后是否开始执行: " << (started ? "是" : "否");
+    SyncWait(std::move(task));
+    cout << "，SyncWait 后: " << (started ? "是" : "否") << endl;
+}
+
+void TestSchedule() {
+    cout << "\n========== 测试2: 在线程池上调度 ==========" << endl;
+
+    cThread::ThreadPool::ThreadPoolConfig config{4, 4, 16384, std::chrono::seconds(4)};
+    cThread::ThreadPool pool(config);
+    pool.Start();
+
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    auto flow = [&pool, &mutex, &threads](int id) -> Task<int> {
+        co_await pool.Schedule();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+        }
+        int value = co_await Add(id, id);
+        co_await pool.Schedule();
+        co_return value;
+    };
+
+    const int flow_count = 10000;
+    std::vector<Task<int>> flows;
+    for (int i = 0; i < flow_count; ++i) {
+        flows.push_back(flow(i));
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<int> results = SyncWait(WhenAll(std::move(flows)));
+    auto end = std::chrono::high_resolution_clock::now();
+    long sum = 0;
+    for (int value : results) {
+        sum += value;
+    }
+    cout << flow_count << " 个协程在 " << threads.size() << " 个线程上完成，结果之和: " << sum << "（期望 "
+         << static_cast<long>(flow_count) * (flow_count - 1) << "），耗时 "
+         << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms" << endl;
+
+    pool.ShutDown();
+}
+
+void TestAwaitCallback() {
+    cout << "\n========== 测试3: 等待异步回调 ==========" << endl;
+
+    cAsync::AsyncCallback async(2);
+    auto request = [&async](int id) -> Task<int> {
+        int doubled = co_await async.Await([id]() { return id * 2; });
+        co_await async.Await([]() {});
+        co_return doubled + 1;
+    };
+
+    const int request_count = 1000;
+    std::vector<Task<int>> requests;
+    for (int i = 0; i < request_count; ++i) {
+        requests.push_back(request(i));
+    }
+    std::vector<int> results = SyncWait(WhenAll(std::move(requests)));
+    long sum = 0;
+    for (int value : results) {
+        sum += value;
+    }
+    cout << request_count << " 个请求结果之和: " << sum << "（期望 "
+         << static_cast<long>(request_count) * (request_count - 1) + request_count << "）" << endl;
+
+    auto failing = [&async]() -> Task<void> {
+        co_await async.Await([]() { throw std::runtime_error("回调异常"); });
+    };
+    try {
+        SyncWait(failing());
+    } catch (const std::exception& e) {
+        cout << "捕获异常: " << e.what() << endl;
+    }
+}
+
+void TestWhenAny() {
+    cout << "\n========== 测试4: WhenAll 与 WhenAny ==========" << endl;
+
+    cThread::ThreadPool::ThreadPoolConfig config{4, 4, 64, std::chrono::seconds(4)};
+    cThread::ThreadPool pool(config);
+    pool.Start();
+
+    auto delayed = [&pool](int value, int delay_ms) -> Task<int> {
+        co_await pool.Schedule();
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+        co_return value;
+    };
+
+    std::vector<Task<int>> tasks;
+    tasks.push_back(delayed(1, 100));
+    tasks.push_back(delayed(2, 10));
+    tasks.push_back(delayed(3, 50));
+    auto [index, value] = SyncWait(WhenAny(std::move(tasks)));
+    cout << "最先完成的任务: " << index << "，结果: " << value << "（期望 1, 2）" << endl;
+
+    std::atomic<int> finished(0);
+    auto step = [&pool, &finished]() -> Task<void> {
+        co_await pool.Schedule();
+        finished++;
+    };
+    std::vector<Task<void>> steps;
+    for (int i = 0; i < 100; ++i) {
+        steps.push_back(step());
+    }
+    SyncWait(WhenAll(std::move(steps)));
+    cout << "WhenAll(Task<void>) 完成: " << finished.load() << "（期望 100）" << endl;
+
+    std::vector<Task<int>> mixed;
+    mixed.push_back(delayed(1, 1));
+    mixed.push_back([]() -> Task<int> {
+        throw std::runtime_error("子任务失败");
+        co_return 0;
+    }());
+    try {
+        SyncWait(WhenAll(std::move(mixed)));
+    } catch (const std::exception& e) {
+        cout << "WhenAll 捕获异常: " << e.what() << endl;
+    }
+
+    pool.ShutDown();
+}
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "    协程模块测试程序" << endl;
+    cout << "========================================" << endl;
+
+    try {
+        TestBasicTask();
+        TestSchedule();
+        TestAwaitCallback();
+        TestWhenAny();
+
+        cout << "\n========================================" << endl;
+        cout << "    所有测试完成！" << endl;
+        cout << "========================================" << endl;
+    } catch (const std::exception& e) {
+        cout << "测试异常: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
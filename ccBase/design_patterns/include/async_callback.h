@@ -1,30 +1,72 @@
 #ifndef __ASYNC_CALLBACK__
 #define __ASYNC_CALLBACK__
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <future>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
-#include <queue>
+#include <optional>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+
 namespace cAsync {
 
 /**
  * @brief 异步回调管理器
  * 支持异步执行回调函数，并可以等待所有回调完成
+ *
+ * 回调可以由自己的若干工作线程执行，也可以提交到外部共享的线程池。
+ * 完成情况只用两个计数器跟踪：WaitAll 把之后提交的回调记到另一个计数器上，再等待原计数器归零，
+ * 因此内存占用与已提交的回调数量无关
  */
 class AsyncCallback {
    public:
     using CallbackFunc = std::function<void()>;
 
-    AsyncCallback() : running_(false) {}
+    /**
+     * @param resource 回调队列使用的内存资源，资源需要比 AsyncCallback 活得更久
+     */
+    explicit AsyncCallback(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : AsyncCallback(1, resource) {}
+
+    /**
+     * @param worker_count 工作线程数量，至少为 1；多个工作线程时回调可能并发执行
+     * @param resource 同上
+     */
+    explicit AsyncCallback(size_t worker_count,
+                           std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : callbacks_(resource), worker_count_(std::max<size_t>(worker_count, 1)), running_(false) {}
+
+    /**
+     * @brief 在外部线程池上执行回调，不创建自己的线程
+     * @param executor 提供 bool Post(F) 的线程池，例如 cThread::ThreadPool，需要比 AsyncCallback 活得更久；
+     * Post 失败（例如线程池已关闭）时在调用线程中直接执行回调
+     */
+    template <typename Executor, typename = std::enable_if_t<!std::is_pointer<Executor>::value &&
+                                                             !std::is_integral<Executor>::value>>
+    explicit AsyncCallback(Executor& executor)
+        : callbacks_(std::pmr::get_default_resource()),
+          worker_count_(0),
+          post_([&executor](CallbackFunc task) { return executor.Post(std::move(task)); }),
+          running_(false) {}
+
     ~AsyncCallback() { Stop(); }
 
+    AsyncCallback(const AsyncCallback&) = delete;
+    AsyncCallback& operator=(const AsyncCallback&) = delete;
+
     /**
-     * @brief 启动异步回调处理线程
+     * @brief 启动异步回调处理线程，使用外部线程池时什么也不做
      */
     void Start() {
         std::lock_guard<std::mutex> lock(mutex_);
@@ -32,19 +74,25 @@ class AsyncCallback {
     }
 
     /**
-     * @brief 停止异步回调处理
+     * @brief 停止异步回调处理，已提交的回调会先执行完
      */
     void Stop() {
+        if (post_) {
+            WaitAll();
+            return;
+        }
+        std::vector<std::thread> workers;
         {
             std::lock_guard<std::mutex> lock(mutex_);
             if (!running_) {
                 return;
             }
             running_ = false;
+            workers.swap(workers_);
         }
         cv_.notify_all();
-        if (worker_thread_.joinable()) {
-            worker_thread_.join();
+        for (auto& worker : workers) {
+            worker.join();
         }
     }
 
@@ -56,24 +104,14 @@ class AsyncCallback {
     std::future<void> Post(CallbackFunc callback) {
         auto promise = std::make_shared<std::promise<void>>();
         auto future = promise->get_future();
-
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            if (!running_) {
-                StartUnlocked();
+        Enqueue([callback = std::move(callback), promise]() {
+            try {
+                callback();
+                promise->set_value();
+            } catch (...) {
+                promise->set_exception(std::current_exception());
             }
-            // 保存 future 以便 WaitAll() 可以等待
-            pending_futures_.push_back(future.share());
-            callbacks_.push([callback, promise]() {
-                try {
-                    callback();
-                    promise->set_value();
-                } catch (...) {
-                    promise->set_exception(std::current_exception());
-                }
-            });
-        }
-        cv_.notify_one();
+        });
         return future;
     }
 
@@ -87,91 +125,172 @@ class AsyncCallback {
     std::future<T> Post(std::function<T()> callback) {
         auto promise = std::make_shared<std::promise<T>>();
         auto future = promise->get_future();
-
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            if (!running_) {
-                StartUnlocked();
+        Enqueue([callback = std::move(callback), promise]() {
+            try {
+                promise->set_value(callback());
+            } catch (...) {
+                promise->set_exception(std::current_exception());
             }
-            // 将 future 转换为 void future 以便统一管理
-            auto void_promise = std::make_shared<std::promise<void>>();
-            auto void_future = void_promise->get_future();
-            pending_futures_.push_back(void_future.share());
-            callbacks_.push([callback, promise, void_promise]() {
+        });
+        return future;
+    }
+
+#if defined(__cpp_impl_coroutine)
+    /**
+     * @brief Post 的协程版本：auto result = co_await async.Await(callback);
+     * callback 在回调线程中执行，完成后协程也在该线程中继续执行，等待期间不占用线程；
+     * callback 抛出的异常在 co_await 处重新抛出
+     */
+    template <typename F>
+    auto Await(F callback) {
+        return CallbackAwaiter<F>{this, std::move(callback)};
+    }
+
+    template <typename F>
+    struct CallbackAwaiter {
+        using Result = std::invoke_result_t<F&>;
+
+        AsyncCallback* owner;
+        F callback;
+        std::conditional_t<std::is_void<Result>::value, bool, std::optional<Result>> result{};
+        std::exception_ptr exception{};
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            owner->Enqueue([this, handle]() {
                 try {
-                    promise->set_value(callback());
-                    void_promise->set_value();
+                    if constexpr (std::is_void<Result>::value) {
+                        callback();
+                    } else {
+                        result.emplace(callback());
+                    }
                 } catch (...) {
-                    auto exception_ptr = std::current_exception();
-                    promise->set_exception(exception_ptr);
-                    void_promise->set_exception(exception_ptr);
+                    exception = std::current_exception();
                 }
+                handle.resume();
             });
         }
-        cv_.notify_one();
-        return future;
-    }
+
+        Result await_resume() {
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+            if constexpr (!std::is_void<Result>::value) {
+                return std::move(*result);
+            }
+        }
+    };
+#endif
 
     /**
-     * @brief 等待所有待处理的回调完成
+     * @brief 等待调用之前提交的所有回调完成，之后提交的回调不在等待范围内
      */
     void WaitAll() {
-        std::vector<std::shared_future<void>> futures;
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            futures = pending_futures_;
-            pending_futures_.clear();
-        }
-        // 等待所有 future 完成
-        for (auto& future : futures) {
-            future.wait();
-        }
+        std::lock_guard<std::mutex> wait_lock(wait_mutex_);
+        std::unique_lock<std::mutex> lock(mutex_);
+        size_t slot = epoch_;
+        epoch_ ^= 1;
+        idle_cv_.wait(lock, [this, slot] { return outstanding_[slot].load() == 0; });
     }
 
     /**
      * @brief 获取待处理的回调数量
-     * @return 待处理的回调数量
+     * @return 尚未开始执行的回调数量
      */
-    size_t GetPendingCount() const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return callbacks_.size();
-    }
+    size_t GetPendingCount() const { return pending_.load(); }
 
    private:
     /**
      * @brief 启动异步回调处理线程（不需要锁，调用者必须持有锁）
      */
     void StartUnlocked() {
-        if (!running_) {
+        if (!running_ && !post_) {
             running_ = true;
-            worker_thread_ = std::thread(&AsyncCallback::WorkerLoop, this);
+            for (size_t i = 0; i < worker_count_; ++i) {
+                workers_.emplace_back(&AsyncCallback::WorkerLoop, this);
+            }
         }
     }
 
+    // 记入当前 epoch 的计数器，执行完后减一，计数归零时唤醒 WaitAll
+    void Enqueue(CallbackFunc callback) {
+        size_t slot;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            slot = epoch_;
+            outstanding_[slot].fetch_add(1);
+            pending_.fetch_add(1);
+            if (post_) {
+                callback = [this, callback = std::move(callback), slot]() {
+                    pending_.fetch_sub(1);
+                    callback();
+                    Complete(slot);
+                };
+            } else {
+                if (!running_) {
+                    StartUnlocked();
+                }
+                callbacks_.push_back({std::move(callback), slot});
+            }
+        }
+        if (!post_) {
+            cv_.notify_one();
+        } else if (!post_(callback)) {
+            callback();
+        }
+    }
+
+    void Complete(size_t slot) {
+        if (outstanding_[slot].fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            idle_cv_.notify_all();
+        }
+    }
+
+    /**
+     * @brief 每次加锁取走队列中约 1/worker_count 的回调，只有一个工作线程时一次取走全部
+     */
     void WorkerLoop() {
+        std::vector<Task> batch;
         while (true) {
-            std::unique_lock<std::mutex> lock(mutex_);
-            cv_.wait(lock, [this] { return !callbacks_.empty() || !running_; });
-
-            if (!running_ && callbacks_.empty()) {
-                break;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return !callbacks_.empty() || !running_; });
+                if (!running_ && callbacks_.empty()) {
+                    break;
+                }
+                size_t count = std::max<size_t>(callbacks_.size() / worker_count_, 1);
+                for (size_t i = 0; i < count; ++i) {
+                    batch.push_back(std::move(callbacks_.front()));
+                    callbacks_.pop_front();
+                }
+                pending_.fetch_sub(count);
             }
-
-            while (!callbacks_.empty()) {
-                auto callback = callbacks_.front();
-                callbacks_.pop();
-                lock.unlock();
-                callback();
-                lock.lock();
+            for (Task& task : batch) {
+                task.callback();
+                Complete(task.slot);
             }
+            batch.clear();
         }
     }
 
+    struct Task {
+        CallbackFunc callback;
+        size_t slot;
+    };
+
     mutable std::mutex mutex_;
     std::condition_variable cv_;
-    std::queue<std::function<void()>> callbacks_;
-    std::vector<std::shared_future<void>> pending_futures_;
-    std::thread worker_thread_;
+    std::condition_variable idle_cv_;
+    std::mutex wait_mutex_;  // 串行化 WaitAll，保证每次等待时另一个计数器中只有之后提交的回调
+    std::pmr::deque<Task> callbacks_;
+    size_t worker_count_;  // 使用外部线程池时为 0
+    std::function<bool(CallbackFunc)> post_;
+    std::vector<std::thread> workers_;
+    size_t epoch_ = 0;                       // 新提交的回调记入的计数器下标
+    std::atomic<size_t> outstanding_[2] = {};  // 每个 epoch 中尚未完成的回调数
+    std::atomic<size_t> pending_{0};           // 尚未开始执行的回调数
     bool running_;
 };
 
@@ -1,9 +1,14 @@
 #ifndef __CHAIN_OF_RESPONSIBILITY__
 #define __CHAIN_OF_RESPONSIBILITY__
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace cChain {
 
@@ -104,6 +109,53 @@ std::shared_ptr<Handler<Request, Response>> MakeHandler(
     return std::make_shared<FunctionalHandler<Request, Response>>(std::move(func));
 }
 
+/**
+ * @brief 编译后的责任链
+ * 处理者按顺序放在连续数组中，Process 循环调用而不是沿 next_handler_ 递归，长链也不会加深调用栈；
+ * 结果语义与 HandleAndPass 相同：返回第一个不是 kNotHandled 的结果，全部未处理时返回 kNotHandled。
+ * 链是编译时的快照，之后对处理者调用 SetNext 不影响已编译的链
+ * @tparam Request 请求类型
+ * @tparam Response 响应类型（可选）
+ */
+template <typename Request, typename Response = void>
+class CompiledChain {
+   public:
+    using HandlerPtr = std::shared_ptr<Handler<Request, Response>>;
+
+    CompiledChain() = default;
+
+    explicit CompiledChain(std::vector<HandlerPtr> handlers) : owners_(std::move(handlers)) {
+        handlers_.reserve(owners_.size());
+        for (const HandlerPtr& handler : owners_) {
+            handlers_.push_back(handler.get());
+        }
+    }
+
+    /**
+     * @brief 处理请求
+     * @param request 请求对象
+     * @param response 响应对象（如果 Response 不是 void）
+     * @return 处理结果
+     */
+    HandleResult Process(const Request& request, Response* response = nullptr) const {
+        for (Handler<Request, Response>* handler : handlers_) {
+            HandleResult result = handler->Handle(request, response);
+            if (result != HandleResult::kNotHandled) {
+                return result;
+            }
+        }
+        return HandleResult::kNotHandled;
+    }
+
+    size_t GetSize() const { return handlers_.size(); }
+
+    bool Empty() const { return handlers_.empty(); }
+
+   private:
+    std::vector<HandlerPtr> owners_;                   // 持有处理者
+    std::vector<Handler<Request, Response>*> handlers_;  // 遍历用的裸指针，不经过 shared_ptr 的控制块
+};
+
 /**
  * @brief 责任链构建器
  * @tparam Request 请求类型
@@ -140,6 +192,22 @@ class ChainBuilder {
         return first_handler_;
     }
 
+    /**
+     * @brief 把当前的链编译为连续数组
+     * 从第一个处理者开始沿 GetNext 收集，包括构建后通过 SetNext 追加的处理者；遇到已收集过的处理者（环）时停止
+     * @return 编译后的链
+     */
+    CompiledChain<Request, Response> Compile() const {
+        std::vector<std::shared_ptr<Handler<Request, Response>>> handlers;
+        for (auto handler = first_handler_; handler; handler = handler->GetNext()) {
+            if (std::find(handlers.begin(), handlers.end(), handler) != handlers.end()) {
+                break;
+            }
+            handlers.push_back(handler);
+        }
+        return CompiledChain<Request, Response>(std::move(handlers));
+    }
+
     /**
      * @brief 清空链
      */
@@ -194,6 +262,63 @@ class ChainManager {
     std::shared_ptr<Handler<Request, Response>> chain_;
 };
 
+/**
+ * @brief 编译期确定的责任链
+ * 处理者按值保存在 tuple 中，Process 用折叠表达式依次调用，编译器可以把整条链内联；结果语义与 HandleAndPass 相同。
+ * 处理者可以是 HandleResult(const Request&, Response*) 的可调用对象，
+ * 也可以是 Handler 的派生类（建议声明为 final，以便调用 Handle 时去掉虚函数分发）
+ * @tparam Request 请求类型
+ * @tparam Response 响应类型（可选）
+ * @tparam Handlers 处理者类型
+ */
+template <typename Request, typename Response, typename... Handlers>
+class StaticChain {
+   public:
+    explicit StaticChain(Handlers... handlers) : handlers_(std::move(handlers)...) {}
+
+    /**
+     * @brief 处理请求
+     * @param request 请求对象
+     * @param response 响应对象（如果 Response 不是 void）
+     * @return 处理结果
+     */
+    HandleResult Process(const Request& request, Response* response = nullptr) {
+        HandleResult result = HandleResult::kNotHandled;
+        std::apply(
+            [&](auto&... handlers) {
+                ((result = Invoke(handlers, request, response), result == HandleResult::kNotHandled) && ...);
+            },
+            handlers_);
+        return result;
+    }
+
+    static constexpr size_t GetSize() { return sizeof...(Handlers); }
+
+   private:
+    template <typename H>
+    static HandleResult Invoke(H& handler, const Request& request, Response* response) {
+        if constexpr (std::is_invocable_r<HandleResult, H&, const Request&, Response*>::value) {
+            return handler(request, response);
+        } else {
+            return handler.Handle(request, response);
+        }
+    }
+
+    std::tuple<Handlers...> handlers_;
+};
+
+/**
+ * @brief 便捷函数：创建编译期责任链，例如 MakeStaticChain<Request>(handler1, handler2)
+ * @tparam Request 请求类型
+ * @tparam Response 响应类型（可选）
+ * @param handlers 处理者，按值保存
+ * @return 编译期责任链
+ */
+template <typename Request, typename Response = void, typename... Handlers>
+StaticChain<Request, Response, std::decay_t<Handlers>...> MakeStaticChain(Handlers&&... handlers) {
+    return StaticChain<Request, Response, std::decay_t<Handlers>...>(std::forward<Handlers>(handlers)...);
+}
+
 }  // namespace cChain
 
 #endif  // __CHAIN_OF_RESPONSIBILITY__
@@ -1,9 +1,13 @@
 #ifndef __COMMAND__
 #define __COMMAND__
 
+#include <algorithm>
+#include <cstddef>
 #include <functional>
 #include <memory>
-#include <stack>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace cCommand {
@@ -17,6 +21,13 @@ class Command {
     virtual void Execute() = 0;
     virtual void Undo() = 0;
     virtual bool CanUndo() const { return true; }
+
+    /**
+     * @brief 合并紧随其后执行的命令，例如连续输入的字符合并为一次编辑
+     * @param next 已经执行完的下一条命令
+     * @return true 表示本命令已吸收 next 的效果，撤销本命令会一并撤销 next，next 不再进入历史
+     */
+    virtual bool MergeWith(const Command& /*next*/) { return false; }
 };
 
 /**
@@ -49,13 +60,61 @@ class FunctionalCommand : public Command {
     UndoFunc undo_func_;
 };
 
+/**
+ * @brief 直接保存可调用对象的命令，没有 std::function 的额外分配和间接调用，通常由 CommandManager::CreateCommand 创建
+ */
+template <typename ExecuteFunc, typename UndoFunc>
+class LambdaCommand final : public Command {
+   public:
+    LambdaCommand(ExecuteFunc execute, UndoFunc undo) : execute_func_(std::move(execute)), undo_func_(std::move(undo)) {}
+
+    void Execute() override { execute_func_(); }
+
+    void Undo() override { undo_func_(); }
+
+   private:
+    ExecuteFunc execute_func_;
+    UndoFunc undo_func_;
+};
+
 /**
  * @brief 命令管理器（支持撤销/重做）
+ * 撤销和重做历史放在同一个环形缓冲区中：[最早的命令 ... 可撤销的命令 | 可重做的命令]。
+ * 设置容量后历史条数不超过容量，最早的命令被覆盖，长时间运行时内存保持平稳；容量为 0 表示不限制。
+ * Create/CreateCommand 从构造时指定的 memory_resource 分配命令（对象和引用计数在同一块内存中），
+ * 长时间运行时适合使用可回收内存的资源（例如 cAllocator::SizeClassPool），Arena 只在定期整体丢弃历史时使用。
+ * 不是线程安全的
  */
 class CommandManager {
    public:
+    /**
+     * @param capacity 最多保留的历史条数（撤销和重做合计），0 表示不限制
+     * @param resource Create/CreateCommand 使用的内存资源，需要比所有由它创建的命令活得更久
+     */
+    explicit CommandManager(size_t capacity = 0,
+                            std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : capacity_(capacity), resource_(resource) {}
+
+    /**
+     * @brief 在 memory_resource 上创建命令
+     */
+    template <typename T, typename... Args>
+    std::shared_ptr<T> Create(Args&&... args) {
+        return std::allocate_shared<T>(std::pmr::polymorphic_allocator<T>(resource_), std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief 在 memory_resource 上创建保存 execute/undo 可调用对象的命令
+     */
+    template <typename ExecuteFunc, typename UndoFunc>
+    std::shared_ptr<Command> CreateCommand(ExecuteFunc&& execute, UndoFunc&& undo) {
+        return Create<LambdaCommand<std::decay_t<ExecuteFunc>, std::decay_t<UndoFunc>>>(
+            std::forward<ExecuteFunc>(execute), std::forward<UndoFunc>(undo));
+    }
+
     /**
      * @brief 执行命令
+     * 执行后清空重做历史；上一条可撤销的命令通过 MergeWith 吸收了本命令时，本命令不进入历史
      * @param command 命令对象
      */
     void Execute(std::shared_ptr<Command> command) {
@@ -63,27 +122,37 @@ class CommandManager {
             return;
         }
         command->Execute();
-        undo_stack_.push(command);
-        // 执行新命令后，清空重做栈
-        while (!redo_stack_.empty()) {
-            redo_stack_.pop();
+        // 执行新命令后，清空重做历史
+        for (size_t i = undo_count_; i < size_; ++i) {
+            At(i).reset();
+        }
+        size_ = undo_count_;
+        if (undo_count_ > 0 && At(undo_count_ - 1)->MergeWith(*command)) {
+            return;
         }
+        Push(std::move(command));
     }
 
     /**
-     * @brief 撤销上一个命令
+     * @brief 撤销上一个命令，不能撤销的命令会从历史中移除
      */
     bool Undo() {
-        if (undo_stack_.empty()) {
+        if (undo_count_ == 0) {
             return false;
         }
-        auto command = undo_stack_.top();
-        undo_stack_.pop();
+        std::shared_ptr<Command>& command = At(undo_count_ - 1);
         if (command->CanUndo()) {
             command->Undo();
-            redo_stack_.push(command);
+            undo_count_--;
             return true;
         }
+        // 移除不能撤销的命令，后面的重做历史前移一位
+        for (size_t i = undo_count_ - 1; i + 1 < size_; ++i) {
+            At(i) = std::move(At(i + 1));
+        }
+        At(size_ - 1).reset();
+        size_--;
+        undo_count_--;
         return false;
     }
 
@@ -91,41 +160,81 @@ class CommandManager {
      * @brief 重做上一个撤销的命令
      */
     bool Redo() {
-        if (redo_stack_.empty()) {
+        if (undo_count_ == size_) {
             return false;
         }
-        auto command = redo_stack_.top();
-        redo_stack_.pop();
-        command->Execute();
-        undo_stack_.push(command);
+        At(undo_count_)->Execute();
+        undo_count_++;
         return true;
     }
 
     /**
      * @brief 检查是否可以撤销
      */
-    bool CanUndo() const { return !undo_stack_.empty(); }
+    bool CanUndo() const { return undo_count_ > 0; }
 
     /**
      * @brief 检查是否可以重做
      */
-    bool CanRedo() const { return !redo_stack_.empty(); }
+    bool CanRedo() const { return undo_count_ < size_; }
+
+    size_t GetUndoCount() const { return undo_count_; }
+
+    size_t GetRedoCount() const { return size_ - undo_count_; }
+
+    size_t GetCapacity() const { return capacity_; }
 
     /**
      * @brief 清空所有命令历史
      */
     void Clear() {
-        while (!undo_stack_.empty()) {
-            undo_stack_.pop();
-        }
-        while (!redo_stack_.empty()) {
-            redo_stack_.pop();
+        for (size_t i = 0; i < size_; ++i) {
+            At(i).reset();
         }
+        head_ = 0;
+        size_ = 0;
+        undo_count_ = 0;
     }
 
    private:
-    std::stack<std::shared_ptr<Command>> undo_stack_;
-    std::stack<std::shared_ptr<Command>> redo_stack_;
+    std::shared_ptr<Command>& At(size_t index) { return history_[(head_ + index) % history_.size()]; }
+
+    // 调用时重做历史已清空
+    void Push(std::shared_ptr<Command> command) {
+        if (size_ == history_.size()) {
+            if (capacity_ != 0 && size_ == capacity_) {
+                // 覆盖最早的命令
+                history_[head_] = std::move(command);
+                head_ = (head_ + 1) % history_.size();
+                return;
+            }
+            Grow();
+        }
+        At(size_) = std::move(command);
+        size_++;
+        undo_count_ = size_;
+    }
+
+    // 按 2 倍扩容（不超过容量），同时把环形缓冲区展开为从下标 0 开始
+    void Grow() {
+        size_t new_size = std::max<size_t>(history_.size() * 2, 16);
+        if (capacity_ != 0) {
+            new_size = std::min(new_size, capacity_);
+        }
+        std::vector<std::shared_ptr<Command>> history(new_size);
+        for (size_t i = 0; i < size_; ++i) {
+            history[i] = std::move(At(i));
+        }
+        history_.swap(history);
+        head_ = 0;
+    }
+
+    size_t capacity_;
+    std::pmr::memory_resource* resource_;
+    std::vector<std::shared_ptr<Command>> history_;  // 环形缓冲区
+    size_t head_ = 0;        // 最早的命令所在的下标
+    size_t size_ = 0;        // 历史条数
+    size_t undo_count_ = 0;  // 前 undo_count_ 条可撤销，其余可重做
 };
 
 /**
@@ -154,10 +263,42 @@ class MacroCommand : public Command {
         }
     }
 
-   private:
+   protected:
     std::vector<std::shared_ptr<Command>> commands_;
 };
 
+/**
+ * @brief 子命令相互独立的宏命令，Execute/Undo 时把所有子命令一次提交到线程池并行执行，全部完成后返回
+ * 子命令抛出的第一个异常在 Execute/Undo 中重新抛出。不要在同一个线程池的任务中执行，否则可能死锁
+ */
+class ParallelMacroCommand : public MacroCommand {
+   public:
+    /**
+     * @param executor 提供 ParallelFor(begin, end, func) 并返回 std::future<void> 的线程池，
+     * 例如 cThread::ThreadPool，需要比命令活得更久
+     */
+    template <typename Executor>
+    explicit ParallelMacroCommand(Executor& executor)
+        : parallel_for_([&executor](size_t count, std::function<void(size_t)> func) {
+              executor.ParallelFor(size_t(0), count, std::move(func)).get();
+          }) {}
+
+    void Execute() override {
+        parallel_for_(commands_.size(), [this](size_t i) { commands_[i]->Execute(); });
+    }
+
+    void Undo() override {
+        parallel_for_(commands_.size(), [this](size_t i) {
+            if (commands_[i]->CanUndo()) {
+                commands_[i]->Undo();
+            }
+        });
+    }
+
+   private:
+    std::function<void(size_t, std::function<void(size_t)>)> parallel_for_;
+};
+
 }  // namespace cCommand
 
 #endif  // __COMMAND__
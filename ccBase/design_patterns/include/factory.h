@@ -1,15 +1,25 @@
 #ifndef __FACTORY__
 #define __FACTORY__
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <map>
 #include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace cFactory {
 
 /**
  * @brief 简单工厂
+ * 注册和创建都是线程安全的。启动阶段注册完后调用 Freeze，注册表编译为按键排序的只读数组，
+ * 之后 Create 只做一次原子读和二分查找，不加锁；冻结后仍可注册（例如延迟加载的插件），
+ * 注册时复制出新的数组替换旧数组，旧数组保留到工厂析构，正在读取的线程不受影响
  * @tparam Base 基类类型
  * @tparam Key 键类型
  */
@@ -17,34 +27,153 @@ template <typename Base, typename Key = std::string>
 class SimpleFactory {
    public:
     using CreatorFunc = std::function<std::unique_ptr<Base>()>;
+    using SharedCreatorFunc = std::function<std::shared_ptr<Base>()>;
+
+    SimpleFactory() = default;
+    SimpleFactory(const SimpleFactory&) = delete;
+    SimpleFactory& operator=(const SimpleFactory&) = delete;
 
     /**
      * @brief 注册创建函数
      */
     void Register(const Key& key, CreatorFunc creator) {
-        creators_[key] = creator;
+        std::lock_guard<std::mutex> lock(mutex_);
+        creators_[key].creator = std::move(creator);
+        PublishLocked();
+    }
+
+    /**
+     * @brief 注册类型，Create 使用 make_unique，CreateShared 可以在指定的 memory_resource 上构造
+     * @tparam Derived 具体类型，需要可默认构造
+     */
+    template <typename Derived>
+    void RegisterType(const Key& key) {
+        static_assert(std::is_base_of<Base, Derived>::value, "Derived must derive from Base");
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& entry = creators_[key];
+        entry.creator = []() { return std::make_unique<Derived>(); };
+        entry.resource_creator = [](std::pmr::memory_resource* resource) -> std::shared_ptr<Base> {
+            return std::allocate_shared<Derived>(std::pmr::polymorphic_allocator<Derived>(resource));
+        };
+        PublishLocked();
+    }
+
+    /**
+     * @brief 注册返回 shared_ptr 的创建函数，供 CreateShared 使用，
+     * 例如从对象池获取：factory.RegisterShared("handler", [&pool]() { return pool.Acquire(); });
+     */
+    void RegisterShared(const Key& key, SharedCreatorFunc creator) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        creators_[key].shared_creator = std::move(creator);
+        PublishLocked();
     }
 
+    /**
+     * @brief 冻结注册表，之后的查找不加锁
+     */
+    void Freeze() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        frozen_ = true;
+        PublishLocked();
+    }
+
+    bool IsFrozen() const { return table_.load(std::memory_order_acquire) != nullptr; }
+
     /**
      * @brief 创建对象
      */
     std::unique_ptr<Base> Create(const Key& key) {
-        auto it = creators_.find(key);
-        if (it != creators_.end()) {
-            return it->second();
+        if (const Table* table = table_.load(std::memory_order_acquire)) {
+            const Entry* entry = Find(*table, key);
+            return entry != nullptr && entry->creator ? entry->creator() : nullptr;
+        }
+        CreatorFunc creator;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = creators_.find(key);
+            if (it == creators_.end() || !it->second.creator) {
+                return nullptr;
+            }
+            creator = it->second.creator;
         }
-        return nullptr;
+        return creator();
+    }
+
+    /**
+     * @brief 创建共享对象
+     * 依次尝试：RegisterShared 注册的函数（例如对象池）；resource 非空时 RegisterType 注册的类型在 resource 上构造，
+     * 对象和引用计数都分配在 resource 中（例如每个请求一个 cAllocator::Arena，对象需要在 Arena 重置前释放）；
+     * 最后退回 Create
+     */
+    std::shared_ptr<Base> CreateShared(const Key& key, std::pmr::memory_resource* resource = nullptr) {
+        if (const Table* table = table_.load(std::memory_order_acquire)) {
+            const Entry* entry = Find(*table, key);
+            return entry != nullptr ? CreateShared(*entry, resource) : nullptr;
+        }
+        Entry entry;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = creators_.find(key);
+            if (it == creators_.end()) {
+                return nullptr;
+            }
+            entry = it->second;
+        }
+        return CreateShared(entry, resource);
     }
 
     /**
      * @brief 检查是否已注册
      */
     bool IsRegistered(const Key& key) const {
+        if (const Table* table = table_.load(std::memory_order_acquire)) {
+            return Find(*table, key) != nullptr;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
         return creators_.find(key) != creators_.end();
     }
 
    private:
-    std::map<Key, CreatorFunc> creators_;
+    struct Entry {
+        CreatorFunc creator;
+        SharedCreatorFunc shared_creator;
+        std::shared_ptr<Base> (*resource_creator)(std::pmr::memory_resource*) = nullptr;
+    };
+
+    // 冻结后的注册表，按键排序
+    using Table = std::vector<std::pair<Key, Entry>>;
+
+    static const Entry* Find(const Table& table, const Key& key) {
+        auto it = std::lower_bound(table.begin(), table.end(), key,
+                                   [](const std::pair<Key, Entry>& item, const Key& k) { return item.first < k; });
+        return it != table.end() && !(key < it->first) ? &it->second : nullptr;
+    }
+
+    static std::shared_ptr<Base> CreateShared(const Entry& entry, std::pmr::memory_resource* resource) {
+        if (entry.shared_creator) {
+            return entry.shared_creator();
+        }
+        if (resource != nullptr && entry.resource_creator != nullptr) {
+            return entry.resource_creator(resource);
+        }
+        return entry.creator ? std::shared_ptr<Base>(entry.creator()) : nullptr;
+    }
+
+    // 冻结后每次注册都生成新的只读数组，旧数组可能还在被读取，保留到析构
+    void PublishLocked() {
+        if (!frozen_) {
+            return;
+        }
+        auto table = std::make_unique<const Table>(creators_.begin(), creators_.end());
+        table_.store(table.get(), std::memory_order_release);
+        tables_.push_back(std::move(table));
+    }
+
+    mutable std::mutex mutex_;
+    std::map<Key, Entry> creators_;
+    bool frozen_ = false;
+    std::atomic<const Table*> table_{nullptr};
+    std::vector<std::unique_ptr<const Table>> tables_;
 };
 
 /**
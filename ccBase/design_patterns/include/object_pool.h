@@ -1,13 +1,44 @@
 #ifndef __OBJECT_POOL__
 #define __OBJECT_POOL__
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <string>
+#include <vector>
+#include "metrics.h"
 
 namespace cObjectPool {
 
+/**
+ * @brief 对象池的运行统计
+ */
+struct ObjectPoolStats {
+    uint64_t hits = 0;              // 直接复用空闲对象的次数
+    uint64_t misses = 0;            // 没有空闲对象、需要新建的次数
+    uint64_t failures = 0;          // 达到最大大小或工厂返回空、获取失败的次数
+    uint64_t shrunk = 0;            // 因空闲超时被销毁的对象数
+    size_t total = 0;               // 当前总对象数量（空闲 + 借出）
+    size_t idle = 0;                // 当前空闲对象数量
+    size_t outstanding = 0;         // 当前借出的对象数量
+    size_t peak_outstanding = 0;    // 借出数量的峰值
+    uint64_t wait_count = 0;        // AcquireFor 发生等待的次数
+    uint64_t total_wait_us = 0;     // AcquireFor 累计等待时间（微秒）
+    uint64_t max_wait_us = 0;       // AcquireFor 单次最长等待时间（微秒）
+
+    // 命中率，没有任何获取时返回 0
+    double HitRatio() const {
+        uint64_t requests = hits + misses;
+        return requests == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(requests);
+    }
+};
+
 /**
  * @brief 对象池
  * @tparam T 对象类型
@@ -30,29 +61,106 @@ class ObjectPool {
 
     /**
      * @brief 从池中获取对象
-     * @return 对象智能指针
+     * 新对象在释放锁之后构造，构造耗时不会阻塞其他线程获取或归还
+     * @return 对象智能指针，达到最大大小时返回nullptr
      */
     ObjectPtr Acquire() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (!pool_.empty()) {
-            auto obj = std::move(pool_.front());
-            pool_.pop();
-            return ObjectPtr(obj.release(), [this](T* ptr) { Release(ptr); });
+        std::unique_lock<std::mutex> lock(mutex_);
+        return AcquireLocked(lock);
+    }
+
+    /**
+     * @brief 从池中获取对象，达到最大大小时最多等待 timeout 直到有对象被归还
+     * 等待次数和时间计入统计
+     * @return 对象智能指针，超时返回nullptr
+     */
+    template <typename Rep, typename Period>
+    ObjectPtr AcquireFor(const std::chrono::duration<Rep, Period>& timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (pool_.empty() && !CanGrowLocked()) {
+            auto start = std::chrono::steady_clock::now();
+            available_cv_.wait_for(lock, timeout, [this] { return !pool_.empty() || CanGrowLocked(); });
+            auto waited = std::chrono::steady_clock::now() - start;
+            uint64_t wait_us =
+                static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(waited).count());
+            wait_ns_.Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count()));
+            stats_.wait_count++;
+            stats_.total_wait_us += wait_us;
+            stats_.max_wait_us = std::max(stats_.max_wait_us, wait_us);
         }
+        return AcquireLocked(lock);
+    }
 
-        // 池为空，创建新对象
-        if (max_size_ == 0 || current_size_ < max_size_) {
-            current_size_++;
-            auto obj = factory_();
-            if (!obj) {
-                current_size_--;
-                return nullptr;
+    /**
+     * @brief 预先创建对象，使池中至少有 count 个对象（受最大大小限制）
+     * @return 本次新建的对象数量
+     */
+    size_t Reserve(size_t count) {
+        size_t need = ReserveSlots(count);
+        size_t created = 0;
+        size_t attempted = 0;
+        try {
+            for (; attempted < need; ++attempted) {
+                created += CreateIdle() ? 1 : 0;
             }
-            return ObjectPtr(obj.release(), [this](T* ptr) { Release(ptr); });
+        } catch (...) {
+            // factory 抛出异常，归还尚未用掉的名额
+            ReleaseSlots(need - attempted);
+            throw;
         }
+        return created;
+    }
 
-        // 达到最大大小，返回nullptr
-        return nullptr;
+    /**
+     * @brief 在 executor（如 cThread::ThreadPool）上并行预先创建对象，返回时所有对象已经创建完成
+     * executor 需要提供 ParallelFor(begin, end, func) 并返回 std::future<void>；不要在 executor 自己的任务中调用
+     * executor 不可用或 factory 抛出异常时归还未创建对象的名额，再重新抛出异常
+     * @return 本次新建的对象数量
+     */
+    template <typename Executor>
+    size_t Reserve(size_t count, Executor& executor) {
+        size_t need = ReserveSlots(count);
+        std::atomic<size_t> created{0};
+        std::atomic<size_t> attempted{0};  // 已经返回的 CreateIdle 次数，失败时已自行归还名额
+        try {
+            executor
+                .ParallelFor(size_t(0), need,
+                             [this, &created, &attempted](size_t) {
+                                 if (CreateIdle()) {
+                                     created.fetch_add(1, std::memory_order_relaxed);
+                                 }
+                                 attempted.fetch_add(1, std::memory_order_relaxed);
+                             })
+                .get();
+        } catch (...) {
+            // future 就绪时所有块都已结束或从未开始
+            ReleaseSlots(need - attempted.load());
+            throw;
+        }
+        return created.load();
+    }
+
+    /**
+     * @brief 设置空闲超时，空闲超过 timeout 的对象在之后归还对象或调用 ShrinkIdle 时被销毁，但保留至少 min_idle 个空闲对象
+     * timeout 为 0 表示不自动收缩（默认）
+     */
+    void SetIdleTimeout(std::chrono::milliseconds timeout, size_t min_idle = 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_timeout_ = timeout;
+        min_idle_ = min_idle;
+    }
+
+    /**
+     * @brief 立即销毁空闲超过 SetIdleTimeout 设置时间的对象，可由定时器周期调用
+     * @return 销毁的对象数量
+     */
+    size_t ShrinkIdle() {
+        std::vector<std::unique_ptr<T>> expired;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            CollectExpiredLocked(std::chrono::steady_clock::now(), expired);
+        }
+        return expired.size();
     }
 
     /**
@@ -72,17 +180,161 @@ class ObjectPool {
     }
 
     /**
-     * @brief 清空对象池
+     * @brief 获取运行统计
      */
-    void Clear() {
+    ObjectPoolStats GetStats() const {
         std::lock_guard<std::mutex> lock(mutex_);
-        while (!pool_.empty()) {
-            pool_.pop();
+        ObjectPoolStats stats = stats_;
+        stats.total = current_size_;
+        stats.idle = pool_.size();
+        stats.outstanding = outstanding_;
+        return stats;
+    }
+
+    /**
+     * @brief 获取 AcquireFor 每次等待时间（纳秒）的分布
+     */
+    cMetrics::HistogramSnapshot GetWaitHistogram() const { return wait_ns_.Snapshot(); }
+
+    /**
+     * @brief 把 GetStats 和等待时间分布以 prefix.hits、prefix.hit_ratio、prefix.wait_ns.p99 等名称注册到 registry，
+     * 再次调用时替换之前的注册，对象池析构时自动注销
+     */
+    void ExportMetrics(const std::string& prefix, cMetrics::Registry& registry = cMetrics::Registry::Global()) {
+        metrics_registration_ = registry.AddCollector([this, prefix](cMetrics::Samples& samples) {
+            ObjectPoolStats stats = GetStats();
+            samples.push_back({prefix + ".hits", static_cast<double>(stats.hits)});
+            samples.push_back({prefix + ".misses", static_cast<double>(stats.misses)});
+            samples.push_back({prefix + ".failures", static_cast<double>(stats.failures)});
+            samples.push_back({prefix + ".hit_ratio", stats.HitRatio()});
+            samples.push_back({prefix + ".shrunk", static_cast<double>(stats.shrunk)});
+            samples.push_back({prefix + ".total", static_cast<double>(stats.total)});
+            samples.push_back({prefix + ".idle", static_cast<double>(stats.idle)});
+            samples.push_back({prefix + ".outstanding", static_cast<double>(stats.outstanding)});
+            samples.push_back({prefix + ".peak_outstanding", static_cast<double>(stats.peak_outstanding)});
+            cMetrics::AppendHistogram(samples, prefix + ".wait_ns", GetWaitHistogram());
+        });
+    }
+
+    /**
+     * @brief 清空对象池中的空闲对象，已借出的对象不受影响，归还后照常回到池中
+     */
+    void Clear() {
+        std::deque<IdleObject> idle;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            idle.swap(pool_);
+            current_size_ -= idle.size();
         }
-        current_size_ = 0;
+        available_cv_.notify_all();
     }
 
    private:
+    /**
+     * @brief 空闲对象及其归还时间
+     */
+    struct IdleObject {
+        std::unique_ptr<T> object;
+        std::chrono::steady_clock::time_point idle_since;
+    };
+
+    bool CanGrowLocked() const { return max_size_ == 0 || current_size_ < max_size_; }
+
+    // 调用时持有 lock，新建对象时临时释放
+    ObjectPtr AcquireLocked(std::unique_lock<std::mutex>& lock) {
+        if (!pool_.empty()) {
+            // 后进先出：复用最近归还的对象，长时间空闲的对象留在队头等待收缩
+            auto obj = std::move(pool_.back().object);
+            pool_.pop_back();
+            stats_.hits++;
+            OnCheckoutLocked();
+            return Wrap(obj.release());
+        }
+
+        // 池为空，创建新对象
+        if (!CanGrowLocked()) {
+            // 达到最大大小，返回nullptr
+            stats_.failures++;
+            return nullptr;
+        }
+        current_size_++;
+        stats_.misses++;
+        OnCheckoutLocked();
+        lock.unlock();
+        std::unique_ptr<T> obj = factory_();
+        if (!obj) {
+            lock.lock();
+            current_size_--;
+            outstanding_--;
+            stats_.failures++;
+            lock.unlock();
+            available_cv_.notify_one();
+            return nullptr;
+        }
+        return Wrap(obj.release());
+    }
+
+    void OnCheckoutLocked() {
+        outstanding_++;
+        stats_.peak_outstanding = std::max(stats_.peak_outstanding, outstanding_);
+    }
+
+    ObjectPtr Wrap(T* ptr) {
+        return ObjectPtr(ptr, [this](T* p) { Release(p); });
+    }
+
+    // 为 Reserve 预留名额，返回需要新建的对象数量
+    size_t ReserveSlots(size_t count) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (max_size_ != 0) {
+            count = std::min(count, max_size_);
+        }
+        size_t need = count > current_size_ ? count - current_size_ : 0;
+        current_size_ += need;
+        return need;
+    }
+
+    // 归还 ReserveSlots 预留但没有用来创建对象的名额
+    void ReleaseSlots(size_t count) {
+        if (count == 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            current_size_ -= count;
+        }
+        available_cv_.notify_all();
+    }
+
+    // 在锁外构造一个对象放入空闲队列，名额已由 ReserveSlots 预留
+    bool CreateIdle() {
+        std::unique_ptr<T> obj = factory_();
+        bool created = obj != nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (created) {
+                pool_.push_back({std::move(obj), std::chrono::steady_clock::now()});
+            } else {
+                current_size_--;
+            }
+        }
+        available_cv_.notify_one();
+        return created;
+    }
+
+    // 取出空闲超时的对象，由调用者在锁外销毁
+    void CollectExpiredLocked(std::chrono::steady_clock::time_point now, std::vector<std::unique_ptr<T>>& expired) {
+        if (idle_timeout_.count() <= 0) {
+            return;
+        }
+        while (pool_.size() > min_idle_ && now - pool_.front().idle_since >= idle_timeout_) {
+            expired.push_back(std::move(pool_.front().object));
+            pool_.pop_front();
+            current_size_--;
+            stats_.shrunk++;
+        }
+    }
+
     void Release(T* ptr) {
         if (!ptr) {
             return;
@@ -93,26 +345,40 @@ class ObjectPool {
             reset_(ptr);
         }
 
-        std::lock_guard<std::mutex> lock(mutex_);
-        // 如果池未满或没有限制，将对象放回池中
-        if (max_size_ == 0 || pool_.size() < max_size_) {
-            pool_.push(std::unique_ptr<T>(ptr));
-        } else {
-            // 池已满，直接删除对象
-            delete ptr;
-            current_size_--;
+        std::unique_ptr<T> obj(ptr);
+        std::vector<std::unique_ptr<T>> expired;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            outstanding_--;
+            // 如果池未满或没有限制，将对象放回池中
+            if (max_size_ == 0 || pool_.size() < max_size_) {
+                auto now = std::chrono::steady_clock::now();
+                CollectExpiredLocked(now, expired);
+                pool_.push_back({std::move(obj), now});
+            } else {
+                // 池已满，直接删除对象
+                current_size_--;
+            }
         }
+        available_cv_.notify_one();
     }
 
     mutable std::mutex mutex_;
-    std::queue<std::unique_ptr<T>> pool_;
+    std::condition_variable available_cv_;
+    std::deque<IdleObject> pool_;
     FactoryFunc factory_;
     ResetFunc reset_;
     size_t max_size_;
     size_t current_size_ = 0;
+    size_t outstanding_ = 0;
+    std::chrono::milliseconds idle_timeout_{0};
+    size_t min_idle_ = 0;
+    ObjectPoolStats stats_;
+    cMetrics::Histogram wait_ns_;
+    // 放在最后，最先析构，注销之后不会再有采集函数访问其他成员
+    cMetrics::Registration metrics_registration_;
 };
 
 }  // namespace cObjectPool
 
 #endif  // __OBJECT_POOL__
-
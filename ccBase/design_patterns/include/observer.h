@@ -2,10 +2,12 @@
 #define __OBSERVER__
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 namespace cObserver {
@@ -175,6 +177,335 @@ class Subject {
     ObserverId next_observer_id_;
 };
 
+/**
+ * @brief 非拥有注册的生命周期令牌，由 FastSubject::Attach(Observer<T>&) 返回
+ * 令牌析构或 Reset 时从主题中移除观察者，并等待其他线程中正在进行的 Notify 结束，
+ * 之后观察者可以安全销毁；通常把令牌作为观察者的最后一个成员，使其最先析构。主题先于令牌销毁时令牌什么也不做
+ */
+class ObserverToken {
+   public:
+    /**
+     * @brief 令牌指向的主题
+     */
+    class Target {
+       public:
+        virtual ~Target() = default;
+        virtual bool Release(ObserverId observer_id) = 0;
+    };
+
+    ObserverToken() = default;
+    ObserverToken(std::weak_ptr<Target> target, ObserverId id) : target_(std::move(target)), id_(id) {}
+    ~ObserverToken() { Reset(); }
+
+    ObserverToken(ObserverToken&& other) noexcept : target_(std::move(other.target_)), id_(other.id_) { other.id_ = 0; }
+    ObserverToken& operator=(ObserverToken&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            target_ = std::move(other.target_);
+            id_ = other.id_;
+            other.id_ = 0;
+        }
+        return *this;
+    }
+    ObserverToken(const ObserverToken&) = delete;
+    ObserverToken& operator=(const ObserverToken&) = delete;
+
+    /**
+     * @brief 从主题中移除观察者
+     * @return 观察者此前是否仍在主题中
+     */
+    bool Reset() {
+        bool released = false;
+        if (id_ != 0) {
+            if (auto target = target_.lock()) {
+                released = target->Release(id_);
+            }
+            target_.reset();
+            id_ = 0;
+        }
+        return released;
+    }
+
+    bool IsValid() const { return id_ != 0; }
+    ObserverId GetId() const { return id_; }
+
+   private:
+    std::weak_ptr<Target> target_;
+    ObserverId id_ = 0;
+};
+
+/**
+ * @brief 面向高频通知的主题
+ *
+ * 观察者列表是不可变快照，只在 Attach/Detach 时复制并替换；Notify 不加锁、不复制、不清理，
+ * 只在两个读者计数之一上加减一次，然后依次调用观察者。旧快照在所有读者离开后释放（两阶段计数的宽限期）。
+ * 以 shared_ptr 注册的观察者仍是弱引用，每次通知需要 lock()；发现已失效的项只做标记，
+ * 在下一次 Attach/Detach 或 Compact 时一并移除。以引用注册的观察者不做引用计数，由返回的 ObserverToken 管理生命周期，
+ * 通知时就是一次虚函数调用。
+ * 注意：Attach/Detach 会等待其他线程中正在进行的 Notify；在 Update 中对同一主题调用时不等待，旧快照推迟到下一次修改时释放
+ * @tparam T 通知数据的类型
+ */
+template <typename T>
+class FastSubject {
+   public:
+    FastSubject() : state_(std::make_shared<State>()) {}
+    ~FastSubject() { state_->Clear(); }
+
+    FastSubject(const FastSubject&) = delete;
+    FastSubject& operator=(const FastSubject&) = delete;
+
+    /**
+     * @brief 添加观察者（弱引用）
+     * @return 观察者ID，用于移除观察者
+     */
+    ObserverId Attach(std::shared_ptr<Observer<T>> observer) {
+        if (!observer) {
+            return 0;
+        }
+        Entry entry;
+        entry.weak = observer;
+        return state_->Add(std::move(entry));
+    }
+
+    /**
+     * @brief 添加观察者（不做引用计数）
+     * @param observer 观察者，需要在令牌析构或 Reset 之后才销毁
+     * @return 生命周期令牌
+     */
+    ObserverToken Attach(Observer<T>& observer) {
+        Entry entry;
+        entry.raw = &observer;
+        ObserverId id = state_->Add(std::move(entry));
+        return ObserverToken(std::weak_ptr<ObserverToken::Target>(state_), id);
+    }
+
+    /**
+     * @brief 移除观察者
+     * @param observer_id 观察者ID
+     * @return 是否成功移除
+     */
+    bool Detach(ObserverId observer_id) { return state_->Release(observer_id); }
+
+    /**
+     * @brief 移除观察者（通过观察者指针）
+     * @return 移除的观察者数量
+     */
+    size_t Detach(const std::shared_ptr<Observer<T>>& observer) {
+        if (!observer) {
+            return 0;
+        }
+        return state_->Remove([&observer](const Entry& entry) {
+            return entry.raw == nullptr && !entry.weak.owner_before(observer) && !observer.owner_before(entry.weak);
+        });
+    }
+
+    /**
+     * @brief 通知所有观察者
+     * @param data 通知数据
+     * @return 实际通知的观察者数量
+     */
+    size_t Notify(const T& data) {
+        State& state = *state_;
+        NotifyFrame frame(&state);
+        size_t epoch = state.epoch.load();
+        std::atomic<size_t>& readers = state.readers[epoch & 1].count;
+        readers.fetch_add(1);
+
+        size_t notified_count = 0;
+        bool found_expired = false;
+        for (const Entry& entry : *state.list.load()) {
+            try {
+                if (entry.raw != nullptr) {
+                    entry.raw->Update(data);
+                    notified_count++;
+                } else if (auto observer = entry.weak.lock()) {
+                    observer->Update(data);
+                    notified_count++;
+                } else {
+                    found_expired = true;
+                }
+            } catch (...) {
+                // 忽略观察者回调中的异常，避免影响其他观察者
+            }
+        }
+
+        readers.fetch_sub(1);
+        if (found_expired) {
+            state.has_expired.store(true, std::memory_order_relaxed);
+        }
+        return notified_count;
+    }
+
+    /**
+     * @brief 立即移除已失效的弱引用观察者
+     * @return 移除的数量
+     */
+    size_t Compact() {
+        return state_->Remove([](const Entry& entry) { return entry.raw == nullptr && entry.weak.expired(); });
+    }
+
+    /**
+     * @brief 获取观察者数量
+     * @return 观察者数量（不包括已失效的）
+     */
+    size_t GetObserverCount() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        const List& list = *state_->list.load();
+        return std::count_if(list.begin(), list.end(),
+                             [](const Entry& entry) { return entry.raw != nullptr || !entry.weak.expired(); });
+    }
+
+    /**
+     * @brief 清空所有观察者，已发出的令牌随之失效
+     */
+    void Clear() { state_->Clear(); }
+
+   private:
+    struct Entry {
+        ObserverId id = 0;
+        Observer<T>* raw = nullptr;  // 以引用注册时非空
+        std::weak_ptr<Observer<T>> weak;
+    };
+
+    using List = std::vector<Entry>;
+
+    /**
+     * @brief 主题的共享状态，令牌通过弱引用访问
+     * 修改在 mutex 内生成新快照并替换 list，然后在锁外翻转 epoch 两次，每次等待旧 epoch 的读者计数归零，
+     * 两个计数都等过一次后不会再有读者持有旧快照
+     */
+    struct State : ObserverToken::Target {
+        struct alignas(64) ReaderCount {
+            std::atomic<size_t> count{0};
+        };
+
+        mutable std::mutex mutex;
+        std::mutex sync_mutex;  // 串行化宽限期等待，保证每次等待的两个 epoch 奇偶不同
+        std::atomic<const List*> list{new List()};
+        std::atomic<size_t> epoch{0};
+        ReaderCount readers[2];
+        std::atomic<bool> has_expired{false};
+        ObserverId next_observer_id = 1;
+        std::vector<const List*> retired;  // 替换下来、尚未释放的快照
+
+        ~State() override {
+            delete list.load();
+            for (const List* old : retired) {
+                delete old;
+            }
+        }
+
+        ObserverId Add(Entry entry) {
+            ObserverId id;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                id = entry.id = next_observer_id++;
+                List next = *list.load();
+                CompactLocked(next);
+                next.push_back(std::move(entry));
+                ReplaceLocked(std::move(next));
+            }
+            Reclaim();
+            return id;
+        }
+
+        bool Release(ObserverId observer_id) override {
+            return Remove([observer_id](const Entry& entry) { return entry.id == observer_id; }) > 0;
+        }
+
+        template <typename Pred>
+        size_t Remove(Pred pred) {
+            size_t count;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                List next = *list.load();
+                next.erase(std::remove_if(next.begin(), next.end(), pred), next.end());
+                count = list.load()->size() - next.size();
+                if (count == 0) {
+                    return 0;
+                }
+                CompactLocked(next);
+                ReplaceLocked(std::move(next));
+            }
+            Reclaim();
+            return count;
+        }
+
+        void Clear() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ReplaceLocked(List());
+            }
+            Reclaim();
+        }
+
+        // 生成新快照时顺便移除 Notify 标记过的失效项
+        void CompactLocked(List& next) {
+            if (has_expired.exchange(false, std::memory_order_relaxed)) {
+                next.erase(std::remove_if(next.begin(), next.end(),
+                                          [](const Entry& entry) { return entry.raw == nullptr && entry.weak.expired(); }),
+                           next.end());
+            }
+        }
+
+        void ReplaceLocked(List next) { retired.push_back(list.exchange(new List(std::move(next)))); }
+
+        /**
+         * @brief 等待宽限期后释放已替换的快照；当前线程正在通知本主题时不等待，留给下一次修改释放
+         */
+        void Reclaim() {
+            if (NotifyFrame::IsNotifying(this)) {
+                return;
+            }
+            std::vector<const List*> garbage;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                garbage.swap(retired);
+            }
+            {
+                std::lock_guard<std::mutex> lock(sync_mutex);
+                for (int phase = 0; phase < 2; ++phase) {
+                    size_t old_epoch = epoch.fetch_add(1);
+                    while (readers[old_epoch & 1].count.load() != 0) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+            for (const List* old : garbage) {
+                delete old;
+            }
+        }
+    };
+
+    /**
+     * @brief 记录当前线程正在通知的主题，用于识别 Update 中对同一主题的修改
+     */
+    class NotifyFrame {
+       public:
+        explicit NotifyFrame(const State* state) : state_(state), prev_(top_) { top_ = this; }
+        ~NotifyFrame() { top_ = prev_; }
+
+        static bool IsNotifying(const State* state) {
+            for (const NotifyFrame* frame = top_; frame != nullptr; frame = frame->prev_) {
+                if (frame->state_ == state) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+       private:
+        const State* state_;
+        const NotifyFrame* prev_;
+        static thread_local const NotifyFrame* top_;
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+template <typename T>
+thread_local const typename FastSubject<T>::NotifyFrame* FastSubject<T>::NotifyFrame::top_ = nullptr;
+
 /**
  * @brief 函数式观察者适配器
  * 允许使用函数或lambda作为观察者
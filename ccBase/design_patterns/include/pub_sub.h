@@ -1,14 +1,20 @@
 #ifndef __PUB_SUB__
 #define __PUB_SUB__
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
+#include "metrics.h"
 
 namespace cPubSub {
 
@@ -24,6 +30,59 @@ using SubscriberId = uint64_t;
 template <typename T>
 using MessageCallback = std::function<void(const std::string& topic, const T& message)>;
 
+/**
+ * @brief 批量消息回调函数类型，messages 指向 count 条属于同一主题的消息，只在回调期间有效
+ * @tparam T 消息数据类型
+ */
+template <typename T>
+using BatchCallback = std::function<void(const std::string& topic, const T* messages, size_t count)>;
+
+/**
+ * @brief 异步订阅者队列已满时的处理方式
+ */
+enum class BackpressurePolicy {
+    kBlock,           // 发布者等待队列出现空位
+    kDropOldest,      // 丢弃队列中最早的消息
+    kConflateLatest,  // 每个主题只保留最新一条尚未投递的消息，队列仍然满时丢弃最早的消息
+};
+
+/**
+ * @brief 异步订阅选项
+ */
+struct AsyncSubscribeOptions {
+    size_t queue_capacity = 1024;  // 队列最多缓存的消息数
+    size_t max_batch = 64;         // 一次回调最多投递的消息数
+    BackpressurePolicy policy = BackpressurePolicy::kBlock;
+};
+
+/**
+ * @brief 异步订阅者的投递统计
+ */
+struct AsyncSubscriberStats {
+    uint64_t enqueued = 0;   // 进入队列的消息数
+    uint64_t delivered = 0;  // 已交给回调的消息数
+    uint64_t dropped = 0;    // 因队列满被丢弃的消息数
+    uint64_t conflated = 0;  // 被同主题新消息覆盖的消息数
+    uint64_t batches = 0;    // 回调批次数
+    size_t pending = 0;      // 当前队列中的消息数
+};
+
+/**
+ * @brief PubSub 的运行指标，由 GetMetrics 返回，ExportMetrics 导出的也是同一份数据
+ * async_* 为当前所有异步订阅者的投递统计之和，publish_ns 为抽样记录的一次 Publish 的耗时（包括同步回调和 kBlock 时的等待）
+ */
+struct PubSubMetrics {
+    uint64_t published = 0;   // Publish/PublishToAll 调用次数
+    uint64_t delivered = 0;   // 收到消息的订阅者累计数量，即 Publish 返回值之和
+    uint64_t unmatched = 0;   // 没有任何订阅者收到的发布次数
+    uint64_t async_enqueued = 0;   // 以下四项包括已取消的异步订阅者，只增不减
+    uint64_t async_delivered = 0;
+    uint64_t async_dropped = 0;
+    uint64_t async_conflated = 0;
+    size_t async_pending = 0;  // 现有异步队列中的消息数
+    cMetrics::HistogramSnapshot publish_ns;
+};
+
 /**
  * @brief 订阅者信息
  * @tparam T 消息数据类型
@@ -35,93 +94,313 @@ struct Subscriber {
     std::string topic;
 
     Subscriber(SubscriberId id, const std::string& topic, MessageCallback<T> callback)
-        : id(id), topic(topic), callback(std::move(callback)) {}
+        : id(id), callback(std::move(callback)), topic(topic) {}
+};
+
+/**
+ * @brief 已注册主题的句柄，由 PubSub::Intern 返回
+ * id 是从 0 开始的连续整数，按句柄发布时直接下标访问订阅表，不需要对主题字符串求哈希；
+ * 句柄只在创建它的 PubSub 中有效，主题注册后不会被注销
+ */
+struct TopicHandle {
+    static constexpr uint32_t kInvalidId = UINT32_MAX;
+
+    uint32_t id = kInvalidId;
+
+    bool IsValid() const { return id != kInvalidId; }
+    bool operator==(const TopicHandle& other) const { return id == other.id; }
+    bool operator!=(const TopicHandle& other) const { return id != other.id; }
+};
+
+/**
+ * @brief 发布路径的实现方式
+ */
+enum class PublishMode {
+    kLocked,      // 每次发布在锁内复制订阅者列表（默认）
+    kReadMostly,  // 订阅表是不可变快照，发布时不加 mutex_、不复制；订阅/取消订阅时写时复制并原子替换快照
 };
 
 /**
  * @brief 发布-订阅模式实现
+ * 主题在第一次订阅或调用 Intern 时注册为连续的整数ID，订阅表是按ID下标访问的数组；
+ * 以字符串为参数的接口先查找主题ID，再走与 TopicHandle 相同的路径
+ *
+ * 主题按 '.' 分为多段，订阅时某一段为 "*" 表示匹配任意一段，为 "#" 表示匹配零段或多段，
+ * 例如 "market.*.trades" 匹配 "market.AAPL.trades"，"market.#" 匹配 "market"、"market.AAPL.trades"。
+ * 通配订阅保存在按段组织的前缀树中，发布时沿主题的各段查找，代价与主题深度成正比；没有通配订阅时不做查找。
+ * 只被通配订阅匹配的主题不注册，每次发布时查找前缀树。另有订阅者ID到其订阅的反向索引，按ID取消订阅不需要遍历所有主题
  * @tparam T 消息数据类型
  */
 template <typename T>
 class PubSub {
    public:
-    PubSub() : next_subscriber_id_(1) {}
+    /**
+     * @param resource Publish 复制订阅者列表时使用的内存资源，例如按请求创建的 cAllocator::Arena；
+     * 资源需要比 PubSub 活得更久，多个线程同时 Publish 时需要是线程安全的
+     */
+    explicit PubSub(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : PubSub(PublishMode::kLocked, resource) {}
+
+    /**
+     * @param mode 发布路径的实现方式，订阅者变化少而发布频繁时使用 kReadMostly
+     * @param resource 同上，只在 kLocked 模式下使用
+     */
+    explicit PubSub(PublishMode mode, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : pattern_root_(std::make_unique<PatternNode>()), next_subscriber_id_(1), resource_(resource), mode_(mode) {
+        if (mode_ == PublishMode::kReadMostly) {
+            auto snapshot = std::make_shared<Snapshot>();
+            snapshot->topic_ids = std::make_shared<const TopicIdMap>();
+            std::atomic_store(&snapshot_, std::shared_ptr<const Snapshot>(std::move(snapshot)));
+        }
+    }
 
+    /**
+     * 异步订阅者队列中尚未投递的消息会被丢弃；投递批次引用本对象中的主题名称，
+     * 析构会等待正在执行的批次完成，因此不能在异步订阅者的回调中销毁 PubSub
+     */
     ~PubSub() {
+        AsyncQueueList closed;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            CloseAsyncQueuesLocked(closed);
+        }
+        WaitClosed(closed);
         std::lock_guard<std::mutex> lock(mutex_);
         subscribers_.clear();
+        pattern_root_.reset();
     }
 
     /**
-     * @brief 订阅主题
+     * @brief 注册主题并返回其句柄，主题已注册时返回已有的句柄
      * @param topic 主题名称
+     * @return 主题句柄
+     */
+    TopicHandle Intern(const std::string& topic) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return InternLocked(topic);
+    }
+
+    /**
+     * @brief 查找已注册的主题，不会注册新主题
+     * @return 主题句柄，主题未注册时返回无效句柄
+     */
+    TopicHandle Find(const std::string& topic) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return FindLocked(topic);
+    }
+
+    /**
+     * @brief 获取句柄对应的主题名称，返回的引用在 PubSub 的生命周期内有效
+     */
+    const std::string& GetTopicName(TopicHandle handle) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return topic_names_.at(handle.id);
+    }
+
+    /**
+     * @brief 订阅主题
+     * @param topic 主题名称，可以包含 "*" 或 "#" 通配段；回调收到的是实际发布的主题
      * @param callback 消息回调函数
      * @return 订阅者ID，用于取消订阅
      */
     SubscriberId Subscribe(const std::string& topic, MessageCallback<T> callback) {
         std::lock_guard<std::mutex> lock(mutex_);
-        SubscriberId id = next_subscriber_id_++;
-        auto subscriber = std::make_shared<Subscriber<T>>(id, topic, std::move(callback));
-        subscribers_[topic].push_back(subscriber);
+        return SubscribeTopicLocked(topic, std::move(callback));
+    }
+
+    /**
+     * @brief 按句柄订阅主题
+     * @return 订阅者ID，句柄无效时返回 0
+     */
+    SubscriberId Subscribe(TopicHandle handle, MessageCallback<T> callback) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (handle.id >= subscribers_.size()) {
+            return 0;
+        }
+        return SubscribeLocked(handle, std::move(callback));
+    }
+
+    /**
+     * @brief 异步订阅主题：消息先放入该订阅者独占的有界队列，再由 executor 上的任务按批取出交给 callback，
+     * 慢订阅者只会占满自己的队列，不会阻塞发布者（kBlock 策略下队列满时除外）
+     * 同一订阅者的回调不会并发执行；executor 需要提供 bool Post(F)，例如 cThread::ThreadPool，且比订阅者活得更久
+     * 注意：kBlock 策略下不要在 executor 自己的任务中发布消息，所有线程都在等待队列空位时会死锁
+     * @param topic 主题名称，可以包含通配段
+     * @param callback 批量消息回调函数
+     * @param executor 执行投递任务的线程池
+     * @param options 队列容量、批大小与背压策略
+     * @return 订阅者ID，用于取消订阅
+     */
+    template <typename Executor>
+    SubscriberId SubscribeAsync(const std::string& topic, BatchCallback<T> callback, Executor& executor,
+                                AsyncSubscribeOptions options = {}) {
+        auto queue = MakeAsyncQueue(std::move(callback), executor, options);
+        std::lock_guard<std::mutex> lock(mutex_);
+        SubscriberId id = SubscribeTopicLocked(topic, QueueCallback(queue));
+        async_queues_.emplace(id, std::move(queue));
+        return id;
+    }
+
+    /**
+     * @brief 按句柄异步订阅主题
+     * @return 订阅者ID，句柄无效时返回 0
+     */
+    template <typename Executor>
+    SubscriberId SubscribeAsync(TopicHandle handle, BatchCallback<T> callback, Executor& executor,
+                                AsyncSubscribeOptions options = {}) {
+        auto queue = MakeAsyncQueue(std::move(callback), executor, options);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (handle.id >= subscribers_.size()) {
+            return 0;
+        }
+        SubscriberId id = SubscribeLocked(handle, QueueCallback(queue));
+        async_queues_.emplace(id, std::move(queue));
         return id;
     }
 
+    /**
+     * @brief 等待所有异步订阅者的队列投递完毕
+     */
+    void WaitAsyncIdle() {
+        std::vector<std::shared_ptr<AsyncQueue>> queues;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& [id, queue] : async_queues_) {
+                queues.push_back(queue);
+            }
+        }
+        for (const auto& queue : queues) {
+            queue->WaitIdle();
+        }
+    }
+
+    /**
+     * @brief 获取异步订阅者的投递统计，不是异步订阅者时返回全 0
+     */
+    AsyncSubscriberStats GetAsyncStats(SubscriberId subscriber_id) const {
+        std::shared_ptr<AsyncQueue> queue;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = async_queues_.find(subscriber_id);
+            if (it == async_queues_.end()) {
+                return {};
+            }
+            queue = it->second;
+        }
+        return queue->GetStats();
+    }
+
+    /**
+     * @brief 获取运行指标
+     */
+    PubSubMetrics GetMetrics() const {
+        std::vector<std::shared_ptr<AsyncQueue>> queues;
+        PubSubMetrics metrics;
+        {
+            // 与关闭队列在同一把锁内读取，每个队列要么在 async_queues_ 中，要么已计入 closed_async_*
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& entry : async_queues_) {
+                queues.push_back(entry.second);
+            }
+            metrics.async_enqueued = closed_async_enqueued_.Value();
+            metrics.async_delivered = closed_async_delivered_.Value();
+            metrics.async_dropped = closed_async_dropped_.Value();
+            metrics.async_conflated = closed_async_conflated_.Value();
+        }
+        metrics.published = published_num_.Value();
+        metrics.delivered = delivered_num_.Value();
+        metrics.unmatched = unmatched_num_.Value();
+        for (const auto& queue : queues) {
+            AsyncSubscriberStats stats = queue->GetStats();
+            metrics.async_enqueued += stats.enqueued;
+            metrics.async_delivered += stats.delivered;
+            metrics.async_dropped += stats.dropped;
+            metrics.async_conflated += stats.conflated;
+            metrics.async_pending += stats.pending;
+        }
+        metrics.publish_ns = publish_ns_.Snapshot();
+        return metrics;
+    }
+
+    /**
+     * @brief 把运行指标以 prefix.published、prefix.publish_ns.p99 等名称注册到 registry，
+     * 再次调用时替换之前的注册，PubSub 析构时自动注销
+     */
+    void ExportMetrics(const std::string& prefix, cMetrics::Registry& registry = cMetrics::Registry::Global()) {
+        metrics_registration_ = registry.AddCollector([this, prefix](cMetrics::Samples& samples) {
+            PubSubMetrics metrics = GetMetrics();
+            samples.push_back({prefix + ".published", static_cast<double>(metrics.published)});
+            samples.push_back({prefix + ".delivered", static_cast<double>(metrics.delivered)});
+            samples.push_back({prefix + ".unmatched", static_cast<double>(metrics.unmatched)});
+            samples.push_back({prefix + ".async_enqueued", static_cast<double>(metrics.async_enqueued)});
+            samples.push_back({prefix + ".async_delivered", static_cast<double>(metrics.async_delivered)});
+            samples.push_back({prefix + ".async_dropped", static_cast<double>(metrics.async_dropped)});
+            samples.push_back({prefix + ".async_conflated", static_cast<double>(metrics.async_conflated)});
+            samples.push_back({prefix + ".async_pending", static_cast<double>(metrics.async_pending)});
+            cMetrics::AppendHistogram(samples, prefix + ".publish_ns", metrics.publish_ns);
+        });
+    }
+
     /**
      * @brief 取消订阅
-     * @param topic 主题名称
+     * 异步订阅者的回调正在执行时等待其返回，之后不会再收到消息；在该订阅者自己的回调中取消时不等待。
+     * 注意：不要在两个异步订阅者的回调中互相取消对方，双方都在等待对方返回时会死锁
+     * @param topic 主题名称，通配订阅需要传入订阅时的模式
      * @param subscriber_id 订阅者ID
      * @return 是否成功取消订阅
      */
     bool Unsubscribe(const std::string& topic, SubscriberId subscriber_id) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = subscribers_.find(topic);
-        if (it == subscribers_.end()) {
-            return false;
+        AsyncQueueList closed;
+        bool removed = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (IsPattern(topic)) {
+                PatternNode* node = FindPattern(*pattern_root_, topic);
+                removed = node != nullptr && UnsubscribeLocked({TopicHandle::kInvalidId, node}, subscriber_id, closed);
+            } else {
+                TopicHandle handle = FindLocked(topic);
+                removed = handle.IsValid() && UnsubscribeLocked({handle.id, nullptr}, subscriber_id, closed);
+            }
         }
+        WaitClosed(closed);
+        return removed;
+    }
 
-        auto& subscribers = it->second;
-        for (auto sub_it = subscribers.begin(); sub_it != subscribers.end(); ++sub_it) {
-            if ((*sub_it)->id == subscriber_id) {
-                subscribers.erase(sub_it);
-                if (subscribers.empty()) {
-                    subscribers_.erase(it);
-                }
-                return true;
-            }
+    /**
+     * @brief 按句柄取消订阅，等待方式与 Unsubscribe(topic) 相同
+     */
+    bool Unsubscribe(TopicHandle handle, SubscriberId subscriber_id) {
+        AsyncQueueList closed;
+        bool removed = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            removed = handle.IsValid() && UnsubscribeLocked({handle.id, nullptr}, subscriber_id, closed);
         }
-        return false;
+        WaitClosed(closed);
+        return removed;
     }
 
     /**
-     * @brief 取消所有订阅（通过订阅者ID）
+     * @brief 取消所有订阅（通过订阅者ID），只访问该ID自己的订阅，等待方式与 Unsubscribe 相同
      * @param subscriber_id 订阅者ID
      * @return 取消的订阅数量
      */
     size_t UnsubscribeAll(SubscriberId subscriber_id) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        size_t count = 0;
-        std::vector<std::string> empty_topics;
-
-        for (auto& [topic, subscribers] : subscribers_) {
-            for (auto it = subscribers.begin(); it != subscribers.end();) {
-                if ((*it)->id == subscriber_id) {
-                    it = subscribers.erase(it);
-                    count++;
-                } else {
-                    ++it;
-                }
+        AsyncQueueList closed;
+        std::vector<SubscriptionKey> keys;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = subscriptions_.find(subscriber_id);
+            if (it == subscriptions_.end()) {
+                return 0;
             }
-            if (subscribers.empty()) {
-                empty_topics.push_back(topic);
+            keys = it->second;
+            for (const SubscriptionKey& key : keys) {
+                UnsubscribeLocked(key, subscriber_id, closed);
             }
         }
-
-        // 清理空主题
-        for (const auto& topic : empty_topics) {
-            subscribers_.erase(topic);
-        }
-
-        return count;
+        WaitClosed(closed);
+        return keys.size();
     }
 
     /**
@@ -131,27 +410,65 @@ class PubSub {
      * @return 接收到消息的订阅者数量
      */
     size_t Publish(const std::string& topic, const T& message) {
-        std::vector<std::shared_ptr<Subscriber<T>>> subscribers_copy;
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            auto it = subscribers_.find(topic);
-            if (it == subscribers_.end()) {
-                return 0;
+        return Instrument([&]() -> size_t {
+            if (mode_ == PublishMode::kReadMostly) {
+                std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&snapshot_);
+                auto it = snapshot->topic_ids->find(topic);
+                if (it != snapshot->topic_ids->end()) {
+                    return PublishSnapshot(*snapshot, it->second, message);
+                }
+                if (!snapshot->patterns || MatchPatterns(*snapshot->patterns, topic).empty()) {
+                    return 0;
+                }
+                std::vector<PatternTarget> targets;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    CopyPatternTargetsLocked(topic, targets);
+                }
+                return PublishUnregistered(topic, targets, message);
             }
-            // 复制订阅者列表，避免在回调时持有锁
-            subscribers_copy = it->second;
-        }
 
-        // 在锁外执行回调
-        for (const auto& subscriber : subscribers_copy) {
-            try {
-                subscriber->callback(topic, message);
-            } catch (...) {
-                // 忽略回调中的异常，避免影响其他订阅者
+            std::pmr::vector<std::shared_ptr<Subscriber<T>>> subscribers_copy(resource_);
+            std::vector<PatternTarget> targets;
+            const std::string* name = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                TopicHandle handle = FindLocked(topic);
+                if (handle.IsValid()) {
+                    name = CopySubscribersLocked(handle, subscribers_copy);
+                } else {
+                    CopyPatternTargetsLocked(topic, targets);
+                }
             }
-        }
+            if (name == nullptr) {
+                return PublishUnregistered(topic, targets, message);
+            }
+            return PublishCopy(*name, subscribers_copy, message);
+        });
+    }
 
-        return subscribers_copy.size();
+    /**
+     * @brief 按句柄发布消息，不对主题字符串做哈希和比较
+     * @return 接收到消息的订阅者数量
+     */
+    size_t Publish(TopicHandle handle, const T& message) {
+        return Instrument([&]() -> size_t {
+            if (mode_ == PublishMode::kReadMostly) {
+                std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&snapshot_);
+                return PublishSnapshot(*snapshot, handle.id, message);
+            }
+
+            std::pmr::vector<std::shared_ptr<Subscriber<T>>> subscribers_copy(resource_);
+            const std::string* name = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (handle.id >= subscribers_.size()) {
+                    return 0;
+                }
+                name = CopySubscribersLocked(handle, subscribers_copy);
+            }
+            return PublishCopy(*name, subscribers_copy, message);
+        });
     }
 
     /**
@@ -160,40 +477,73 @@ class PubSub {
      * @return 接收到消息的订阅者总数
      */
     size_t PublishToAll(const T& message) {
-        std::unordered_map<std::string, std::vector<std::shared_ptr<Subscriber<T>>>> subscribers_copy;
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            subscribers_copy = subscribers_;
-        }
+        return Instrument([&]() -> size_t {
+            if (mode_ == PublishMode::kReadMostly) {
+                std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&snapshot_);
+                size_t total_count = 0;
+                for (const SnapshotEntry& entry : snapshot->entries) {
+                    if (entry.subscribers) {
+                        total_count += Deliver(*entry.topic, *entry.subscribers, message);
+                    }
+                }
+                if (snapshot->patterns) {
+                    for (const PatternNode* node : CollectPatterns(*snapshot->patterns)) {
+                        total_count += Deliver(*node->pattern, node->subscribers, message);
+                    }
+                }
+                return total_count;
+            }
 
-        size_t total_count = 0;
-        // 在锁外执行回调
-        for (const auto& [topic, subscribers] : subscribers_copy) {
-            for (const auto& subscriber : subscribers) {
-                try {
-                    subscriber->callback(topic, message);
-                    total_count++;
-                } catch (...) {
-                    // 忽略回调中的异常
+            // 通配订阅者收到的主题是其订阅模式
+            std::vector<std::pair<const std::string*, SubscriberList>> subscribers_copy;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (size_t id = 0; id < subscribers_.size(); ++id) {
+                    if (!subscribers_[id].empty()) {
+                        subscribers_copy.emplace_back(&topic_names_[id], subscribers_[id]);
+                    }
+                }
+                for (const PatternNode* node : CollectPatterns(*pattern_root_)) {
+                    subscribers_copy.emplace_back(node->pattern, node->subscribers);
                 }
             }
-        }
 
-        return total_count;
+            size_t total_count = 0;
+            // 在锁外执行回调
+            for (const auto& [topic, subscribers] : subscribers_copy) {
+                total_count += Deliver(*topic, subscribers, message);
+            }
+
+            return total_count;
+        });
     }
 
     /**
      * @brief 获取指定主题的订阅者数量
-     * @param topic 主题名称
+     * @param topic 主题名称；普通主题返回发布时会收到消息的订阅者数量（包括匹配的通配订阅），
+     * 通配模式返回以该模式订阅的订阅者数量
      * @return 订阅者数量
      */
     size_t GetSubscriberCount(const std::string& topic) const {
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = subscribers_.find(topic);
-        if (it == subscribers_.end()) {
+        if (IsPattern(topic)) {
+            const PatternNode* node = FindPattern(*pattern_root_, topic);
+            return node != nullptr ? node->subscribers.size() : 0;
+        }
+        TopicHandle handle = FindLocked(topic);
+        size_t count = handle.IsValid() ? subscribers_[handle.id].size() : 0;
+        return count + CountPatternSubscribersLocked(topic);
+    }
+
+    /**
+     * @brief 按句柄获取订阅者数量，包括匹配的通配订阅
+     */
+    size_t GetSubscriberCount(TopicHandle handle) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (handle.id >= subscribers_.size()) {
             return 0;
         }
-        return it->second.size();
+        return subscribers_[handle.id].size() + CountPatternSubscribersLocked(topic_names_[handle.id]);
     }
 
     /**
@@ -203,22 +553,26 @@ class PubSub {
     size_t GetTotalSubscriberCount() const {
         std::lock_guard<std::mutex> lock(mutex_);
         size_t total = 0;
-        for (const auto& [topic, subscribers] : subscribers_) {
+        for (const auto& subscribers : subscribers_) {
             total += subscribers.size();
         }
-        return total;
+        return total + pattern_subscriber_count_;
     }
 
     /**
      * @brief 获取所有主题列表
-     * @return 主题名称列表
+     * @return 存在订阅者的主题名称列表，之后是存在订阅者的通配模式
      */
     std::vector<std::string> GetAllTopics() const {
         std::lock_guard<std::mutex> lock(mutex_);
         std::vector<std::string> topics;
-        topics.reserve(subscribers_.size());
-        for (const auto& [topic, subscribers] : subscribers_) {
-            topics.push_back(topic);
+        for (size_t id = 0; id < subscribers_.size(); ++id) {
+            if (!subscribers_[id].empty()) {
+                topics.push_back(topic_names_[id]);
+            }
+        }
+        for (const PatternNode* node : CollectPatterns(*pattern_root_)) {
+            topics.push_back(*node->pattern);
         }
         return topics;
     }
@@ -229,26 +583,802 @@ class PubSub {
      * @return 是否存在订阅者
      */
     bool HasSubscribers(const std::string& topic) const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = subscribers_.find(topic);
-        return it != subscribers_.end() && !it->second.empty();
+        if (mode_ == PublishMode::kReadMostly && !IsPattern(topic)) {
+            std::shared_ptr<const Snapshot> snapshot = std::atomic_load(&snapshot_);
+            auto it = snapshot->topic_ids->find(topic);
+            if (it != snapshot->topic_ids->end() && it->second < snapshot->entries.size() &&
+                snapshot->entries[it->second].subscribers != nullptr) {
+                return true;
+            }
+            return snapshot->patterns && !MatchPatterns(*snapshot->patterns, topic).empty();
+        }
+        return GetSubscriberCount(topic) > 0;
     }
 
     /**
-     * @brief 清空所有订阅
+     * @brief 清空所有订阅，已注册的主题和句柄仍然有效；等待正在执行的异步回调返回，当前回调所属的订阅者除外
      */
     void Clear() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        subscribers_.clear();
+        AsyncQueueList closed;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& subscribers : subscribers_) {
+                subscribers.clear();
+            }
+            ClearPatterns(*pattern_root_);
+            pattern_subscriber_count_ = 0;
+            subscriptions_.clear();
+            CloseAsyncQueuesLocked(closed);
+            RefreshSnapshotLocked(nullptr);
+        }
+        WaitClosed(closed);
     }
 
    private:
+    using SubscriberList = std::vector<std::shared_ptr<Subscriber<T>>>;
+    using TopicIdMap = std::unordered_map<std::string, uint32_t>;
+
+    // cMetrics::ShouldSample 的抽样点
+    struct PublishSample {};
+
+    /**
+     * @brief 统计一次发布，publish 返回收到消息的订阅者数量，被抽中时记录耗时
+     */
+    template <typename F>
+    size_t Instrument(F&& publish) {
+        cMetrics::ScopedTimer timer(cMetrics::ShouldSample<PublishSample>() ? &publish_ns_ : nullptr);
+        size_t delivered = publish();
+        published_num_.Add(1);
+        if (delivered == 0) {
+            unmatched_num_.Add(1);
+        } else {
+            delivered_num_.Add(delivered);
+        }
+        return delivered;
+    }
+
+    /**
+     * @brief 快照中的一个主题，没有订阅者时 subscribers 为空指针
+     */
+    struct SnapshotEntry {
+        const std::string* topic = nullptr;
+        std::shared_ptr<const SubscriberList> subscribers;
+    };
+
+    /**
+     * @brief 通配订阅前缀树的节点，每条边是模式中的一段
+     * 根到节点的路径就是一个订阅模式；节点只增不减，取消订阅后留下的空节点在之后的订阅中复用
+     */
+    struct PatternNode {
+        std::map<std::string, std::unique_ptr<PatternNode>, std::less<>> children;  // 普通段
+        std::unique_ptr<PatternNode> any_one;                                      // "*" 段
+        std::unique_ptr<PatternNode> any_many;                                     // "#" 段
+        const std::string* pattern = nullptr;  // 以该节点结尾的模式名称，指向 pattern_names_
+        SubscriberList subscribers;
+
+        std::unique_ptr<PatternNode> Clone() const {
+            auto node = std::make_unique<PatternNode>();
+            for (const auto& [segment, child] : children) {
+                node->children.emplace(segment, child->Clone());
+            }
+            if (any_one) {
+                node->any_one = any_one->Clone();
+            }
+            if (any_many) {
+                node->any_many = any_many->Clone();
+            }
+            node->pattern = pattern;
+            node->subscribers = subscribers;
+            return node;
+        }
+    };
+
+    /**
+     * @brief 反向索引中的一条订阅：pattern 为空时是 topic_id 对应的普通主题，否则是该通配节点
+     */
+    struct SubscriptionKey {
+        uint32_t topic_id;
+        PatternNode* pattern;
+
+        bool operator==(const SubscriptionKey& other) const {
+            return topic_id == other.topic_id && pattern == other.pattern;
+        }
+    };
+
+    /**
+     * @brief kReadMostly 模式下的订阅表快照：entries 按主题ID下标访问，topic_ids 供字符串接口查找ID，
+     * 只在注册新主题时重建，其余时候在新旧快照间共享；patterns 是通配前缀树的副本，没有通配订阅时为空指针，
+     * 通配订阅变化时整棵复制
+     */
+    struct Snapshot {
+        std::shared_ptr<const TopicIdMap> topic_ids;
+        std::vector<SnapshotEntry> entries;
+        std::shared_ptr<const PatternNode> patterns;
+    };
+
+    /**
+     * @brief 异步订阅者的有界多生产者队列
+     * 发布线程在锁内追加消息，队列从空变为非空时向 executor 提交一个投递任务；
+     * 投递任务一次取出最多 max_batch 条消息，按连续的相同主题分段交给回调，队列仍非空时再提交下一个任务，
+     * 因此同一时刻最多只有一个投递任务，回调不会并发执行。主题指针指向 PubSub 中注册的主题名称，
+     * 只被通配订阅匹配的未注册主题由队列自己保存一份名称
+     */
+    class AsyncQueue : public std::enable_shared_from_this<AsyncQueue> {
+       public:
+        using PostFunc = std::function<bool(std::function<void()>)>;
+
+        AsyncQueue(BatchCallback<T> callback, PostFunc post, AsyncSubscribeOptions options)
+            : callback_(std::move(callback)), post_(std::move(post)), options_(options) {
+            options_.queue_capacity = std::max<size_t>(options_.queue_capacity, 1);
+            options_.max_batch = std::max<size_t>(options_.max_batch, 1);
+        }
+
+        // transient 为 true 时 topic 只在本次调用期间有效，队列保存一份名称直到相应的消息离开队列
+        void Push(const std::string& topic, const T& message, bool transient = false) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (closed_) {
+                    return;
+                }
+                if (options_.policy == BackpressurePolicy::kConflateLatest) {
+                    const std::string* key = &topic;
+                    if (transient) {
+                        auto name = transient_names_.find(topic);
+                        key = name != transient_names_.end() ? &name->first : nullptr;
+                    }
+                    auto it = latest_.find(key);
+                    if (it != latest_.end()) {
+                        entries_[it->second - head_seq_].message = message;
+                        stats_.conflated++;
+                        return;
+                    }
+                }
+                if (entries_.size() >= options_.queue_capacity) {
+                    if (options_.policy == BackpressurePolicy::kBlock) {
+                        space_cv_.wait(lock, [this] { return closed_ || entries_.size() < options_.queue_capacity; });
+                        if (closed_) {
+                            return;
+                        }
+                    } else {
+                        PopFrontLocked(1);
+                        stats_.dropped++;
+                    }
+                }
+                const std::string* key = &topic;
+                if (transient) {
+                    auto name = transient_names_.try_emplace(topic, 0).first;
+                    ++name->second;
+                    key = &name->first;
+                }
+                entries_.push_back({key, message, transient});
+                if (options_.policy == BackpressurePolicy::kConflateLatest) {
+                    latest_[key] = head_seq_ + entries_.size() - 1;
+                }
+                stats_.enqueued++;
+                if (scheduled_) {
+                    return;
+                }
+                scheduled_ = true;
+            }
+            Schedule();
+        }
+
+        // 丢弃尚未投递的消息，之后的 Push 被忽略
+        void Close() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                closed_ = true;
+                PopFrontLocked(entries_.size());
+            }
+            space_cv_.notify_all();
+        }
+
+        void WaitIdle() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_cv_.wait(lock, [this] { return !scheduled_; });
+        }
+
+        // 等待正在执行的回调返回，Close 之后不会再开始新的批次；
+        // 与 WaitIdle 不同，不依赖 executor 执行已提交但尚未开始的投递任务
+        void WaitDelivered() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_cv_.wait(lock, [this] { return !delivering_; });
+        }
+
+        // 当前线程是否正在执行本队列的回调
+        bool IsDeliveringOnThisThread() const { return CurrentDelivering() == this; }
+
+        AsyncSubscriberStats GetStats() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            AsyncSubscriberStats stats = stats_;
+            stats.pending = entries_.size();
+            return stats;
+        }
+
+       private:
+        struct Entry {
+            const std::string* topic;
+            T message;
+            bool transient = false;  // topic 指向 transient_names_
+        };
+
+        // executor 不可用时（例如线程池已经关闭）直接在当前线程投递
+        void Schedule() {
+            auto self = this->shared_from_this();
+            if (!post_([self]() { self->Drain(); })) {
+                Drain();
+            }
+        }
+
+        void Drain() {
+            bool closed;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                size_t count = std::min(options_.max_batch, entries_.size());
+                batch_.clear();
+                for (size_t i = 0; i < count; ++i) {
+                    batch_.push_back(std::move(entries_[i]));
+                    entries_[i].transient = false;  // 名称随消息转入 batch_，投递后再释放
+                }
+                PopFrontLocked(count);
+                closed = closed_;
+                delivering_ = !closed;
+            }
+            space_cv_.notify_all();
+
+            if (!closed) {
+                // executor 不可用时 Drain 会在另一个队列的回调中执行，退出时恢复外层的值
+                const AsyncQueue* outer = CurrentDelivering();
+                CurrentDelivering() = this;
+                Deliver();
+                CurrentDelivering() = outer;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (const Entry& entry : batch_) {
+                    if (entry.transient) {
+                        ReleaseNameLocked(entry.topic);
+                    }
+                }
+                delivering_ = false;
+                stats_.delivered += closed ? 0 : batch_.size();
+                stats_.batches += closed || batch_.empty() ? 0 : 1;
+                if (entries_.empty() || closed_) {
+                    scheduled_ = false;
+                    idle_cv_.notify_all();
+                    return;
+                }
+            }
+            idle_cv_.notify_all();
+            Schedule();
+        }
+
+        // 按连续的相同主题分段回调，只由投递任务调用
+        void Deliver() {
+            size_t begin = 0;
+            while (begin < batch_.size()) {
+                const std::string* topic = batch_[begin].topic;
+                messages_.clear();
+                size_t end = begin;
+                while (end < batch_.size() && batch_[end].topic == topic) {
+                    messages_.push_back(std::move(batch_[end].message));
+                    ++end;
+                }
+                try {
+                    callback_(*topic, messages_.data(), messages_.size());
+                } catch (...) {
+                    // 忽略回调中的异常，继续投递后续消息
+                }
+                begin = end;
+            }
+        }
+
+        static const AsyncQueue*& CurrentDelivering() {
+            static thread_local const AsyncQueue* queue = nullptr;
+            return queue;
+        }
+
+        // 移除队头的 count 条消息，调用者需持有 mutex_
+        void PopFrontLocked(size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                if (options_.policy == BackpressurePolicy::kConflateLatest) {
+                    auto it = latest_.find(entries_.front().topic);
+                    if (it != latest_.end() && it->second == head_seq_) {
+                        latest_.erase(it);
+                    }
+                }
+                if (entries_.front().transient) {
+                    ReleaseNameLocked(entries_.front().topic);
+                }
+                entries_.pop_front();
+                ++head_seq_;
+            }
+        }
+
+        // 队列中已没有使用该名称的消息时删除，调用者需持有 mutex_
+        void ReleaseNameLocked(const std::string* topic) {
+            auto it = transient_names_.find(*topic);
+            if (it != transient_names_.end() && --it->second == 0) {
+                transient_names_.erase(it);
+            }
+        }
+
+        BatchCallback<T> callback_;
+        PostFunc post_;
+        AsyncSubscribeOptions options_;
+        mutable std::mutex mutex_;
+        std::condition_variable space_cv_;
+        std::condition_variable idle_cv_;
+        std::deque<Entry> entries_;
+        uint64_t head_seq_ = 0;                                  // entries_ 队头消息的序号
+        std::unordered_map<const std::string*, uint64_t> latest_;  // kConflateLatest：主题 -> 队列中该主题消息的序号
+        std::unordered_map<std::string, size_t> transient_names_;  // 未注册主题的名称 -> 引用它的消息数
+        bool scheduled_ = false;
+        bool delivering_ = false;  // 回调正在执行
+        bool closed_ = false;
+        AsyncSubscriberStats stats_;
+        std::vector<Entry> batch_;
+        std::vector<T> messages_;
+    };
+    using AsyncQueueList = std::vector<std::shared_ptr<AsyncQueue>>;
+
+    template <typename Executor>
+    static std::shared_ptr<AsyncQueue> MakeAsyncQueue(BatchCallback<T> callback, Executor& executor,
+                                                      const AsyncSubscribeOptions& options) {
+        auto post = [&executor](std::function<void()> task) { return executor.Post(std::move(task)); };
+        return std::make_shared<AsyncQueue>(std::move(callback), std::move(post), options);
+    }
+
+    static MessageCallback<T> QueueCallback(std::shared_ptr<AsyncQueue> queue) {
+        return [queue](const std::string& topic, const T& message) { queue->Push(topic, message); };
+    }
+
+    // 关闭并移除订阅者的队列，放入 closed，由调用者在锁外调用 WaitClosed
+    void CloseAsyncQueueLocked(SubscriberId subscriber_id, AsyncQueueList& closed) {
+        auto it = async_queues_.find(subscriber_id);
+        if (it != async_queues_.end()) {
+            CloseAsyncQueue(*it->second);
+            closed.push_back(std::move(it->second));
+            async_queues_.erase(it);
+        }
+    }
+
+    void CloseAsyncQueuesLocked(AsyncQueueList& closed) {
+        for (auto& [id, queue] : async_queues_) {
+            CloseAsyncQueue(*queue);
+            closed.push_back(std::move(queue));
+        }
+        async_queues_.clear();
+    }
+
+    // 等待已关闭队列中正在执行的回调返回，不能持有 mutex_（回调中可能再调用本对象）
+    static void WaitClosed(const AsyncQueueList& closed) {
+        for (const auto& queue : closed) {
+            if (!queue->IsDeliveringOnThisThread()) {
+                queue->WaitDelivered();
+            }
+        }
+    }
+
+    // 关闭队列并把其最终统计计入 closed_async_*，使 GetMetrics 的累计值不因取消订阅而减少，调用者需持有 mutex_
+    void CloseAsyncQueue(AsyncQueue& queue) {
+        queue.Close();
+        AsyncSubscriberStats stats = queue.GetStats();
+        closed_async_enqueued_.Add(stats.enqueued);
+        closed_async_delivered_.Add(stats.delivered);
+        closed_async_dropped_.Add(stats.dropped);
+        closed_async_conflated_.Add(stats.conflated);
+    }
+
+    TopicHandle FindLocked(const std::string& topic) const {
+        auto it = topic_ids_.find(topic);
+        return it != topic_ids_.end() ? TopicHandle{it->second} : TopicHandle{};
+    }
+
+    TopicHandle InternLocked(const std::string& topic) {
+        auto it = topic_ids_.find(topic);
+        if (it != topic_ids_.end()) {
+            return TopicHandle{it->second};
+        }
+        uint32_t id = static_cast<uint32_t>(topic_names_.size());
+        topic_names_.push_back(topic);
+        topic_ids_.emplace(topic, id);
+        subscribers_.emplace_back();
+        if (mode_ == PublishMode::kReadMostly) {
+            auto snapshot = std::make_shared<Snapshot>(*std::atomic_load(&snapshot_));
+            snapshot->topic_ids = std::make_shared<const TopicIdMap>(topic_ids_);
+            snapshot->entries.push_back({&topic_names_.back(), nullptr});
+            std::atomic_store(&snapshot_, std::shared_ptr<const Snapshot>(std::move(snapshot)));
+        }
+        return TopicHandle{id};
+    }
+
+    // 主题中有等于 "*" 或 "#" 的段时是通配模式，"a*" 这样的段仍按普通段匹配
+    static bool IsPattern(std::string_view topic) {
+        size_t pos = 0;
+        while (true) {
+            size_t end = std::min(topic.find('.', pos), topic.size());
+            std::string_view segment = topic.substr(pos, end - pos);
+            if (segment == "*" || segment == "#") {
+                return true;
+            }
+            if (end == topic.size()) {
+                return false;
+            }
+            pos = end + 1;
+        }
+    }
+
+    /**
+     * @brief 沿模式的各段查找前缀树节点，连续的 "#" 段等价于一个
+     * @return 找不到时返回空指针
+     */
+    template <typename Node>
+    static Node* FindPattern(Node& root, std::string_view pattern) {
+        Node* node = &root;
+        ForEachPatternSegment(pattern, [&node](std::string_view segment) {
+            if (node == nullptr) {
+                return;
+            }
+            if (segment == "#") {
+                node = node->any_many.get();
+            } else if (segment == "*") {
+                node = node->any_one.get();
+            } else {
+                auto it = node->children.find(segment);
+                node = it != node->children.end() ? it->second.get() : nullptr;
+            }
+        });
+        return node;
+    }
+
+    // 查找模式对应的节点，缺少的节点依次创建，调用者需持有 mutex_
+    PatternNode* InsertPatternLocked(std::string_view pattern) {
+        PatternNode* node = pattern_root_.get();
+        ForEachPatternSegment(pattern, [&node](std::string_view segment) {
+            std::unique_ptr<PatternNode>* child;
+            if (segment == "#") {
+                child = &node->any_many;
+            } else if (segment == "*") {
+                child = &node->any_one;
+            } else {
+                child = &node->children[std::string(segment)];
+            }
+            if (!*child) {
+                *child = std::make_unique<PatternNode>();
+            }
+            node = child->get();
+        });
+        return node;
+    }
+
+    // 按 '.' 依次处理模式的各段，跳过紧跟在 "#" 后面的 "#"
+    template <typename Func>
+    static void ForEachPatternSegment(std::string_view pattern, Func&& func) {
+        size_t pos = 0;
+        bool last_many = false;
+        while (true) {
+            size_t end = std::min(pattern.find('.', pos), pattern.size());
+            std::string_view segment = pattern.substr(pos, end - pos);
+            if (segment != "#" || !last_many) {
+                func(segment);
+            }
+            last_many = segment == "#";
+            if (end == pattern.size()) {
+                return;
+            }
+            pos = end + 1;
+        }
+    }
+
+    /**
+     * @brief 返回与 topic 匹配且有订阅者的模式节点，每个节点只出现一次，
+     * 查找时每一层最多访问普通段、"*" 和 "#" 三个分支
+     */
+    static std::vector<const PatternNode*> MatchPatterns(const PatternNode& root, std::string_view topic) {
+        std::vector<const PatternNode*> matches;
+        MatchSegments(root, topic, 0, matches);
+        return matches;
+    }
+
+    // pos 为 topic 中下一段的起始位置，大于 topic.size() 表示所有段都已匹配
+    static void MatchSegments(const PatternNode& node, std::string_view topic, size_t pos,
+                              std::vector<const PatternNode*>& matches) {
+        if (pos > topic.size()) {
+            if (!node.subscribers.empty() && std::find(matches.begin(), matches.end(), &node) == matches.end()) {
+                matches.push_back(&node);
+            }
+            if (node.any_many) {
+                MatchSegments(*node.any_many, topic, pos, matches);
+            }
+            return;
+        }
+        size_t end = std::min(topic.find('.', pos), topic.size());
+        auto it = node.children.find(topic.substr(pos, end - pos));
+        if (it != node.children.end()) {
+            MatchSegments(*it->second, topic, end + 1, matches);
+        }
+        if (node.any_one) {
+            MatchSegments(*node.any_one, topic, end + 1, matches);
+        }
+        if (node.any_many) {
+            // "#" 依次尝试吞掉 0 段、1 段……直到剩余的全部段
+            for (size_t next = pos; next <= topic.size(); next = std::min(topic.find('.', next), topic.size()) + 1) {
+                MatchSegments(*node.any_many, topic, next, matches);
+            }
+            MatchSegments(*node.any_many, topic, topic.size() + 1, matches);
+        }
+    }
+
+    // 按前缀树的遍历顺序返回有订阅者的模式节点
+    static std::vector<const PatternNode*> CollectPatterns(const PatternNode& root) {
+        std::vector<const PatternNode*> nodes;
+        CollectPatternNodes(root, nodes);
+        return nodes;
+    }
+
+    static void CollectPatternNodes(const PatternNode& node, std::vector<const PatternNode*>& nodes) {
+        if (!node.subscribers.empty()) {
+            nodes.push_back(&node);
+        }
+        for (const auto& [segment, child] : node.children) {
+            CollectPatternNodes(*child, nodes);
+        }
+        if (node.any_one) {
+            CollectPatternNodes(*node.any_one, nodes);
+        }
+        if (node.any_many) {
+            CollectPatternNodes(*node.any_many, nodes);
+        }
+    }
+
+    static void ClearPatterns(PatternNode& node) {
+        node.subscribers.clear();
+        for (auto& [segment, child] : node.children) {
+            ClearPatterns(*child);
+        }
+        if (node.any_one) {
+            ClearPatterns(*node.any_one);
+        }
+        if (node.any_many) {
+            ClearPatterns(*node.any_many);
+        }
+    }
+
+    size_t CountPatternSubscribersLocked(std::string_view topic) const {
+        size_t count = 0;
+        if (pattern_subscriber_count_ > 0) {
+            for (const PatternNode* node : MatchPatterns(*pattern_root_, topic)) {
+                count += node->subscribers.size();
+            }
+        }
+        return count;
+    }
+
+    SubscriberId SubscribeTopicLocked(const std::string& topic, MessageCallback<T> callback) {
+        if (IsPattern(topic)) {
+            return SubscribePatternLocked(topic, std::move(callback));
+        }
+        return SubscribeLocked(InternLocked(topic), std::move(callback));
+    }
+
+    SubscriberId SubscribeLocked(TopicHandle handle, MessageCallback<T> callback) {
+        SubscriberId id = next_subscriber_id_++;
+        auto subscriber = std::make_shared<Subscriber<T>>(id, topic_names_[handle.id], std::move(callback));
+        subscribers_[handle.id].push_back(subscriber);
+        subscriptions_[id].push_back({handle.id, nullptr});
+        RefreshSnapshotLocked(&handle);
+        return id;
+    }
+
+    SubscriberId SubscribePatternLocked(const std::string& pattern, MessageCallback<T> callback) {
+        PatternNode* node = InsertPatternLocked(pattern);
+        if (node->pattern == nullptr) {
+            pattern_names_.push_back(pattern);
+            node->pattern = &pattern_names_.back();
+        }
+        SubscriberId id = next_subscriber_id_++;
+        node->subscribers.push_back(std::make_shared<Subscriber<T>>(id, *node->pattern, std::move(callback)));
+        subscriptions_[id].push_back({TopicHandle::kInvalidId, node});
+        pattern_subscriber_count_++;
+        RefreshPatternSnapshotLocked();
+        return id;
+    }
+
+    // 从 key 对应的订阅表和反向索引中移除订阅者
+    bool UnsubscribeLocked(const SubscriptionKey& key, SubscriberId subscriber_id, AsyncQueueList& closed) {
+        auto it = subscriptions_.find(subscriber_id);
+        if (it == subscriptions_.end()) {
+            return false;
+        }
+        std::vector<SubscriptionKey>& keys = it->second;
+        auto key_it = std::find(keys.begin(), keys.end(), key);
+        if (key_it == keys.end()) {
+            return false;
+        }
+        keys.erase(key_it);
+        if (keys.empty()) {
+            subscriptions_.erase(it);
+        }
+
+        SubscriberList& subscribers = key.pattern != nullptr ? key.pattern->subscribers : subscribers_[key.topic_id];
+        subscribers.erase(std::find_if(subscribers.begin(), subscribers.end(),
+                                       [subscriber_id](const auto& subscriber) { return subscriber->id == subscriber_id; }));
+        CloseAsyncQueueLocked(subscriber_id, closed);
+        if (key.pattern != nullptr) {
+            pattern_subscriber_count_--;
+            RefreshPatternSnapshotLocked();
+        } else {
+            TopicHandle handle{key.topic_id};
+            RefreshSnapshotLocked(&handle);
+        }
+        return true;
+    }
+
+    // 复制订阅者列表（包括匹配的通配订阅者），避免在回调时持有锁；返回的主题名称在 PubSub 生命周期内有效
+    const std::string* CopySubscribersLocked(TopicHandle handle,
+                                             std::pmr::vector<std::shared_ptr<Subscriber<T>>>& subscribers_copy) {
+        const SubscriberList& subscribers = subscribers_[handle.id];
+        subscribers_copy.assign(subscribers.begin(), subscribers.end());
+        if (pattern_subscriber_count_ > 0) {
+            for (const PatternNode* node : MatchPatterns(*pattern_root_, topic_names_[handle.id])) {
+                subscribers_copy.insert(subscribers_copy.end(), node->subscribers.begin(), node->subscribers.end());
+            }
+        }
+        return &topic_names_[handle.id];
+    }
+
+    size_t PublishCopy(const std::string& topic, const std::pmr::vector<std::shared_ptr<Subscriber<T>>>& subscribers,
+                       const T& message) {
+        // 在锁外执行回调
+        Deliver(topic, subscribers, message);
+        return subscribers.size();
+    }
+
+    /**
+     * @brief 未注册主题的一个通配订阅者；异步订阅者的 queue 非空，需要让队列自己保存主题名称
+     */
+    struct PatternTarget {
+        std::shared_ptr<Subscriber<T>> subscriber;
+        std::shared_ptr<AsyncQueue> queue;
+    };
+
+    // 复制匹配 topic 的通配订阅者及其异步队列，调用者需持有 mutex_
+    void CopyPatternTargetsLocked(const std::string& topic, std::vector<PatternTarget>& targets) const {
+        if (pattern_subscriber_count_ == 0) {
+            return;
+        }
+        for (const PatternNode* node : MatchPatterns(*pattern_root_, topic)) {
+            for (const auto& subscriber : node->subscribers) {
+                auto it = async_queues_.find(subscriber->id);
+                targets.push_back({subscriber, it != async_queues_.end() ? it->second : nullptr});
+            }
+        }
+    }
+
+    /**
+     * @brief 发布到只被通配订阅匹配的主题；这样的主题不注册，避免任意主题名使订阅表和快照无限增长，
+     * 异步订阅者的队列复制主题名称，消息离开队列后释放
+     */
+    static size_t PublishUnregistered(const std::string& topic, const std::vector<PatternTarget>& targets,
+                                      const T& message) {
+        for (const PatternTarget& target : targets) {
+            try {
+                if (target.queue) {
+                    target.queue->Push(topic, message, true);
+                } else {
+                    target.subscriber->callback(topic, message);
+                }
+            } catch (...) {
+                // 忽略回调中的异常，避免影响其他订阅者
+            }
+        }
+        return targets.size();
+    }
+
+    // 持有快照期间订阅表的修改不会影响本次发布
+    static size_t PublishSnapshot(const Snapshot& snapshot, uint32_t id, const T& message) {
+        if (id >= snapshot.entries.size()) {
+            return 0;
+        }
+        const SnapshotEntry& entry = snapshot.entries[id];
+        size_t count = 0;
+        if (entry.subscribers) {
+            Deliver(*entry.topic, *entry.subscribers, message);
+            count += entry.subscribers->size();
+        }
+        if (snapshot.patterns) {
+            for (const PatternNode* node : MatchPatterns(*snapshot.patterns, *entry.topic)) {
+                Deliver(*entry.topic, node->subscribers, message);
+                count += node->subscribers.size();
+            }
+        }
+        return count;
+    }
+
+    // 依次调用订阅者回调，返回回调成功的订阅者数量
+    template <typename List>
+    static size_t Deliver(const std::string& topic, const List& subscribers, const T& message) {
+        size_t count = 0;
+        for (const auto& subscriber : subscribers) {
+            try {
+                subscriber->callback(topic, message);
+                count++;
+            } catch (...) {
+                // 忽略回调中的异常，避免影响其他订阅者
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @brief kReadMostly 模式下根据 subscribers_ 生成新快照并原子替换，调用者需持有 mutex_
+     * handle 非空时只重建该主题的列表，其余主题共享旧快照中的列表；为空时重建全部
+     */
+    void RefreshSnapshotLocked(const TopicHandle* handle) {
+        if (mode_ != PublishMode::kReadMostly) {
+            return;
+        }
+        auto snapshot = std::make_shared<Snapshot>(*std::atomic_load(&snapshot_));
+        auto rebuild = [this, &snapshot](uint32_t id) {
+            const SubscriberList& subscribers = subscribers_[id];
+            snapshot->entries[id].subscribers =
+                subscribers.empty() ? nullptr : std::make_shared<const SubscriberList>(subscribers);
+        };
+        if (handle != nullptr) {
+            rebuild(handle->id);
+        } else {
+            for (uint32_t id = 0; id < subscribers_.size(); ++id) {
+                rebuild(id);
+            }
+            snapshot->patterns = ClonePatternsLocked();
+        }
+        std::atomic_store(&snapshot_, std::shared_ptr<const Snapshot>(std::move(snapshot)));
+    }
+
+    // kReadMostly 模式下用通配前缀树的新副本替换快照，调用者需持有 mutex_
+    void RefreshPatternSnapshotLocked() {
+        if (mode_ != PublishMode::kReadMostly) {
+            return;
+        }
+        auto snapshot = std::make_shared<Snapshot>(*std::atomic_load(&snapshot_));
+        snapshot->patterns = ClonePatternsLocked();
+        std::atomic_store(&snapshot_, std::shared_ptr<const Snapshot>(std::move(snapshot)));
+    }
+
+    std::shared_ptr<const PatternNode> ClonePatternsLocked() const {
+        if (pattern_subscriber_count_ == 0) {
+            return nullptr;
+        }
+        return pattern_root_->Clone();
+    }
+
     mutable std::mutex mutex_;
-    std::unordered_map<std::string, std::vector<std::shared_ptr<Subscriber<T>>>> subscribers_;
+    std::deque<std::string> topic_names_;      // 主题ID -> 名称，只增不减，元素地址保持不变
+    TopicIdMap topic_ids_;                     // 名称 -> 主题ID
+    std::vector<SubscriberList> subscribers_;  // 按主题ID下标访问
+    std::unique_ptr<PatternNode> pattern_root_;  // 通配订阅前缀树
+    std::deque<std::string> pattern_names_;      // 通配模式名称，只增不减，元素地址保持不变
+    size_t pattern_subscriber_count_ = 0;
+    std::unordered_map<SubscriberId, std::vector<SubscriptionKey>> subscriptions_;  // 订阅者ID -> 其订阅
     SubscriberId next_subscriber_id_;
+    std::pmr::memory_resource* resource_;
+    PublishMode mode_;
+    std::unordered_map<SubscriberId, std::shared_ptr<AsyncQueue>> async_queues_;
+    std::shared_ptr<const Snapshot> snapshot_;  // 只通过 std::atomic_load/atomic_store 访问
+    cMetrics::Counter published_num_;
+    cMetrics::Counter delivered_num_;
+    cMetrics::Counter unmatched_num_;
+    cMetrics::Counter closed_async_enqueued_;  // 已关闭的异步队列的累计统计
+    cMetrics::Counter closed_async_delivered_;
+    cMetrics::Counter closed_async_dropped_;
+    cMetrics::Counter closed_async_conflated_;
+    cMetrics::Histogram publish_ns_;
+    // 放在最后，最先析构，注销之后不会再有采集函数访问其他成员
+    cMetrics::Registration metrics_registration_;
 };
 
 }  // namespace cPubSub
 
 #endif  // __PUB_SUB__
-
@@ -0,0 +1,348 @@
+#ifndef __SLAB_OBJECT_POOL__
+#define __SLAB_OBJECT_POOL__
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace cObjectPool {
+
+/**
+ * @brief 基于连续 slab 的对象池
+ *
+ * 对象按 slab_size 个一组连续分配并在创建 slab 时默认构造，之后只做复用不再析构；
+ * 空闲槽位通过侵入式链表管理。每个线程持有自己的空闲槽位缓存，Acquire/Release 在缓存命中时不分配内存，
+ * 缓存为空或超过 cache_size 时与全局空闲链表之间一次转移 cache_size / 2 个槽位。
+ * 不限制 slab 数量时缓存命中不加锁；设置了 max_slabs 时每次访问缓存都获取该缓存自己的（无竞争的）锁，
+ * 达到上限且全局链表为空时先收回所有线程缓存中的空闲槽位，只有确实没有空闲对象时 Acquire 才失败。
+ * 返回只能移动的 Handle，析构时自动归还，不需要 shared_ptr 的控制块
+ * @tparam T 对象类型，需要可默认构造
+ */
+template <typename T>
+class SlabObjectPool {
+    struct Slot;
+
+   public:
+    using ResetFunc = std::function<void(T*)>;
+
+    /**
+     * @brief 独占一个池对象的句柄，只能移动，析构或调用 Release 时把对象归还到池中
+     * 句柄不能比创建它的池活得更久
+     */
+    class Handle {
+       public:
+        Handle() = default;
+
+        Handle(Handle&& other) noexcept : pool_(other.pool_), slot_(other.slot_) {
+            other.pool_ = nullptr;
+            other.slot_ = nullptr;
+        }
+
+        Handle& operator=(Handle&& other) noexcept {
+            if (this != &other) {
+                Release();
+                pool_ = other.pool_;
+                slot_ = other.slot_;
+                other.pool_ = nullptr;
+                other.slot_ = nullptr;
+            }
+            return *this;
+        }
+
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+
+        ~Handle() { Release(); }
+
+        T* get() const { return slot_ != nullptr ? &slot_->object : nullptr; }
+        T* operator->() const { return &slot_->object; }
+        T& operator*() const { return slot_->object; }
+        explicit operator bool() const { return slot_ != nullptr; }
+
+        /**
+         * @brief 提前归还对象，之后句柄为空
+         */
+        void Release() {
+            if (slot_ != nullptr) {
+                pool_->Release(slot_);
+                slot_ = nullptr;
+                pool_ = nullptr;
+            }
+        }
+
+       private:
+        friend class SlabObjectPool;
+
+        Handle(SlabObjectPool* pool, Slot* slot) : pool_(pool), slot_(slot) {}
+
+        SlabObjectPool* pool_ = nullptr;
+        Slot* slot_ = nullptr;
+    };
+
+    /**
+     * @brief 构造函数
+     * @param reset 对象重置函数（可选），归还时调用
+     * @param slab_size 每个 slab 包含的对象数量
+     * @param max_slabs 最多分配的 slab 数量（0表示无限制）
+     * @param cache_size 每个线程缓存的最大空闲对象数量
+     */
+    explicit SlabObjectPool(ResetFunc reset = nullptr, size_t slab_size = 64, size_t max_slabs = 0,
+                            size_t cache_size = 32)
+        : id_(NextPoolId()),
+          shared_(std::make_shared<Shared>()),
+          reset_(std::move(reset)),
+          slab_size_(std::max<size_t>(slab_size, 1)),
+          max_slabs_(max_slabs),
+          cache_size_(std::max<size_t>(cache_size, 2)) {}
+
+    SlabObjectPool(const SlabObjectPool&) = delete;
+    SlabObjectPool& operator=(const SlabObjectPool&) = delete;
+
+    /**
+     * @brief 其他线程缓存中的槽位在这些线程退出，或这些线程之后为其他池创建缓存时释放，
+     * 所有缓存都释放后 slab 内存随之回收
+     */
+    ~SlabObjectPool() { shared_->closed.store(true, std::memory_order_release); }
+
+    /**
+     * @brief 从池中获取对象
+     * @return 对象句柄，达到 max_slabs 且没有空闲对象时返回空句柄
+     */
+    Handle Acquire() {
+        LocalCache* cache = GetLocalCache();
+        Slot* slot = PopCached(cache);
+        if (slot == nullptr) {
+            slot = Refill(cache);
+            if (slot == nullptr) {
+                return Handle();
+            }
+        }
+        return Handle(this, slot);
+    }
+
+    /**
+     * @brief 获取已分配的对象总数（所有 slab 的容量之和）
+     */
+    size_t GetTotalCount() const {
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        return shared_->slabs.size() * slab_size_;
+    }
+
+    /**
+     * @brief 获取全局空闲链表中的对象数量，不包括各线程缓存中的对象
+     */
+    size_t GetGlobalAvailableCount() const {
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        return shared_->free_count;
+    }
+
+   private:
+    struct Slot {
+        T object;
+        Slot* next = nullptr;
+    };
+
+    struct LocalCache;
+
+    /**
+     * @brief 池的共享状态，由池和各线程缓存共同持有，保证池析构后线程缓存归还槽位仍然安全
+     */
+    struct Shared {
+        mutable std::mutex mutex;
+        std::vector<std::unique_ptr<Slot[]>> slabs;
+        Slot* free_head = nullptr;
+        size_t free_count = 0;
+        std::vector<LocalCache*> caches;  // 所有线程的缓存，达到 max_slabs 时从中收回空闲槽位
+        std::atomic<bool> closed{false};
+
+        // 把 [head, tail] 共 count 个槽位放回全局空闲链表，调用者需持有 mutex
+        void PushList(Slot* head, Slot* tail, size_t count) {
+            tail->next = free_head;
+            free_head = head;
+            free_count += count;
+        }
+    };
+
+    /**
+     * @brief 单个线程对单个池的空闲槽位缓存
+     * mutex 只在设置了 max_slabs 的池中使用；与 Shared::mutex 同时持有时总是先获取 Shared::mutex
+     */
+    struct LocalCache {
+        uint64_t pool_id;
+        std::shared_ptr<Shared> shared;
+        std::mutex mutex;
+        Slot* head = nullptr;
+        size_t count = 0;
+
+        LocalCache(uint64_t pool_id, std::shared_ptr<Shared> shared) : pool_id(pool_id), shared(std::move(shared)) {
+            std::lock_guard<std::mutex> lock(this->shared->mutex);
+            this->shared->caches.push_back(this);
+        }
+
+        // 线程退出时注销缓存，并把缓存的槽位全部还给全局空闲链表；持有 Shared::mutex 时不会被其他线程收回
+        ~LocalCache() {
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            shared->caches.erase(std::find(shared->caches.begin(), shared->caches.end(), this));
+            if (head == nullptr) {
+                return;
+            }
+            Slot* tail = head;
+            while (tail->next != nullptr) {
+                tail = tail->next;
+            }
+            shared->PushList(head, tail, count);
+        }
+    };
+
+    /**
+     * @brief 一个线程持有的所有池的缓存，last 记住最近一次使用的缓存
+     */
+    struct ThreadCaches {
+        std::vector<std::unique_ptr<LocalCache>> caches;
+        LocalCache* last = nullptr;
+    };
+
+    static uint64_t NextPoolId() {
+        static std::atomic<uint64_t> next_id{1};
+        return next_id.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    LocalCache* GetLocalCache() {
+        static thread_local ThreadCaches tls;
+        if (tls.last != nullptr && tls.last->pool_id == id_) {
+            return tls.last;
+        }
+        for (auto& cache : tls.caches) {
+            if (cache->pool_id == id_) {
+                tls.last = cache.get();
+                return tls.last;
+            }
+        }
+        // 顺便释放已经析构的池的缓存
+        tls.caches.erase(std::remove_if(tls.caches.begin(), tls.caches.end(),
+                                        [](const std::unique_ptr<LocalCache>& cache) {
+                                            return cache->shared->closed.load(std::memory_order_acquire);
+                                        }),
+                         tls.caches.end());
+        tls.caches.push_back(std::make_unique<LocalCache>(id_, shared_));
+        tls.last = tls.caches.back().get();
+        return tls.last;
+    }
+
+    // 设置了 max_slabs 时锁住缓存，使 Refill 可以收回其中的槽位；否则返回空锁
+    std::unique_lock<std::mutex> LockCache(LocalCache* cache) {
+        return max_slabs_ != 0 ? std::unique_lock<std::mutex>(cache->mutex) : std::unique_lock<std::mutex>();
+    }
+
+    Slot* PopCached(LocalCache* cache) {
+        std::unique_lock<std::mutex> lock = LockCache(cache);
+        Slot* slot = cache->head;
+        if (slot != nullptr) {
+            cache->head = slot->next;
+            --cache->count;
+        }
+        return slot;
+    }
+
+    // 从全局空闲链表取一个槽位返回，再批量取一些放入线程缓存；全局链表为空时分配新的 slab，
+    // 达到 max_slabs 时先收回各线程缓存中的空闲槽位，仍然没有时返回 nullptr
+    Slot* Refill(LocalCache* cache) {
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        if (shared_->free_head == nullptr) {
+            if (max_slabs_ != 0 && shared_->slabs.size() >= max_slabs_) {
+                ReclaimCachesLocked();
+                if (shared_->free_head == nullptr) {
+                    return nullptr;
+                }
+            } else {
+                std::unique_ptr<Slot[]> slab(new Slot[slab_size_]);
+                for (size_t i = 0; i + 1 < slab_size_; ++i) {
+                    slab[i].next = &slab[i + 1];
+                }
+                shared_->PushList(&slab[0], &slab[slab_size_ - 1], slab_size_);
+                shared_->slabs.push_back(std::move(slab));
+            }
+        }
+        Slot* result = PopGlobalLocked();
+        std::unique_lock<std::mutex> cache_lock = LockCache(cache);
+        for (size_t batch = cache_size_ / 2; batch > 1 && shared_->free_head != nullptr; --batch) {
+            Slot* slot = PopGlobalLocked();
+            slot->next = cache->head;
+            cache->head = slot;
+            ++cache->count;
+        }
+        return result;
+    }
+
+    // 调用者需持有 shared_->mutex 且全局链表非空
+    Slot* PopGlobalLocked() {
+        Slot* slot = shared_->free_head;
+        shared_->free_head = slot->next;
+        --shared_->free_count;
+        return slot;
+    }
+
+    // 把所有线程缓存中的空闲槽位移回全局链表，只在设置了 max_slabs 时调用，调用者需持有 shared_->mutex
+    void ReclaimCachesLocked() {
+        for (LocalCache* other : shared_->caches) {
+            std::lock_guard<std::mutex> cache_lock(other->mutex);
+            if (other->head == nullptr) {
+                continue;
+            }
+            Slot* tail = other->head;
+            while (tail->next != nullptr) {
+                tail = tail->next;
+            }
+            shared_->PushList(other->head, tail, other->count);
+            other->head = nullptr;
+            other->count = 0;
+        }
+    }
+
+    void Release(Slot* slot) {
+        // 重置对象状态
+        if (reset_) {
+            reset_(&slot->object);
+        }
+
+        LocalCache* cache = GetLocalCache();
+        Slot* head;
+        Slot* tail;
+        size_t batch = cache_size_ / 2;
+        {
+            std::unique_lock<std::mutex> cache_lock = LockCache(cache);
+            slot->next = cache->head;
+            cache->head = slot;
+            if (++cache->count <= cache_size_) {
+                return;
+            }
+
+            // 缓存过多时把一半归还给全局空闲链表，先从缓存中摘下，释放缓存锁后再获取全局锁
+            head = cache->head;
+            tail = head;
+            for (size_t i = 1; i < batch; ++i) {
+                tail = tail->next;
+            }
+            cache->head = tail->next;
+            cache->count -= batch;
+        }
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        shared_->PushList(head, tail, batch);
+    }
+
+    const uint64_t id_;
+    std::shared_ptr<Shared> shared_;
+    ResetFunc reset_;
+    size_t slab_size_;
+    size_t max_slabs_;
+    size_t cache_size_;
+};
+
+}  // namespace cObjectPool
+
+#endif  // __SLAB_OBJECT_POOL__
@@ -1,10 +1,18 @@
 #ifndef __STATE_MACHINE__
 #define __STATE_MACHINE__
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <initializer_list>
 #include <map>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace cStateMachine {
 
@@ -32,11 +40,14 @@ class StateMachine {
     using TransitionFunc = std::function<bool(const Context&)>;
 
     /**
-     * @brief 添加状态
+     * @brief 添加状态，同名状态会被替换；替换的是当前状态时，之后的更新和转换作用于新对象
      */
     void AddState(std::shared_ptr<State<Context>> state) {
         if (state) {
-            states_[state->GetName()] = state;
+            if (current_ != nullptr && state->GetName() == current_state_) {
+                current_ = state.get();
+            }
+            states_[state->GetName()] = std::move(state);
         }
     }
 
@@ -64,9 +75,11 @@ class StateMachine {
      * @brief 启动状态机
      */
     void Start(Context& context) {
-        if (!initial_state_.empty() && states_.find(initial_state_) != states_.end()) {
+        auto it = initial_state_.empty() ? states_.end() : states_.find(initial_state_);
+        if (it != states_.end()) {
             current_state_ = initial_state_;
-            states_[current_state_]->Enter(context);
+            current_ = it->second.get();
+            current_->Enter(context);
         }
     }
 
@@ -74,47 +87,300 @@ class StateMachine {
      * @brief 转换到指定状态
      */
     bool TransitionTo(const std::string& state_name, Context& context) {
-        if (current_state_.empty()) {
+        if (current_ == nullptr) {
             return false;
         }
 
-        auto it = transitions_[current_state_].find(state_name);
-        if (it != transitions_[current_state_].end()) {
-            // 检查转换条件
-            if (it->second && !it->second(context)) {
-                return false;
-            }
+        auto from = transitions_.find(current_state_);
+        if (from == transitions_.end()) {
+            return false;
+        }
+        auto it = from->second.find(state_name);
+        auto target = states_.find(state_name);
+        if (it == from->second.end() || target == states_.end()) {
+            return false;
+        }
 
-            // 执行状态转换
-            states_[current_state_]->Exit(context);
-            current_state_ = state_name;
-            states_[current_state_]->Enter(context);
-            return true;
+        // 检查转换条件
+        if (it->second && !it->second(context)) {
+            return false;
         }
-        return false;
+
+        // 执行状态转换
+        current_->Exit(context);
+        current_state_ = state_name;
+        current_ = target->second.get();
+        current_->Enter(context);
+        return true;
     }
 
     /**
      * @brief 更新当前状态
      */
     void Update(Context& context) {
-        if (!current_state_.empty()) {
-            states_[current_state_]->Update(context);
+        if (current_ != nullptr) {
+            current_->Update(context);
         }
     }
 
     /**
      * @brief 获取当前状态名
      */
-    std::string GetCurrentState() const { return current_state_; }
+    const std::string& GetCurrentState() const { return current_state_; }
 
    private:
     std::map<std::string, std::shared_ptr<State<Context>>> states_;
     std::map<std::string, std::map<std::string, TransitionFunc>> transitions_;
     std::string current_state_;
+    State<Context>* current_ = nullptr;  // 当前状态对象，避免每次转换和更新都按名字查找
     std::string initial_state_;
 };
 
+/**
+ * @brief 状态和事件都是稠密编号（0 到 count-1 的整数或枚举）的状态机定义
+ * 转换表是按 [状态][事件] 排列的一维数组，一次转换只做一次下标访问；进入、退出、更新和转换动作都是函数指针。
+ * 定义构造完成后不再修改，可以被任意多个 FlatStateMachine 共享，每个实例只保存定义的指针和当前状态
+ * @tparam Context 上下文类型
+ * @tparam StateId 状态编号类型
+ * @tparam EventId 事件编号类型
+ */
+template <typename Context, typename StateId = uint16_t, typename EventId = uint16_t>
+class FlatStateTable {
+   public:
+    using Guard = bool (*)(const Context&);
+    using Action = void (*)(Context&);
+
+    struct StateInfo {
+        std::string name;
+        Action enter = nullptr;
+        Action exit = nullptr;
+        Action update = nullptr;
+    };
+
+    struct Transition {
+        StateId to{};
+        bool valid = false;
+        Guard guard = nullptr;    // 返回 false 时不转换
+        Action action = nullptr;  // 在退出源状态之后、进入目标状态之前执行
+    };
+
+    FlatStateTable(size_t state_count, size_t event_count)
+        : event_count_(event_count), states_(state_count), transitions_(state_count * event_count) {}
+
+    /**
+     * @brief 设置状态的名字和回调
+     * @throws std::out_of_range 状态编号超出范围
+     */
+    FlatStateTable& SetState(StateId state, std::string name, Action enter = nullptr, Action exit = nullptr,
+                             Action update = nullptr) {
+        StateInfo& info = states_.at(static_cast<size_t>(state));
+        info.name = std::move(name);
+        info.enter = enter;
+        info.exit = exit;
+        info.update = update;
+        return *this;
+    }
+
+    /**
+     * @brief 添加转换：在 from 状态收到 event 时转换到 to，同一对 (from, event) 重复添加时覆盖
+     * @throws std::out_of_range 状态或事件编号超出范围
+     */
+    FlatStateTable& AddTransition(StateId from, EventId event, StateId to, Guard guard = nullptr,
+                                  Action action = nullptr) {
+        if (static_cast<size_t>(to) >= states_.size() || static_cast<size_t>(event) >= event_count_) {
+            throw std::out_of_range("FlatStateTable transition out of range");
+        }
+        transitions_.at(Index(from, event)) = Transition{to, true, guard, action};
+        return *this;
+    }
+
+    /**
+     * @brief 设置初始状态，默认为 0 号状态
+     * @throws std::out_of_range 状态编号超出范围
+     */
+    FlatStateTable& SetInitialState(StateId state) {
+        if (static_cast<size_t>(state) >= states_.size()) {
+            throw std::out_of_range("FlatStateTable initial state out of range");
+        }
+        initial_state_ = state;
+        return *this;
+    }
+
+    StateId GetInitialState() const { return initial_state_; }
+    size_t GetStateCount() const { return states_.size(); }
+    size_t GetEventCount() const { return event_count_; }
+
+    const StateInfo& GetState(StateId state) const { return states_[static_cast<size_t>(state)]; }
+
+    /**
+     * @brief 查找转换，事件编号超出范围时返回 nullptr
+     */
+    const Transition* Find(StateId from, EventId event) const {
+        if (static_cast<size_t>(event) >= event_count_) {
+            return nullptr;
+        }
+        const Transition& transition = transitions_[Index(from, event)];
+        return transition.valid ? &transition : nullptr;
+    }
+
+   private:
+    size_t Index(StateId state, EventId event) const {
+        return static_cast<size_t>(state) * event_count_ + static_cast<size_t>(event);
+    }
+
+    size_t event_count_;
+    std::vector<StateInfo> states_;
+    std::vector<Transition> transitions_;
+    StateId initial_state_{};
+};
+
+/**
+ * @brief 基于 FlatStateTable 的状态机实例
+ * 只保存定义的指针和当前状态编号（默认 16 字节），适合每个连接一个实例；
+ * 定义需要比所有实例活得更久，通常是静态对象或由 std::shared_ptr<const FlatStateTable> 统一持有
+ */
+template <typename Context, typename StateId = uint16_t, typename EventId = uint16_t>
+class FlatStateMachine {
+   public:
+    using Table = FlatStateTable<Context, StateId, EventId>;
+
+    explicit FlatStateMachine(const Table& table) : table_(&table), current_state_(table.GetInitialState()) {}
+
+    /**
+     * @brief 进入初始状态
+     */
+    void Start(Context& context) {
+        current_state_ = table_->GetInitialState();
+        Call(table_->GetState(current_state_).enter, context);
+    }
+
+    /**
+     * @brief 处理事件
+     * @return 当前状态没有该事件的转换或转换条件不满足时返回 false
+     */
+    bool Fire(EventId event, Context& context) {
+        const typename Table::Transition* transition = table_->Find(current_state_, event);
+        if (transition == nullptr || (transition->guard != nullptr && !transition->guard(context))) {
+            return false;
+        }
+        Call(table_->GetState(current_state_).exit, context);
+        Call(transition->action, context);
+        current_state_ = transition->to;
+        Call(table_->GetState(current_state_).enter, context);
+        return true;
+    }
+
+    /**
+     * @brief 更新当前状态
+     */
+    void Update(Context& context) { Call(table_->GetState(current_state_).update, context); }
+
+    StateId GetCurrentState() const { return current_state_; }
+
+    const std::string& GetCurrentStateName() const { return table_->GetState(current_state_).name; }
+
+   private:
+    static void Call(typename Table::Action action, Context& context) {
+        if (action != nullptr) {
+            action(context);
+        }
+    }
+
+    const Table* table_;
+    StateId current_state_;
+};
+
+/**
+ * @brief 编译期转换表
+ * 用 constexpr 变量定义，例如：
+ *   constexpr StaticTransitionTable<State, Event, 3, 2> kTable{{State::kIdle, Event::kStart, State::kRunning}, ...};
+ * 非法的编号在编译期报错
+ * @tparam kStateCount 状态数，编号 kStateCount 保留为 kNone
+ * @tparam kEventCount 事件数
+ */
+template <typename State, typename Event, size_t kStateCount, size_t kEventCount>
+class StaticTransitionTable {
+   public:
+    using StateId = State;
+    using EventId = Event;
+
+    struct Entry {
+        State from;
+        Event event;
+        State to;
+    };
+
+    // 没有转换时 Next 的返回值
+    static constexpr State kNone = static_cast<State>(kStateCount);
+
+    constexpr StaticTransitionTable(std::initializer_list<Entry> entries) : next_() {
+        for (size_t i = 0; i < next_.size(); ++i) {
+            next_[i] = kNone;
+        }
+        for (const Entry& entry : entries) {
+            if (static_cast<size_t>(entry.from) >= kStateCount || static_cast<size_t>(entry.to) >= kStateCount ||
+                static_cast<size_t>(entry.event) >= kEventCount) {
+                throw std::out_of_range("StaticTransitionTable entry out of range");
+            }
+            next_[static_cast<size_t>(entry.from) * kEventCount + static_cast<size_t>(entry.event)] = entry.to;
+        }
+    }
+
+    /**
+     * @brief 在 from 状态收到 event 后的状态，没有转换时返回 kNone
+     */
+    constexpr State Next(State from, Event event) const {
+        return static_cast<size_t>(event) < kEventCount
+                   ? next_[static_cast<size_t>(from) * kEventCount + static_cast<size_t>(event)]
+                   : kNone;
+    }
+
+   private:
+    std::array<State, kStateCount * kEventCount> next_;
+};
+
+/**
+ * @brief 使用编译期转换表的状态机，实例中只有当前状态，转换表作为模板参数，事件为常量时转换可以在编译期完成
+ * @tparam kTable 具有静态存储期的 constexpr StaticTransitionTable
+ */
+template <const auto& kTable>
+class StaticStateMachine {
+   public:
+    using TableType = std::decay_t<decltype(kTable)>;
+    using StateId = typename TableType::StateId;
+    using EventId = typename TableType::EventId;
+
+    constexpr explicit StaticStateMachine(StateId initial) : current_state_(initial) {}
+
+    /**
+     * @brief 处理事件
+     * @return 当前状态没有该事件的转换时返回 false
+     */
+    constexpr bool Fire(EventId event) {
+        return Fire(event, [](StateId, StateId) {});
+    }
+
+    /**
+     * @brief 处理事件，转换成功后调用 on_transition(from, to)，可以在其中执行进入/退出动作
+     */
+    template <typename F>
+    constexpr bool Fire(EventId event, F&& on_transition) {
+        StateId next = kTable.Next(current_state_, event);
+        if (next == TableType::kNone) {
+            return false;
+        }
+        StateId from = current_state_;
+        current_state_ = next;
+        on_transition(from, next);
+        return true;
+    }
+
+    constexpr StateId GetCurrentState() const { return current_state_; }
+
+   private:
+    StateId current_state_;
+};
+
 }  // namespace cStateMachine
 
 #endif  // __STATE_MACHINE__
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <thread>
 #include "async_callback.h"
+#include "thread_pool.h"
 
 using namespace cAsync;
 using std::cout;
@@ -66,6 +67,61 @@ void TestAsyncCallbackException() {
     }
 }
 
+void TestMultiWorker() {
+    cout << "\n========== 测试4: 多工作线程与共享线程池 ==========" << endl;
+
+    const int task_count = 100000;
+    auto run = [task_count](AsyncCallback& async) {
+        std::atomic<long> sum(0);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < task_count; ++i) {
+            async.Post([i, &sum]() { sum += i; });
+        }
+        async.WaitAll();
+        auto end = std::chrono::high_resolution_clock::now();
+        cout << "累计: " << sum.load() << "（期望 " << static_cast<long>(task_count) * (task_count - 1) / 2
+             << "），耗时 " << std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count() << " ms"
+             << endl;
+    };
+
+    cout << "[1 个工作线程] ";
+    AsyncCallback single;
+    run(single);
+
+    cout << "[4 个工作线程] ";
+    AsyncCallback multi(4);
+    run(multi);
+
+    cThread::ThreadPool::ThreadPoolConfig config{4, 4, 1024, std::chrono::seconds(4)};
+    cThread::ThreadPool pool(config);
+    pool.Start();
+    {
+        cout << "[共享线程池] ";
+        AsyncCallback shared(pool);
+        run(shared);
+
+        auto future = shared.Post<int>([]() { return 42; });
+        cout << "共享线程池带返回值回调: " << future.get() << endl;
+    }
+
+    // WaitAll 只等待调用之前提交的回调
+    std::atomic<bool> release(false);
+    multi.Post([&release]() {
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    std::thread waiter([&multi]() { multi.WaitAll(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::atomic<int> later(0);
+    multi.Post([&later]() { later++; });
+    release = true;
+    waiter.join();
+    multi.WaitAll();
+    cout << "WaitAll 期间提交的回调执行: " << later.load() << "（期望 1），待处理: " << multi.GetPendingCount() << endl;
+    pool.ShutDown();
+}
+
 int main() {
     cout << "========================================" << endl;
     cout << "    异步回调模式测试程序" << endl;
@@ -75,6 +131,7 @@ int main() {
         TestBasicAsyncCallback();
         TestAsyncCallbackWithReturn();
         TestAsyncCallbackException();
+        TestMultiWorker();
 
         cout << "\n========================================" << endl;
         cout << "    所有测试完成！" << endl;
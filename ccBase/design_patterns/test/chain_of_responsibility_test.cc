@@ -1,3 +1,4 @@
+#include <chrono>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -430,6 +431,128 @@ void TestMixedHandlers() {
     cache->HandleAndPass(req3);
 }
 
+// 测试8: 编译后的责任链
+void TestCompiledChain() {
+    cout << "\n========== 测试8: 编译后的责任链 ==========" << endl;
+
+    struct Request {
+        int code;
+    };
+
+    ChainBuilder<Request, std::string> builder;
+    builder.Add(MakeHandler<Request, std::string>([](const Request& req, std::string* resp) {
+        if (req.code < 0) {
+            *resp = "非法请求";
+            return HandleResult::kError;
+        }
+        return HandleResult::kNotHandled;
+    }));
+    builder.Add(MakeHandler<Request, std::string>([](const Request& req, std::string* resp) {
+        if (req.code == 1) {
+            *resp = "处理者2";
+            return HandleResult::kHandled;
+        }
+        return HandleResult::kNotHandled;
+    }));
+    auto chain = builder.Build();
+    // 构建后追加的处理者也会被编译进来
+    chain->GetNext()->SetNext(MakeHandler<Request, std::string>([](const Request& req, std::string* resp) {
+        if (req.code == 2) {
+            *resp = "处理者3";
+            return HandleResult::kHandled;
+        }
+        return HandleResult::kNotHandled;
+    }));
+
+    CompiledChain<Request, std::string> compiled = builder.Compile();
+    cout << "编译后处理者数量: " << compiled.GetSize() << "（期望 3）" << endl;
+    for (int code : {-1, 1, 2, 3}) {
+        std::string linked_resp, compiled_resp;
+        HandleResult linked = chain->HandleAndPass(Request{code}, &linked_resp);
+        HandleResult flat = compiled.Process(Request{code}, &compiled_resp);
+        cout << "code " << code << ": 结果" << (linked == flat ? "一致" : "不一致") << "，响应 \"" << compiled_resp
+             << "\"" << endl;
+    }
+
+    // 成环的链只收集一次
+    auto a = MakeHandler<Request, std::string>([](const Request&, std::string*) { return HandleResult::kNotHandled; });
+    auto b = MakeHandler<Request, std::string>([](const Request&, std::string*) { return HandleResult::kNotHandled; });
+    ChainBuilder<Request, std::string> cyclic;
+    cyclic.Add(a).Add(b);
+    b->SetNext(a);
+    cout << "成环的链编译后处理者数量: " << cyclic.Compile().GetSize() << "（期望 2）" << endl;
+    b->SetNext(nullptr);
+}
+
+// 测试9: 编译期责任链与性能对比
+void TestStaticChain() {
+    cout << "\n========== 测试9: 编译期责任链与性能对比 ==========" << endl;
+
+    struct Request {
+        int value;
+    };
+
+    class LimitHandler final : public Handler<Request, int> {
+       public:
+        explicit LimitHandler(int limit) : limit_(limit) {}
+        HandleResult Handle(const Request& req, int* /*resp*/) override {
+            if (req.value > limit_) {
+                return HandleResult::kError;
+            }
+            return HandleResult::kNotHandled;
+        }
+
+       private:
+        int limit_;
+    };
+
+    // 12 个过滤器，最后一个处理请求
+    auto filter = [](int id) {
+        return [id](const Request& req, int* resp) {
+            *resp += id;
+            return req.value == id ? HandleResult::kHandled : HandleResult::kNotHandled;
+        };
+    };
+    auto static_chain = MakeStaticChain<Request, int>(LimitHandler(1000), filter(1), filter(2), filter(3), filter(4),
+                                                      filter(5), filter(6), filter(7), filter(8), filter(9),
+                                                      filter(10), filter(11));
+    int resp = 0;
+    HandleResult result = static_chain.Process(Request{3}, &resp);
+    cout << "编译期链处理者数量: " << static_chain.GetSize() << "，value=3: "
+         << (result == HandleResult::kHandled ? "已处理" : "未处理") << "，resp " << resp << "（期望 6）" << endl;
+    resp = 0;
+    result = static_chain.Process(Request{2000}, &resp);
+    cout << "value=2000: " << (result == HandleResult::kError ? "错误" : "未出错") << "，resp " << resp << "（期望 0）"
+         << endl;
+
+    ChainBuilder<Request, int> builder;
+    builder.Add(std::make_shared<LimitHandler>(1000));
+    for (int id = 1; id <= 11; ++id) {
+        builder.Add(MakeHandler<Request, int>(filter(id)));
+    }
+    auto linked = builder.Build();
+    auto compiled = builder.Compile();
+
+    const int rounds = 1000000;
+    auto measure = [rounds](auto&& process) {
+        int resp = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < rounds; ++i) {
+            process(Request{11 + (i & 1)}, &resp);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::make_pair(resp, std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / rounds);
+    };
+    auto linked_result = measure([&](const Request& req, int* r) { return linked->HandleAndPass(req, r); });
+    auto compiled_result = measure([&](const Request& req, int* r) { return compiled.Process(req, r); });
+    auto static_result = measure([&](const Request& req, int* r) { return static_chain.Process(req, r); });
+    cout << "每个请求: HandleAndPass " << linked_result.second << " ns，CompiledChain " << compiled_result.second
+         << " ns，StaticChain " << static_result.second << " ns（结果"
+         << (linked_result.first == compiled_result.first && compiled_result.first == static_result.first ? "一致"
+                                                                                                          : "不一致")
+         << "）" << endl;
+}
+
 int main() {
     cout << "========================================" << endl;
     cout << "    责任链模式测试程序" << endl;
@@ -443,6 +566,8 @@ int main() {
         TestChainManager();
         TestRequestPipeline();
         TestMixedHandlers();
+        TestCompiledChain();
+        TestStaticChain();
 
         cout << "\n========================================" << endl;
         cout << "    所有测试完成！" << endl;
@@ -1,6 +1,12 @@
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
 #include "command.h"
+#include "size_class_pool.h"
+#include "thread_pool.h"
 
 using namespace cCommand;
 using std::cout;
@@ -49,6 +55,138 @@ void TestMacroCommand() {
     cout << "撤销宏命令后: " << text << endl;
 }
 
+void TestBoundedHistory() {
+    cout << "\n========== 测试3: 有容量限制的历史 ==========" << endl;
+
+    int value = 0;
+    CommandManager manager(3);
+    for (int i = 1; i <= 5; ++i) {
+        manager.Execute(manager.CreateCommand([&value, i]() { value += i; }, [&value, i]() { value -= i; }));
+    }
+    cout << "执行 1..5 后: " << value << "，可撤销 " << manager.GetUndoCount() << " 条（期望 3）" << endl;
+    int undone = 0;
+    while (manager.Undo()) {
+        undone++;
+    }
+    cout << "全部撤销 " << undone << " 条后: " << value << "（期望 3，最早的 1、2 已被覆盖）" << endl;
+    manager.Redo();
+    manager.Redo();
+    cout << "重做 2 条后: " << value << "，可重做 " << manager.GetRedoCount() << " 条（期望 10, 1）" << endl;
+
+    // 不能撤销的命令从历史中移除，重做历史保留
+    manager.Execute(std::make_shared<FunctionalCommand>([&value]() { value = 100; }));
+    manager.Execute(manager.CreateCommand([&value]() { value++; }, [&value]() { value--; }));
+    manager.Undo();
+    cout << "撤销后: " << value << "，撤销不能撤销的命令: " << (manager.Undo() ? "成功" : "失败")
+         << "，仍可重做: " << manager.GetRedoCount() << " 条（期望 100, 失败, 1）" << endl;
+    manager.Redo();
+    cout << "重做后: " << value << "（期望 101）" << endl;
+}
+
+// 连续输入的字符合并为一条编辑命令
+class InsertTextCommand : public Command {
+   public:
+    InsertTextCommand(std::string& document, std::string text) : document_(document), text_(std::move(text)) {}
+
+    void Execute() override { document_ += text_; }
+
+    void Undo() override { document_.resize(document_.size() - text_.size()); }
+
+    bool MergeWith(const Command& next) override {
+        auto insert = dynamic_cast<const InsertTextCommand*>(&next);
+        if (insert == nullptr || &insert->document_ != &document_ || text_.size() >= 16) {
+            return false;
+        }
+        text_ += insert->text_;
+        return true;
+    }
+
+   private:
+    std::string& document_;
+    std::string text_;
+};
+
+void TestMergeCommands() {
+    cout << "\n========== 测试4: 合并相邻命令 ==========" << endl;
+
+    std::string document;
+    CommandManager manager;
+    for (char c : std::string("hello world")) {
+        manager.Execute(manager.Create<InsertTextCommand>(document, std::string(1, c)));
+    }
+    cout << "输入 11 个字符后历史条数: " << manager.GetUndoCount() << "（期望 1）" << endl;
+    manager.Undo();
+    cout << "撤销一次后文档: \"" << document << "\"" << endl;
+    manager.Redo();
+    cout << "重做后文档: \"" << document << "\"" << endl;
+}
+
+void TestCommandMemory() {
+    cout << "\n========== 测试5: 长时间运行的内存占用 ==========" << endl;
+
+    cAllocator::SizeClassPool pool;
+    CommandManager manager(1000, &pool);
+    long value = 0;
+    const int rounds = 1000000;
+    size_t chunks_at_capacity = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+        manager.Execute(manager.CreateCommand([&value, i]() { value += i; }, [&value, i]() { value -= i; }));
+        if (i % 10 == 0) {
+            manager.Undo();
+        }
+        if (i == 10000) {
+            chunks_at_capacity = pool.GetChunkCount();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    cout << rounds << " 条命令，每条 "
+         << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / rounds << " ns，历史 "
+         << manager.GetUndoCount() + manager.GetRedoCount() << " 条，内存池大块数量 " << chunks_at_capacity << " -> "
+         << pool.GetChunkCount() << "（保持不变）" << endl;
+    manager.Clear();
+}
+
+void TestParallelMacroCommand() {
+    cout << "\n========== 测试6: 并行宏命令 ==========" << endl;
+
+    cThread::ThreadPool::ThreadPoolConfig config{4, 4, 1024, std::chrono::seconds(4)};
+    cThread::ThreadPool pool(config);
+    pool.Start();
+
+    const int slot_count = 64;
+    std::vector<long> slots(slot_count, 0);
+    auto macro = std::make_shared<ParallelMacroCommand>(pool);
+    for (int i = 0; i < slot_count; ++i) {
+        macro->AddCommand(std::make_shared<FunctionalCommand>([&slots, i]() { slots[i] += i; },
+                                                              [&slots, i]() { slots[i] -= i; }));
+    }
+
+    CommandManager manager;
+    manager.Execute(macro);
+    long sum = 0;
+    for (long slot : slots) {
+        sum += slot;
+    }
+    cout << "并行执行后之和: " << sum << "（期望 2016）" << endl;
+    manager.Undo();
+    sum = 0;
+    for (long slot : slots) {
+        sum += slot;
+    }
+    cout << "并行撤销后之和: " << sum << "（期望 0）" << endl;
+
+    auto failing = std::make_shared<ParallelMacroCommand>(pool);
+    failing->AddCommand(std::make_shared<FunctionalCommand>([]() { throw std::runtime_error("子命令失败"); }));
+    try {
+        failing->Execute();
+    } catch (const std::exception& e) {
+        cout << "捕获异常: " << e.what() << endl;
+    }
+
+    pool.ShutDown();
+}
+
 int main() {
     cout << "========================================" << endl;
     cout << "    命令模式测试程序" << endl;
@@ -57,6 +195,10 @@ int main() {
     try {
         TestBasicCommand();
         TestMacroCommand();
+        TestBoundedHistory();
+        TestMergeCommands();
+        TestCommandMemory();
+        TestParallelMacroCommand();
 
         cout << "\n========================================" << endl;
         cout << "    所有测试完成！" << endl;
@@ -1,6 +1,13 @@
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "arena.h"
 #include "factory.h"
+#include "object_pool.h"
 
 using namespace cFactory;
 using std::cout;
@@ -65,6 +72,108 @@ void TestAbstractFactory() {
     linux_btn->Render();
 }
 
+class MessageHandler {
+   public:
+    virtual ~MessageHandler() = default;
+    virtual int Handle(int value) = 0;
+};
+
+class EchoHandler : public MessageHandler {
+   public:
+    int Handle(int value) override { return value; }
+};
+
+class DoubleHandler : public MessageHandler {
+   public:
+    int Handle(int value) override { return value * 2; }
+};
+
+void TestFrozenFactory() {
+    cout << "\n========== 测试3: 冻结注册表 ==========" << endl;
+
+    SimpleFactory<MessageHandler> factory;
+    const int key_count = 32;
+    for (int i = 0; i < key_count; ++i) {
+        factory.Register("handler" + std::to_string(i), []() { return std::make_unique<EchoHandler>(); });
+    }
+
+    const int rounds = 1000000;
+    const std::string key = "handler17";
+    auto measure = [&]() {
+        auto start = std::chrono::high_resolution_clock::now();
+        long sum = 0;
+        for (int i = 0; i < rounds; ++i) {
+            sum += factory.Create(key)->Handle(1);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::make_pair(sum, std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / rounds);
+    };
+    auto locked = measure();
+    factory.Freeze();
+    auto frozen = measure();
+    cout << "每次 Create: 冻结前 " << locked.second << " ns，冻结后 " << frozen.second << " ns（结果"
+         << (locked.first == frozen.first ? "一致" : "不一致") << "）" << endl;
+
+    // 冻结后工作线程持续创建，同时有插件延迟注册
+    std::atomic<bool> stop{false};
+    std::atomic<long> created{0};
+    std::atomic<long> late_found{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&]() {
+            while (!stop.load()) {
+                if (factory.Create(key) != nullptr) {
+                    created++;
+                }
+                if (factory.Create("plugin") != nullptr) {
+                    late_found++;
+                }
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    factory.Register("plugin", []() { return std::make_unique<DoubleHandler>(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    stop = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    cout << "并发创建 " << (created.load() > 0 ? "成功" : "失败") << "，延迟注册后可见: "
+         << (late_found.load() > 0 ? "是" : "否") << "，plugin 结果: " << factory.Create("plugin")->Handle(21)
+         << "（期望 42），是否冻结: " << (factory.IsFrozen() ? "是" : "否") << endl;
+}
+
+void TestFactoryAllocationHooks() {
+    cout << "\n========== 测试4: 对象池与内存区域 ==========" << endl;
+
+    SimpleFactory<MessageHandler> factory;
+    cObjectPool::ObjectPool<DoubleHandler> pool([]() { return std::make_unique<DoubleHandler>(); });
+    factory.RegisterShared("pooled", [&pool]() { return std::shared_ptr<MessageHandler>(pool.Acquire()); });
+    factory.RegisterType<EchoHandler>("echo");
+    factory.Freeze();
+
+    MessageHandler* first = nullptr;
+    {
+        auto handler = factory.CreateShared("pooled");
+        first = handler.get();
+    }
+    auto reused = factory.CreateShared("pooled");
+    cout << "对象池创建: " << reused->Handle(5) << "（期望 10），复用归还的对象: " << (reused.get() == first ? "是" : "否")
+         << endl;
+    reused.reset();
+
+    cAllocator::Arena arena;
+    {
+        auto handler = factory.CreateShared("echo", &arena);
+        cout << "Arena 上创建: " << handler->Handle(7) << "（期望 7），Arena 已使用 " << arena.GetUsedBytes()
+             << " 字节" << endl;
+    }
+    arena.Reset();
+    auto fallback = factory.CreateShared("echo");
+    cout << "不指定内存资源时退回 Create: " << (fallback != nullptr ? "成功" : "失败")
+         << "，未注册: " << (factory.CreateShared("missing") == nullptr ? "nullptr" : "非空") << endl;
+}
+
 int main() {
     cout << "========================================" << endl;
     cout << "    工厂模式测试程序" << endl;
@@ -73,6 +182,8 @@ int main() {
     try {
         TestSimpleFactory();
         TestAbstractFactory();
+        TestFrozenFactory();
+        TestFactoryAllocationHooks();
 
         cout << "\n========================================" << endl;
         cout << "    所有测试完成！" << endl;
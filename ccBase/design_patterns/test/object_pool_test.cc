@@ -1,7 +1,12 @@
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <memory>
+#include <thread>
 #include <vector>
 #include "object_pool.h"
+#include "slab_object_pool.h"
+#include "thread_pool.h"
 
 using namespace cObjectPool;
 using std::cout;
@@ -49,6 +54,152 @@ void TestObjectPool() {
     cout << "释放所有连接后，可用对象数: " << pool.GetAvailableCount() << endl;
 }
 
+void TestSlabObjectPool() {
+    cout << "\n========== 测试2: slab 对象池 ==========" << endl;
+
+    struct Buffer {
+        int id = 0;
+        int used = 0;
+    };
+
+    SlabObjectPool<Buffer> pool([](Buffer* buffer) { buffer->used = 0; }, 8, 2);
+
+    // 句柄只能移动，析构时归还
+    std::vector<SlabObjectPool<Buffer>::Handle> handles;
+    for (int i = 0; i < 20; ++i) {
+        auto handle = pool.Acquire();
+        if (!handle) {
+            cout << "第 " << i << " 次获取失败（最多 16 个对象）" << endl;
+            break;
+        }
+        handle->id = i;
+        handle->used = 1;
+        handles.push_back(std::move(handle));
+    }
+    cout << "总对象数: " << pool.GetTotalCount() << endl;
+
+    handles.clear();
+    auto reused = pool.Acquire();
+    cout << "归还后重新获取，used = " << reused->used << "（期望 0）" << endl;
+    reused.Release();
+
+    // 全部空闲对象都在本线程缓存中：其他线程获取时从缓存收回，而不是因达到 slab 上限失败
+    int other_acquired = 0;
+    std::thread other([&pool, &other_acquired]() {
+        std::vector<SlabObjectPool<Buffer>::Handle> taken;
+        for (auto handle = pool.Acquire(); handle; handle = pool.Acquire()) {
+            taken.push_back(std::move(handle));
+        }
+        other_acquired = static_cast<int>(taken.size());
+    });
+    other.join();
+    cout << "其他线程获取到 " << other_acquired << " 个对象（期望 16）" << endl;
+
+    // 多线程下与 ObjectPool 对比
+    const int num_threads = 4;
+    const int iterations = 200000;
+    auto run = [&](auto&& acquire_release) {
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < iterations; ++i) {
+                    acquire_release();
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() /
+               (num_threads * iterations);
+    };
+
+    ObjectPool<Buffer> locked_pool([]() { return std::make_unique<Buffer>(); });
+    auto locked_ns = run([&]() {
+        auto buffer = locked_pool.Acquire();
+        buffer->used = 1;
+    });
+    SlabObjectPool<Buffer> slab_pool;
+    auto slab_ns = run([&]() {
+        auto buffer = slab_pool.Acquire();
+        buffer->used = 1;
+    });
+    cout << "ObjectPool 每次获取/归还: " << locked_ns << " ns" << endl;
+    cout << "SlabObjectPool 每次获取/归还: " << slab_ns << " ns" << endl;
+}
+
+void TestReserveShrinkAndStats() {
+    cout << "\n========== 测试3: 预热、收缩与统计 ==========" << endl;
+
+    struct Session {
+        std::vector<char> buffer = std::vector<char>(4096);
+    };
+
+    std::atomic<int> created{0};
+    ObjectPool<Session> pool(
+        [&created]() {
+            created++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            return std::make_unique<Session>();
+        },
+        nullptr, 16);
+
+    // 在线程池上并行预热
+    cThread::ThreadPool::ThreadPoolConfig config{4, 4, 64, std::chrono::seconds(4)};
+    cThread::ThreadPool thread_pool(config);
+    thread_pool.Start();
+    auto start = std::chrono::steady_clock::now();
+    size_t reserved = pool.Reserve(12, thread_pool);
+    auto cost = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    cout << "并行预热 " << reserved << " 个对象，耗时 " << cost.count() << " ms，可用对象数: "
+         << pool.GetAvailableCount() << endl;
+    reserved = pool.Reserve(14);
+    cout << "再预热到 14 个，新建 " << reserved << " 个" << endl;
+
+    // 借出全部对象后，AcquireFor 等待其他线程归还
+    std::vector<std::shared_ptr<Session>> sessions;
+    for (int i = 0; i < 16; ++i) {
+        sessions.push_back(pool.Acquire());
+    }
+    cout << "超过最大大小时 Acquire 返回空: " << (pool.Acquire() == nullptr ? "是" : "否") << endl;
+    std::thread releaser([&sessions]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        sessions.pop_back();
+    });
+    auto waited = pool.AcquireFor(std::chrono::seconds(1));
+    releaser.join();
+    cout << "AcquireFor 等到归还的对象: " << (waited != nullptr ? "是" : "否") << endl;
+    waited.reset();
+
+    // Clear 只清理空闲对象，不影响借出对象的计数
+    pool.Clear();
+    cout << "Clear 后总对象数: " << pool.GetTotalCount() << "（期望 15）" << endl;
+    sessions.clear();
+
+    // 空闲超时收缩
+    pool.SetIdleTimeout(std::chrono::milliseconds(20), 4);
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    size_t shrunk = pool.ShrinkIdle();
+    cout << "收缩 " << shrunk << " 个空闲对象，剩余 " << pool.GetTotalCount() << " 个（期望 4）" << endl;
+
+    ObjectPoolStats stats = pool.GetStats();
+    cout << "命中率: " << stats.HitRatio() << "，借出峰值: " << stats.peak_outstanding << "，失败: " << stats.failures
+         << "，等待 " << stats.wait_count << " 次共 " << stats.total_wait_us << " us" << endl;
+    thread_pool.ShutDown();
+
+    // 线程池已关闭时并行预热失败，预留的名额被归还
+    bool reserve_failed = false;
+    try {
+        pool.Reserve(10, thread_pool);
+    } catch (const std::exception&) {
+        reserve_failed = true;
+    }
+    cout << "线程池关闭后并行预热抛出异常: " << (reserve_failed ? "是" : "否") << "，总对象数: " << pool.GetTotalCount()
+         << "（期望 4）" << endl;
+}
+
 int main() {
     cout << "========================================" << endl;
     cout << "    对象池模式测试程序" << endl;
@@ -56,6 +207,8 @@ int main() {
 
     try {
         TestObjectPool();
+        TestSlabObjectPool();
+        TestReserveShrinkAndStats();
 
         cout << "\n========================================" << endl;
         cout << "    所有测试完成！" << endl;
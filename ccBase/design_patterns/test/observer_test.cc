@@ -4,6 +4,7 @@
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 #include "observer.h"
 
 using namespace cObserver;
@@ -281,6 +282,90 @@ void TestEventSystem() {
     cout << "点击事件统计: " << click_count.load() << " 次" << endl;
 }
 
+// 测试8: 高频通知主题
+void TestFastSubject() {
+    cout << "\n========== 测试8: 高频通知主题 ==========" << endl;
+
+    class Counter : public Observer<int> {
+       public:
+        void Update(const int& value) override { sum_ += value; }
+        long GetSum() const { return sum_; }
+
+       private:
+        long sum_ = 0;
+    };
+
+    FastSubject<int> subject;
+
+    // 弱引用观察者：失效后只做标记，下一次修改时移除
+    auto shared_counter = std::make_shared<Counter>();
+    subject.Attach(shared_counter);
+    {
+        auto temp = std::make_shared<Counter>();
+        subject.Attach(temp);
+    }
+    cout << "临时观察者失效后，通知了 " << subject.Notify(1) << " 个观察者，观察者数量: "
+         << subject.GetObserverCount() << "（期望 1, 1）" << endl;
+    cout << "Compact 移除 " << subject.Compact() << " 个失效观察者（期望 1）" << endl;
+
+    // 令牌观察者：令牌析构即移除
+    Counter token_counter;
+    {
+        ObserverToken token = subject.Attach(token_counter);
+        subject.Notify(10);
+        cout << "令牌观察者ID: " << token.GetId() << "，观察者数量: " << subject.GetObserverCount() << "（期望 2）"
+             << endl;
+    }
+    subject.Notify(100);
+    cout << "令牌析构后，令牌观察者累计: " << token_counter.GetSum() << "（期望 10），弱引用观察者累计: "
+         << shared_counter->GetSum() << "（期望 111）" << endl;
+
+    // 一个线程持续通知，另一个线程反复注册并销毁令牌观察者
+    std::atomic<bool> stop(false);
+    std::thread notifier([&subject, &stop]() {
+        while (!stop) {
+            subject.Notify(1);
+        }
+    });
+    for (int i = 0; i < 1000; ++i) {
+        auto temp = std::make_unique<Counter>();
+        ObserverToken token = subject.Attach(*temp);
+        token.Reset();
+        temp.reset();  // Reset 返回后观察者不会再被调用
+    }
+    stop = true;
+    notifier.join();
+    cout << "并发注册/销毁 1000 次后观察者数量: " << subject.GetObserverCount() << "（期望 1）" << endl;
+
+    // 性能对比：100 个观察者
+    const int observer_count = 100;
+    const int notify_count = 100000;
+    Subject<int> normal_subject;
+    FastSubject<int> weak_subject;
+    FastSubject<int> token_subject;
+    std::vector<std::shared_ptr<Counter>> counters;
+    std::vector<ObserverToken> tokens;
+    for (int i = 0; i < observer_count; ++i) {
+        counters.push_back(std::make_shared<Counter>());
+        normal_subject.Attach(counters.back());
+        weak_subject.Attach(counters.back());
+        tokens.push_back(token_subject.Attach(*counters.back()));
+    }
+    auto measure = [notify_count](auto& target) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < notify_count; ++i) {
+            target.Notify(i);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / notify_count;
+    };
+    auto normal_ns = measure(normal_subject);
+    auto weak_ns = measure(weak_subject);
+    auto token_ns = measure(token_subject);
+    cout << "每次通知 " << observer_count << " 个观察者 - Subject: " << normal_ns << " ns, FastSubject(弱引用): "
+         << weak_ns << " ns, FastSubject(令牌): " << token_ns << " ns" << endl;
+}
+
 int main() {
     cout << "========================================" << endl;
     cout << "    观察者模式测试程序" << endl;
@@ -294,6 +379,7 @@ int main() {
         TestObserverLifetime();
         TestDetachByPointer();
         TestEventSystem();
+        TestFastSubject();
 
         cout << "\n========================================" << endl;
         cout << "    所有测试完成！" << endl;
@@ -1,8 +1,11 @@
 #include <atomic>
 #include <chrono>
 #include <iostream>
+#include <string>
 #include <thread>
+#include <vector>
 #include "pub_sub.h"
+#include "thread_pool.h"
 
 using namespace cPubSub;
 using std::cout;
@@ -244,6 +247,302 @@ void TestPerformance() {
     cout << "平均每次发布耗时: " << (duration.count() / message_count) << " 微秒" << endl;
 }
 
+// 测试8: 读多写少模式
+void TestReadMostly() {
+    cout << "\n========== 测试8: 读多写少模式 ==========" << endl;
+
+    // 发布的同时修改订阅表
+    PubSub<int> pubsub(PublishMode::kReadMostly);
+    std::atomic<int> received_count(0);
+    for (int i = 0; i < 5; ++i) {
+        pubsub.Subscribe("numbers", [&received_count](const std::string&, const int&) { received_count++; });
+    }
+    std::atomic<bool> stop(false);
+    std::thread updater([&pubsub, &stop]() {
+        while (!stop.load()) {
+            auto id = pubsub.Subscribe("numbers", [](const std::string&, const int&) {});
+            pubsub.Unsubscribe("numbers", id);
+        }
+    });
+    std::vector<std::thread> publishers;
+    for (int i = 0; i < 4; ++i) {
+        publishers.emplace_back([&pubsub]() {
+            for (int j = 0; j < 1000; ++j) {
+                pubsub.Publish("numbers", j);
+            }
+        });
+    }
+    for (auto& t : publishers) {
+        t.join();
+    }
+    stop = true;
+    updater.join();
+    cout << "固定订阅者接收消息数: " << received_count.load() << "（期望 20000）" << endl;
+    cout << "订阅者数量: " << pubsub.GetSubscriberCount("numbers") << "（期望 5）" << endl;
+
+    // 多线程发布性能对比
+    auto run = [](PublishMode mode) {
+        PubSub<int> bench(mode);
+        for (int i = 0; i < 100; ++i) {
+            bench.Subscribe("perf", [](const std::string&, const int&) {});
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&bench]() {
+                for (int i = 0; i < 10000; ++i) {
+                    bench.Publish("perf", i);
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+    };
+    cout << "4 线程 x 10000 次发布，kLocked: " << run(PublishMode::kLocked)
+         << " 微秒，kReadMostly: " << run(PublishMode::kReadMostly) << " 微秒" << endl;
+}
+
+// 测试9: 主题句柄
+void TestTopicHandle() {
+    cout << "\n========== 测试9: 主题句柄 ==========" << endl;
+    PubSub<int> pubsub(PublishMode::kReadMostly);
+
+    TopicHandle orders = pubsub.Intern("orders");
+    cout << "重复注册返回相同句柄: " << (pubsub.Intern("orders") == orders ? "是" : "否") << endl;
+    cout << "未注册主题返回无效句柄: " << (!pubsub.Find("unknown").IsValid() ? "是" : "否") << endl;
+
+    // 字符串接口与句柄接口可以混用
+    int sum = 0;
+    pubsub.Subscribe(orders, [&sum](const std::string& topic, const int& value) {
+        if (topic == "orders") {
+            sum += value;
+        }
+    });
+    pubsub.Subscribe("orders", [&sum](const std::string&, const int& value) { sum += value; });
+    pubsub.Publish(orders, 1);
+    pubsub.Publish("orders", 2);
+    cout << "主题名称: " << pubsub.GetTopicName(orders) << "，订阅者数量: " << pubsub.GetSubscriberCount(orders)
+         << "，回调累计: " << sum << "（期望 6）" << endl;
+
+    // 按句柄发布与按字符串发布的耗时对比
+    const std::string long_topic = "market.data.level2.exchange.xshg.instrument.600000";
+    TopicHandle handle = pubsub.Intern(long_topic);
+    pubsub.Subscribe(handle, [](const std::string&, const int&) {});
+    const int message_count = 1000000;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < message_count; ++i) {
+        pubsub.Publish(long_topic, i);
+    }
+    auto by_string = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() -
+                                                                           start);
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < message_count; ++i) {
+        pubsub.Publish(handle, i);
+    }
+    auto by_handle = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() -
+                                                                           start);
+    cout << message_count << " 次发布，按字符串: " << by_string.count() << " 微秒，按句柄: " << by_handle.count()
+         << " 微秒" << endl;
+}
+
+// 测试10: 异步批量投递
+void TestAsyncDelivery() {
+    cout << "\n========== 测试10: 异步批量投递 ==========" << endl;
+    cThread::ThreadPool::ThreadPoolConfig config{4, 4, 1024, std::chrono::seconds(4)};
+    cThread::ThreadPool pool(config);
+    pool.Start();
+    PubSub<int> pubsub(PublishMode::kReadMostly);
+
+    // kBlock：不丢消息，回调按批收到消息
+    std::atomic<long> sum(0);
+    AsyncSubscribeOptions block_options;
+    block_options.queue_capacity = 256;
+    block_options.max_batch = 32;
+    SubscriberId block_id = pubsub.SubscribeAsync(
+        "ticks",
+        [&sum](const std::string&, const int* messages, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                sum += messages[i];
+            }
+        },
+        pool, block_options);
+
+    // kDropOldest：慢订阅者只会丢掉自己的旧消息，不会拖慢发布者
+    AsyncSubscribeOptions drop_options;
+    drop_options.queue_capacity = 16;
+    drop_options.policy = BackpressurePolicy::kDropOldest;
+    SubscriberId slow_id = pubsub.SubscribeAsync(
+        "ticks",
+        [](const std::string&, const int*, size_t) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); },
+        pool, drop_options);
+
+    // kConflateLatest：每个主题只保留最新一条
+    std::atomic<int> last_quote(-1);
+    AsyncSubscribeOptions conflate_options;
+    conflate_options.policy = BackpressurePolicy::kConflateLatest;
+    SubscriberId quote_id = pubsub.SubscribeAsync(
+        "ticks",
+        [&last_quote](const std::string&, const int* messages, size_t count) {
+            last_quote = messages[count - 1];
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        },
+        pool, conflate_options);
+
+    const int message_count = 10000;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < message_count; ++i) {
+        pubsub.Publish("ticks", i);
+    }
+    auto publish_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start);
+    pubsub.WaitAsyncIdle();
+
+    AsyncSubscriberStats block_stats = pubsub.GetAsyncStats(block_id);
+    AsyncSubscriberStats slow_stats = pubsub.GetAsyncStats(slow_id);
+    AsyncSubscriberStats quote_stats = pubsub.GetAsyncStats(quote_id);
+    cout << "发布 " << message_count << " 条消息耗时: " << publish_us.count() << " 微秒" << endl;
+    cout << "kBlock 累计: " << sum.load() << "（期望 " << static_cast<long>(message_count) * (message_count - 1) / 2
+         << "），" << block_stats.batches << " 批" << endl;
+    cout << "kDropOldest 投递 " << slow_stats.delivered << " 条，丢弃 " << slow_stats.dropped << " 条" << endl;
+    cout << "kConflateLatest 投递 " << quote_stats.delivered << " 条，合并 " << quote_stats.conflated
+         << " 条，最后一条: " << last_quote.load() << "（期望 " << message_count - 1 << "）" << endl;
+
+    pubsub.Unsubscribe("ticks", slow_id);
+    cout << "取消订阅后订阅者数量: " << pubsub.GetSubscriberCount("ticks") << "（期望 2）" << endl;
+
+    // 投递批次执行期间销毁 PubSub：析构等待回调返回，回调中的主题名称仍然有效
+    std::atomic<bool> entered(false);
+    std::atomic<size_t> topic_size(0);
+    {
+        PubSub<int> temporary;
+        temporary.SubscribeAsync(
+            "temporary.topic",
+            [&entered, &topic_size](const std::string& topic, const int*, size_t) {
+                entered = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                topic_size = topic.size();
+            },
+            pool);
+        temporary.Publish("temporary.topic", 1);
+        while (!entered) {
+            std::this_thread::yield();
+        }
+    }
+    cout << "析构时正在投递的批次读取的主题长度: " << topic_size.load() << "（期望 15）" << endl;
+
+    // 投递批次执行期间取消订阅：Unsubscribe 等待回调返回；在自己的回调中取消订阅不等待
+    std::atomic<bool> unsubscribe_entered(false);
+    std::atomic<bool> callback_returned(false);
+    SubscriberId waiting_id = pubsub.SubscribeAsync(
+        "slow.topic",
+        [&unsubscribe_entered, &callback_returned](const std::string&, const int*, size_t) {
+            unsubscribe_entered = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            callback_returned = true;
+        },
+        pool);
+    pubsub.Publish("slow.topic", 1);
+    while (!unsubscribe_entered) {
+        std::this_thread::yield();
+    }
+    pubsub.Unsubscribe("slow.topic", waiting_id);
+    cout << "Unsubscribe 返回时回调已完成: " << callback_returned.load() << "（期望 1）" << endl;
+
+    std::atomic<bool> self_removed(false);
+    SubscriberId self_id = 0;
+    self_id = pubsub.SubscribeAsync(
+        "self.topic",
+        [&pubsub, &self_id, &self_removed](const std::string& topic, const int*, size_t) {
+            self_removed = pubsub.Unsubscribe(topic, self_id);
+        },
+        pool);
+    pubsub.Publish("self.topic", 1);
+    pubsub.WaitAsyncIdle();
+    while (!self_removed) {
+        std::this_thread::yield();
+    }
+    cout << "在回调中取消自己的订阅: " << self_removed.load() << "（期望 1）" << endl;
+
+    // 只被通配订阅匹配的主题不注册：队列保存主题名称的副本，发布时的临时字符串释放后仍然有效
+    std::atomic<int> sensor_count(0);
+    std::atomic<bool> sensor_topic_ok(true);
+    SubscriberId sensor_id = pubsub.SubscribeAsync(
+        "sensor.#",
+        [&sensor_count, &sensor_topic_ok](const std::string& topic, const int* messages, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                if (topic != "sensor." + std::to_string(messages[i])) {
+                    sensor_topic_ok = false;
+                }
+            }
+            sensor_count += static_cast<int>(count);
+        },
+        pool);
+    uint32_t next_id_before = pubsub.Intern("sensor.probe.before").id;
+    const int sensor_topics = 1000;
+    for (int i = 0; i < sensor_topics; ++i) {
+        pubsub.Publish("sensor." + std::to_string(i), i);
+    }
+    pubsub.WaitAsyncIdle();
+    uint32_t next_id_after = pubsub.Intern("sensor.probe.after").id;
+    cout << "通配订阅收到 " << sensor_count.load() << " 条（期望 " << sensor_topics << "），主题名称"
+         << (sensor_topic_ok.load() ? "正确" : "错误") << "，新注册主题数: " << next_id_after - next_id_before - 1
+         << "（期望 0）" << endl;
+    pubsub.UnsubscribeAll(sensor_id);
+    pool.ShutDown();
+}
+
+// 测试11: 通配主题与反向索引
+void TestWildcardTopics() {
+    cout << "\n========== 测试11: 通配主题与反向索引 ==========" << endl;
+    for (PublishMode mode : {PublishMode::kLocked, PublishMode::kReadMostly}) {
+        cout << (mode == PublishMode::kLocked ? "[kLocked]" : "[kReadMostly]") << endl;
+        PubSub<int> pubsub(mode);
+        std::vector<std::string> trades, market, all;
+        SubscriberId trades_id = pubsub.Subscribe(
+            "market.*.trades", [&trades](const std::string& topic, const int&) { trades.push_back(topic); });
+        pubsub.Subscribe("market.#", [&market](const std::string& topic, const int&) { market.push_back(topic); });
+        pubsub.Subscribe("#", [&all](const std::string& topic, const int&) { all.push_back(topic); });
+        pubsub.Subscribe("market.AAPL.trades", [](const std::string&, const int&) {});
+
+        size_t count = pubsub.Publish("market.AAPL.trades", 1);
+        cout << "market.AAPL.trades 收到消息的订阅者: " << count << "（期望 4）" << endl;
+        count = pubsub.Publish("market.GOOGL.trades", 2);
+        cout << "market.GOOGL.trades 收到消息的订阅者: " << count << "（期望 3）" << endl;
+        count = pubsub.Publish("market.AAPL.quotes", 3);
+        cout << "market.AAPL.quotes 收到消息的订阅者: " << count << "（期望 2）" << endl;
+        count = pubsub.Publish(pubsub.Intern("market"), 4);
+        cout << "market 收到消息的订阅者: " << count << "（期望 2，\"#\" 可以匹配零段）" << endl;
+        cout << "market.*.trades 收到 " << trades.size() << " 条（期望 2），最后一条主题: " << trades.back() << endl;
+        cout << "market.# 收到 " << market.size() << " 条，# 收到 " << all.size() << " 条（期望 4, 4）" << endl;
+        cout << "market.AAPL.trades 订阅者数量: " << pubsub.GetSubscriberCount("market.AAPL.trades")
+             << "，market.# 订阅者数量: " << pubsub.GetSubscriberCount("market.#") << "（期望 4, 1）" << endl;
+
+        pubsub.Unsubscribe("market.*.trades", trades_id);
+        count = pubsub.Publish("market.MSFT.trades", 5);
+        cout << "取消 market.*.trades 后 market.MSFT.trades 收到消息的订阅者: " << count << "（期望 2）" << endl;
+    }
+
+    // 反向索引：UnsubscribeAll 只访问该订阅者自己的订阅，与主题数量无关
+    PubSub<int> pubsub;
+    const int topic_count = 10000;
+    std::vector<SubscriberId> ids;
+    for (int i = 0; i < topic_count; ++i) {
+        ids.push_back(pubsub.Subscribe("topic." + std::to_string(i), [](const std::string&, const int&) {}));
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t removed = 0;
+    for (SubscriberId id : ids) {
+        removed += pubsub.UnsubscribeAll(id);
+    }
+    auto elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start);
+    cout << topic_count << " 个主题逐个 UnsubscribeAll 耗时: " << elapsed.count() << " 微秒，取消 " << removed
+         << " 个订阅，剩余 " << pubsub.GetTotalSubscriberCount() << endl;
+}
+
 int main() {
     cout << "========================================" << endl;
     cout << "    发布-订阅模式测试程序" << endl;
@@ -257,6 +556,10 @@ int main() {
         TestUnsubscribe();
         TestTopicManagement();
         TestPerformance();
+        TestReadMostly();
+        TestTopicHandle();
+        TestAsyncDelivery();
+        TestWildcardTopics();
 
         cout << "\n========================================" << endl;
         cout << "    所有测试完成！" << endl;
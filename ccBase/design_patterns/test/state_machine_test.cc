@@ -1,5 +1,8 @@
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <vector>
 #include "state_machine.h"
 
 using namespace cStateMachine;
@@ -59,6 +62,151 @@ void TestStateMachine() {
     sm.TransitionTo("Running", ctx);
     sm.Update(ctx);
     sm.TransitionTo("Paused", ctx);
+
+    // 替换当前状态：旧对象被释放后，更新作用于新对象
+    class FastRunningState : public RunningState {
+       public:
+        void Update(GameContext& ctx) override { ctx.score += 100; }
+    };
+    sm.TransitionTo("Running", ctx);
+    sm.AddState(std::make_shared<FastRunningState>());
+    sm.Update(ctx);
+    cout << "替换当前状态后得分: " << ctx.score << "（期望 110）" << endl;
+}
+
+// 连接状态机：状态和事件都是稠密编号
+enum class ConnState : uint8_t { kIdle, kConnecting, kConnected, kClosed, kCount };
+enum class ConnEvent : uint8_t { kConnect, kEstablished, kClose, kReset, kCount };
+
+struct Connection {
+    int connects = 0;
+    int closes = 0;
+};
+
+void TestFlatStateMachine() {
+    cout << "\n========== 测试2: 稠密编号状态机 ==========" << endl;
+
+    using Table = FlatStateTable<Connection, ConnState, ConnEvent>;
+    auto table = std::make_shared<Table>(static_cast<size_t>(ConnState::kCount), static_cast<size_t>(ConnEvent::kCount));
+    table->SetState(ConnState::kIdle, "Idle")
+        .SetState(ConnState::kConnecting, "Connecting", [](Connection& c) { c.connects++; })
+        .SetState(ConnState::kConnected, "Connected")
+        .SetState(ConnState::kClosed, "Closed", [](Connection& c) { c.closes++; })
+        .AddTransition(ConnState::kIdle, ConnEvent::kConnect, ConnState::kConnecting)
+        .AddTransition(ConnState::kConnecting, ConnEvent::kEstablished, ConnState::kConnected)
+        .AddTransition(ConnState::kConnecting, ConnEvent::kClose, ConnState::kClosed)
+        .AddTransition(ConnState::kConnected, ConnEvent::kClose, ConnState::kClosed)
+        .AddTransition(ConnState::kClosed, ConnEvent::kReset, ConnState::kIdle,
+                       [](const Connection& c) { return c.closes < 2; });
+    std::shared_ptr<const Table> shared = table;
+
+    Connection conn;
+    FlatStateMachine<Connection, ConnState, ConnEvent> machine(*shared);
+    machine.Start(conn);
+    machine.Fire(ConnEvent::kConnect, conn);
+    machine.Fire(ConnEvent::kEstablished, conn);
+    cout << "当前状态: " << machine.GetCurrentStateName() << "（期望 Connected）" << endl;
+    cout << "非法事件 Reset: " << (machine.Fire(ConnEvent::kReset, conn) ? "转换" : "忽略") << endl;
+    machine.Fire(ConnEvent::kClose, conn);
+    cout << "第一次 Reset: " << (machine.Fire(ConnEvent::kReset, conn) ? "转换" : "忽略") << endl;
+    machine.Fire(ConnEvent::kConnect, conn);
+    machine.Fire(ConnEvent::kClose, conn);
+    cout << "第二次 Reset（条件不满足）: " << (machine.Fire(ConnEvent::kReset, conn) ? "转换" : "忽略")
+         << "，connects: " << conn.connects << "，closes: " << conn.closes << endl;
+
+    try {
+        table->AddTransition(ConnState::kIdle, ConnEvent::kCount, ConnState::kIdle);
+    } catch (const std::out_of_range& e) {
+        cout << "非法编号: " << e.what() << endl;
+    }
+
+    // 大量连接共享同一份定义
+    const int connection_count = 100000;
+    using Machine = FlatStateMachine<Connection, ConnState, ConnEvent>;
+    std::vector<Machine> machines(connection_count, Machine(*shared));
+    cout << connection_count << " 个实例，每个 " << sizeof(machines[0]) << " 字节" << endl;
+}
+
+constexpr StaticTransitionTable<ConnState, ConnEvent, static_cast<size_t>(ConnState::kCount),
+                                static_cast<size_t>(ConnEvent::kCount)>
+    kConnTable{{ConnState::kIdle, ConnEvent::kConnect, ConnState::kConnecting},
+               {ConnState::kConnecting, ConnEvent::kEstablished, ConnState::kConnected},
+               {ConnState::kConnecting, ConnEvent::kClose, ConnState::kClosed},
+               {ConnState::kConnected, ConnEvent::kClose, ConnState::kClosed},
+               {ConnState::kClosed, ConnEvent::kReset, ConnState::kIdle}};
+
+constexpr ConnState RunConnection() {
+    StaticStateMachine<kConnTable> machine(ConnState::kIdle);
+    machine.Fire(ConnEvent::kConnect);
+    machine.Fire(ConnEvent::kEstablished);
+    machine.Fire(ConnEvent::kReset);
+    return machine.GetCurrentState();
+}
+
+void TestStaticStateMachine() {
+    cout << "\n========== 测试3: 编译期转换表 ==========" << endl;
+
+    // 转换在编译期完成
+    static_assert(RunConnection() == ConnState::kConnected, "compile-time transition");
+    cout << "编译期执行结果: " << (RunConnection() == ConnState::kConnected ? "Connected" : "错误") << endl;
+
+    StaticStateMachine<kConnTable> machine(ConnState::kIdle);
+    int entered = 0;
+    auto count_enter = [&entered](ConnState, ConnState) { entered++; };
+    machine.Fire(ConnEvent::kConnect, count_enter);
+    machine.Fire(ConnEvent::kClose, count_enter);
+    cout << "转换次数: " << entered << "（期望 2），实例大小: " << sizeof(machine) << " 字节" << endl;
+
+    // 与按字符串查找的 StateMachine 对比一个连接周期的耗时
+    struct Empty {};
+    class NamedState : public State<Empty> {
+       public:
+        explicit NamedState(std::string name) : name_(std::move(name)) {}
+        std::string GetName() const override { return name_; }
+
+       private:
+        std::string name_;
+    };
+    StateMachine<Empty> named;
+    for (const char* name : {"Idle", "Connecting", "Connected", "Closed"}) {
+        named.AddState(std::make_shared<NamedState>(name));
+    }
+    named.AddTransition("Idle", "Connecting");
+    named.AddTransition("Connecting", "Connected");
+    named.AddTransition("Connected", "Closed");
+    named.AddTransition("Closed", "Idle");
+    named.SetInitialState("Idle");
+    Empty empty;
+    named.Start(empty);
+
+    using Table = FlatStateTable<Empty, ConnState, ConnEvent>;
+    Table table(static_cast<size_t>(ConnState::kCount), static_cast<size_t>(ConnEvent::kCount));
+    table.AddTransition(ConnState::kIdle, ConnEvent::kConnect, ConnState::kConnecting)
+        .AddTransition(ConnState::kConnecting, ConnEvent::kEstablished, ConnState::kConnected)
+        .AddTransition(ConnState::kConnected, ConnEvent::kClose, ConnState::kClosed)
+        .AddTransition(ConnState::kClosed, ConnEvent::kReset, ConnState::kIdle);
+    FlatStateMachine<Empty, ConnState, ConnEvent> flat(table);
+
+    const int rounds = 1000000;
+    const std::string names[] = {"Connecting", "Connected", "Closed", "Idle"};
+    const ConnEvent events[] = {ConnEvent::kConnect, ConnEvent::kEstablished, ConnEvent::kClose, ConnEvent::kReset};
+    auto measure = [rounds](auto&& step) {
+        auto start = std::chrono::high_resolution_clock::now();
+        int transitions = 0;
+        for (int i = 0; i < rounds; ++i) {
+            transitions += step(i & 3);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::make_pair(transitions,
+                              std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / rounds);
+    };
+    auto named_result = measure([&](int i) { return named.TransitionTo(names[i], empty); });
+    auto flat_result = measure([&](int i) { return flat.Fire(events[i], empty); });
+    StaticStateMachine<kConnTable> cycle(ConnState::kIdle);
+    auto static_result = measure([&](int i) { return cycle.Fire(events[i]); });
+    cout << "每次转换: StateMachine " << named_result.second << " ns，FlatStateMachine " << flat_result.second
+         << " ns，StaticStateMachine " << static_result.second << " ns（成功转换 " << named_result.first << "/"
+         << flat_result.first << "/" << static_result.first << "）" << endl;
 }
 
 int main() {
@@ -68,6 +216,8 @@ int main() {
 
     try {
         TestStateMachine();
+        TestFlatStateMachine();
+        TestStaticStateMachine();
 
         cout << "\n========================================" << endl;
         cout << "    所有测试完成！" << endl;
@@ -0,0 +1,218 @@
+#ifndef __BINARY_LOG__
+#define __BINARY_LOG__
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace cLogger {
+
+/**
+ * @brief 延迟格式化日志的参数编码
+ *
+ * LOGF_* 宏在调用线程只记录调用点ID、时间戳、线程ID和参数的原始字节，格式化推迟到后台线程或离线解码工具，
+ * 每个参数编码为 1 字节类型 + 数据：整数统一扩展为 64 位，浮点数为 double，字符串为 4 字节长度 + 内容
+ *
+ * 二进制日志文件格式（本机字节序）：
+ *   文件头: 8 字节 "CLOGBIN2"，每次打开文件都会写入，调用点ID在文件头之后重新编号
+ *   调用点: 'S' + u32 id + u8 level + i32 line + str file + str function + str format
+ *   日志:   'E' + u32 length + length 字节（DeferredHeader + 参数编码）
+ *   DeferredHeader: u32 site_id + i64 timestamp_ms + u64 thread_id，逐字段写入，不含结构体填充
+ */
+enum class ArgType : uint8_t {
+    INT = 1,
+    UINT = 2,
+    DOUBLE = 3,
+    BOOL = 4,
+    CHAR = 5,
+    STRING = 6,
+    POINTER = 7
+};
+
+constexpr char kBinaryLogMagic[8] = {'C', 'L', 'O', 'G', 'B', 'I', 'N', '2'};
+constexpr char kBinarySiteRecord = 'S';
+constexpr char kBinaryEntryRecord = 'E';
+
+/**
+ * @brief 每条延迟日志的固定头部
+ */
+struct DeferredHeader {
+    uint32_t site_id;
+    int64_t timestamp_ms;
+    uint64_t thread_id;
+};
+
+template <typename T>
+inline void AppendBinary(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+inline void AppendBinaryString(std::string& out, const char* data, size_t length) {
+    AppendBinary(out, static_cast<uint32_t>(length));
+    out.append(data, length);
+}
+
+template <typename T>
+inline bool ReadBinary(const char*& pos, const char* end, T& value) {
+    if (static_cast<size_t>(end - pos) < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+inline bool ReadBinaryString(const char*& pos, const char* end, const char*& data, uint32_t& length) {
+    if (!ReadBinary(pos, end, length) || static_cast<size_t>(end - pos) < length) {
+        return false;
+    }
+    data = pos;
+    pos += length;
+    return true;
+}
+
+inline void AppendDeferredHeader(std::string& out, const DeferredHeader& header) {
+    AppendBinary(out, header.site_id);
+    AppendBinary(out, header.timestamp_ms);
+    AppendBinary(out, header.thread_id);
+}
+
+inline bool ReadDeferredHeader(const char*& pos, const char* end, DeferredHeader& header) {
+    return ReadBinary(pos, end, header.site_id) && ReadBinary(pos, end, header.timestamp_ms) &&
+           ReadBinary(pos, end, header.thread_id);
+}
+
+/**
+ * @brief 编码一个参数，支持整数、浮点数、bool、char、字符串（const char* 和 std::string）、指针和枚举
+ */
+template <typename T>
+inline void EncodeArg(std::string& out, const T& value) {
+    using Type = std::decay_t<T>;
+    if constexpr (std::is_same<Type, bool>::value) {
+        AppendBinary(out, ArgType::BOOL);
+        AppendBinary(out, static_cast<uint8_t>(value));
+    } else if constexpr (std::is_same<Type, char>::value) {
+        AppendBinary(out, ArgType::CHAR);
+        AppendBinary(out, value);
+    } else if constexpr (std::is_enum<Type>::value) {
+        AppendBinary(out, ArgType::INT);
+        AppendBinary(out, static_cast<int64_t>(value));
+    } else if constexpr (std::is_integral<Type>::value && std::is_signed<Type>::value) {
+        AppendBinary(out, ArgType::INT);
+        AppendBinary(out, static_cast<int64_t>(value));
+    } else if constexpr (std::is_integral<Type>::value) {
+        AppendBinary(out, ArgType::UINT);
+        AppendBinary(out, static_cast<uint64_t>(value));
+    } else if constexpr (std::is_floating_point<Type>::value) {
+        AppendBinary(out, ArgType::DOUBLE);
+        AppendBinary(out, static_cast<double>(value));
+    } else if constexpr (std::is_same<Type, const char*>::value || std::is_same<Type, char*>::value) {
+        // 字符串字面量等数组参数不会是空指针，先退化为指针再判断
+        const char* str = value;
+        if constexpr (!std::is_array<T>::value) {
+            str = str != nullptr ? str : "(null)";
+        }
+        AppendBinary(out, ArgType::STRING);
+        AppendBinaryString(out, str, std::strlen(str));
+    } else if constexpr (std::is_same<Type, std::string>::value) {
+        AppendBinary(out, ArgType::STRING);
+        AppendBinaryString(out, value.data(), value.size());
+    } else if constexpr (std::is_pointer<Type>::value) {
+        AppendBinary(out, ArgType::POINTER);
+        AppendBinary(out, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+    } else {
+        static_assert(std::is_pointer<Type>::value, "unsupported LOGF argument type");
+    }
+}
+
+template <typename... Args>
+inline void EncodeArgs(std::string& out, const Args&... args) {
+    (EncodeArg(out, args), ...);
+}
+
+/**
+ * @brief 解码一个参数并以文本形式追加到 out
+ * @return 数据不完整或类型未知时返回 false
+ */
+inline bool DecodeArg(const char*& pos, const char* end, std::string& out) {
+    ArgType type;
+    if (!ReadBinary(pos, end, type)) {
+        return false;
+    }
+    char text[32];
+    int length = 0;
+    switch (type) {
+        case ArgType::INT: {
+            int64_t value;
+            if (!ReadBinary(pos, end, value)) return false;
+            length = std::snprintf(text, sizeof(text), "%lld", static_cast<long long>(value));
+            break;
+        }
+        case ArgType::UINT: {
+            uint64_t value;
+            if (!ReadBinary(pos, end, value)) return false;
+            length = std::snprintf(text, sizeof(text), "%llu", static_cast<unsigned long long>(value));
+            break;
+        }
+        case ArgType::DOUBLE: {
+            double value;
+            if (!ReadBinary(pos, end, value)) return false;
+            length = std::snprintf(text, sizeof(text), "%g", value);
+            break;
+        }
+        case ArgType::BOOL: {
+            uint8_t value;
+            if (!ReadBinary(pos, end, value)) return false;
+            out.append(value ? "true" : "false");
+            return true;
+        }
+        case ArgType::CHAR: {
+            char value;
+            if (!ReadBinary(pos, end, value)) return false;
+            out.push_back(value);
+            return true;
+        }
+        case ArgType::STRING: {
+            const char* data;
+            uint32_t size;
+            if (!ReadBinaryString(pos, end, data, size)) return false;
+            out.append(data, size);
+            return true;
+        }
+        case ArgType::POINTER: {
+            uint64_t value;
+            if (!ReadBinary(pos, end, value)) return false;
+            length = std::snprintf(text, sizeof(text), "0x%llx", static_cast<unsigned long long>(value));
+            break;
+        }
+        default:
+            return false;
+    }
+    out.append(text, length > 0 ? length : 0);
+    return true;
+}
+
+/**
+ * @brief 按顺序把参数填入 format 中的 "{}"，参数不足时保留 "{}"，多余的参数被忽略
+ */
+inline void FormatDeferredMessage(const char* format, const char* args, size_t length, std::string& out) {
+    const char* pos = args;
+    const char* end = args + length;
+    for (const char* p = format; *p != '\0'; ++p) {
+        if (p[0] == '{' && p[1] == '}' && pos < end) {
+            if (!DecodeArg(pos, end, out)) {
+                out.append("{}");
+                pos = end;
+            }
+            ++p;
+        } else {
+            out.push_back(*p);
+        }
+    }
+}
+
+}  // namespace cLogger
+
+#endif  // __BINARY_LOG__
@@ -0,0 +1,98 @@
+#ifndef __LOG_DECODER__
+#define __LOG_DECODER__
+
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include "binary_log.h"
+#include "logger.h"
+
+namespace cLogger {
+
+/**
+ * @brief 把 binary_log_path 写出的二进制日志解码为文本，格式与文本日志相同（始终包含线程ID和文件信息）
+ * @return 解码的日志条数，遇到损坏的记录时停止
+ */
+inline size_t DecodeBinaryLog(std::istream& in, std::ostream& out) {
+    struct Site {
+        LogLevel level;
+        int line;
+        std::string file;
+        std::string function;
+        std::string format;
+    };
+
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const char* pos = data.data();
+    const char* end = pos + data.size();
+    std::unordered_map<uint32_t, Site> sites;
+    std::string message;
+    std::string line;
+    size_t count = 0;
+    while (pos < end) {
+        if (static_cast<size_t>(end - pos) >= sizeof(kBinaryLogMagic) &&
+            std::memcmp(pos, kBinaryLogMagic, sizeof(kBinaryLogMagic)) == 0) {
+            // 新的文件头，之后的调用点ID重新编号
+            sites.clear();
+            pos += sizeof(kBinaryLogMagic);
+            continue;
+        }
+        char type = *pos++;
+        if (type == kBinarySiteRecord) {
+            uint32_t site_id;
+            uint8_t level;
+            int32_t site_line;
+            const char* text[3];
+            uint32_t length[3];
+            if (!ReadBinary(pos, end, site_id) || !ReadBinary(pos, end, level) || !ReadBinary(pos, end, site_line) ||
+                !ReadBinaryString(pos, end, text[0], length[0]) || !ReadBinaryString(pos, end, text[1], length[1]) ||
+                !ReadBinaryString(pos, end, text[2], length[2])) {
+                break;
+            }
+            sites[site_id] = Site{static_cast<LogLevel>(level), site_line, std::string(text[0], length[0]),
+                                  std::string(text[1], length[1]), std::string(text[2], length[2])};
+        } else if (type == kBinaryEntryRecord) {
+            const char* record;
+            uint32_t length;
+            DeferredHeader header;
+            if (!ReadBinaryString(pos, end, record, length)) {
+                break;
+            }
+            const char* body = record;
+            if (!ReadDeferredHeader(body, record + length, header)) {
+                break;
+            }
+            auto iter = sites.find(header.site_id);
+            if (iter == sites.end()) {
+                continue;
+            }
+            const Site& site = iter->second;
+            message.clear();
+            FormatDeferredMessage(site.format.c_str(), body, record + length - body, message);
+            std::string thread_id = std::to_string(header.thread_id);
+            auto format_line = [&]() {
+                return Logger::FormatLogLine(&line[0], line.size(), header.timestamp_ms, site.level,
+                                             thread_id.c_str(), site.file.c_str(), site.line, site.function.c_str(),
+                                             message.data(), message.size());
+            };
+            line.resize(1024);
+            size_t line_length = format_line();
+            if (line_length > line.size()) {
+                line.resize(line_length);
+                format_line();
+            }
+            out.write(line.data(), line_length);
+            ++count;
+        } else {
+            break;
+        }
+    }
+    return count;
+}
+
+}  // namespace cLogger
+
+#endif  // __LOG_DECODER__
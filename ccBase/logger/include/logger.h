@@ -1,21 +1,40 @@
 #ifndef __LOGGER__
 #define __LOGGER__
 
+#include <algorithm>
 #include <atomic>
+#include <charconv>
 #include <chrono>
 #include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <deque>
 #include <fstream>
-#include <iomanip>
 #include <iostream>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
 
+#ifdef CLOGGER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "binary_log.h"
+#include "metrics.h"
+#include "mpsc_ring_buffer.h"
+#include "thread_log_buffer.h"
+
 namespace cLogger {
 
 /**
@@ -29,6 +48,76 @@ enum class LogLevel {
     FATAL = 4
 };
 
+/**
+ * @brief LOGF_* 宏的调用点，每个调用点对应一个静态对象，第一次写日志时注册并分配ID
+ * 延迟格式化时只传递ID，文件名、行号、函数名和格式串在消费端通过ID查找
+ */
+struct LogSite {
+    LogLevel level;
+    const char* file;
+    int line;
+    const char* function;
+    const char* format = nullptr;
+    std::atomic<uint32_t> id{0};
+};
+
+/**
+ * @brief 日志模块，用于按模块覆盖日志级别
+ * level 为 kInheritLevel 时使用全局级别；对象由 Logger 持有，地址在进程内保持不变，
+ * LOGM_* 宏把模块引用缓存在调用点的静态变量中（模块名必须是字符串字面量），检查级别时只需读取一个原子变量
+ */
+struct LogModule {
+    static constexpr int kInheritLevel = -1;
+
+    explicit LogModule(std::string module_name) : name(std::move(module_name)) {}
+
+    const std::string name;
+    std::atomic<int> level{kInheritLevel};
+};
+
+/**
+ * @brief 异步队列已满时的处理策略
+ * BLOCK: 生产者等待后台线程腾出空间，不丢日志
+ * DROP: 直接丢弃新日志
+ * DROP_AND_COUNT: 丢弃新日志并计数，后台线程在恢复后写一条 WARN 报告丢弃的条数
+ */
+enum class OverflowPolicy {
+    BLOCK = 0,
+    DROP = 1,
+    DROP_AND_COUNT = 2
+};
+
+/**
+ * @brief 返回路径中的文件名部分，常量表达式，LOG_* 宏在编译期求值
+ */
+constexpr const char* GetFileBaseName(const char* path) {
+    const char* base = path;
+    for (const char* p = path; *p != '\0'; ++p) {
+        if (*p == '/' || *p == '\\') {
+            base = p + 1;
+        }
+    }
+    return base;
+}
+
+// 编译期计算 __FILE__ 的文件名部分
+#define CLOGGER_FILE_NAME                                                        \
+    ([]() {                                                                      \
+        constexpr const char* file_name = cLogger::GetFileBaseName(__FILE__);    \
+        return file_name;                                                        \
+    }())
+
+/**
+ * @brief 文件输出的刷新策略，决定持久性与吞吐量的取舍
+ * EVERY_LINE: 每条日志写出后立即 flush，进程崩溃时不丢日志，但每条日志至少一次系统调用
+ * BUFFERED: 日志先追加到内存缓冲区，缓冲区达到 file_buffer_size、距上次写出超过 file_flush_interval_ms
+ *           或写入 FATAL 日志时一次性写出；进程崩溃时最多丢失缓冲区中尚未写出的日志
+ */
+enum class FileFlushPolicy {
+    EVERY_LINE = 0,
+    BUFFERED = 1
+};
+
 /**
  * @brief 日志配置
  */
@@ -41,7 +130,33 @@ struct LoggerConfig {
     bool enable_file_info = true;          // 是否显示文件信息（文件名、行号、函数名）
     size_t max_file_size = 10 * 1024 * 1024;  // 最大文件大小（10MB）
     int max_backup_files = 5;              // 最大备份文件数
+    bool compress_rotated = false;         // 是否在后台把轮转出的备份压缩为 .N.gz（需要以 CLOGGER_HAVE_ZLIB 编译）
     bool async_mode = false;                // 是否使用异步模式
+    OverflowPolicy overflow_policy = OverflowPolicy::BLOCK;  // 异步队列满时的处理策略
+    size_t async_queue_size = 8192;        // 异步队列槽位数（向上取 2 的幂）
+    size_t async_slot_size = 256;          // 每个槽位预分配的字节数，超长日志会额外分配内存
+    int async_flush_interval_ms = 10;      // 后台线程两次批量写出之间的最长等待时间（毫秒）
+    FileFlushPolicy file_flush_policy = FileFlushPolicy::EVERY_LINE;  // 文件输出的刷新策略
+    size_t file_buffer_size = 64 * 1024;   // BUFFERED 策略下缓冲区写出阈值（字节）
+    int file_flush_interval_ms = 1000;     // BUFFERED 策略下缓冲日志的最长停留时间（毫秒）
+    bool deferred_mode = false;            // LOGF_* 日志只在调用线程记录参数，由异步线程格式化（需要 async_mode）
+    std::string binary_log_path;           // 非空时 LOGF_* 日志以二进制写入该文件，用 log_decoder 解码为文本
+    bool per_thread_buffer = false;        // 每个线程写入自己的暂存区，由收集线程按时间戳合并写出（优先于 async_mode）
+    size_t thread_buffer_size = 64 * 1024; // 每个线程暂存区的字节数，满时按 overflow_policy 处理
+};
+
+/**
+ * @brief 日志系统的运行指标，由 Logger::GetMetrics 返回，ExportMetrics 导出的也是同一份数据
+ * emit_ns 为抽样记录的调用线程写一条日志的耗时，block_wait_ns 为 BLOCK 策略下队列满时调用线程等待的时间
+ */
+struct LoggerMetrics {
+    uint64_t logged = 0;       // 通过级别检查后写入的日志条数
+    uint64_t written = 0;      // 异步线程已经写出的日志条数
+    uint64_t dropped = 0;      // 队列满时被丢弃的日志条数（DROP_AND_COUNT）
+    uint64_t blocked = 0;      // 队列满时调用线程等待的次数（BLOCK）
+    size_t queue_depth = 0;    // 异步队列中尚未写出的日志条数
+    cMetrics::HistogramSnapshot emit_ns;
+    cMetrics::HistogramSnapshot block_wait_ns;
 };
 
 /**
@@ -62,15 +177,29 @@ class Logger {
      * @param config 日志配置
      */
     void Initialize(const LoggerConfig& config) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        config_ = config;
+        // 先写完旧配置下排队的日志，后台线程在 mutex_ 之外启停，避免与 WriteLog 互相等待
+        StopAsyncWorker();
+        StopCollector();
+        StopFileFlusher();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            FlushFileBuffer();
+            config_ = config;
+            min_level_.store(static_cast<int>(config_.min_level), std::memory_order_relaxed);
 
-        if (config_.enable_file) {
-            OpenLogFile();
+            if (config_.enable_file) {
+                OpenLogFile();
+            }
+            OpenBinaryFile();
+            UpdateEmitFlagsLocked();
         }
 
-        if (config_.async_mode) {
+        if (config_.per_thread_buffer) {
+            StartCollector();
+        } else if (config_.async_mode) {
             StartAsyncWorker();
+        } else if (config_.enable_file && config_.file_flush_policy == FileFlushPolicy::BUFFERED) {
+            StartFileFlusher();
         }
     }
 
@@ -80,6 +209,50 @@ class Logger {
     void SetLevel(LogLevel level) {
         std::lock_guard<std::mutex> lock(mutex_);
         config_.min_level = level;
+        min_level_.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 设置模块的日志级别，覆盖全局级别
+     */
+    void SetModuleLevel(const std::string& module_name, LogLevel level) {
+        GetModule(module_name).level.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 取消模块的级别覆盖，恢复使用全局级别
+     */
+    void ResetModuleLevel(const std::string& module_name) {
+        GetModule(module_name).level.store(LogModule::kInheritLevel, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 获取模块，不存在时创建；返回的引用一直有效
+     */
+    LogModule& GetModule(const std::string& module_name) {
+        std::lock_guard<std::mutex> lock(module_mutex_);
+        for (LogModule& module : modules_) {
+            if (module.name == module_name) {
+                return module;
+            }
+        }
+        modules_.emplace_back(module_name);
+        return modules_.back();
+    }
+
+    /**
+     * @brief 判断该级别的日志是否需要输出，无锁
+     */
+    bool IsEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= min_level_.load(std::memory_order_relaxed);
+    }
+
+    bool IsEnabled(LogLevel level, const LogModule& module) const {
+        int module_level = module.level.load(std::memory_order_relaxed);
+        if (module_level == LogModule::kInheritLevel) {
+            return IsEnabled(level);
+        }
+        return static_cast<int>(level) >= module_level;
     }
 
     /**
@@ -92,52 +265,262 @@ class Logger {
      */
     void Log(LogLevel level, const char* file, int line, const char* function,
              const std::string& message) {
-        if (level < config_.min_level) {
-            return;
+        if (IsEnabled(level)) {
+            Emit(level, file, line, function, message.data(), message.size());
+        }
+    }
+
+    void Log(LogLevel level, const char* file, int line, const char* function, const char* message) {
+        if (IsEnabled(level)) {
+            Emit(level, file, line, function, message, std::strlen(message));
         }
+    }
 
-        std::string log_entry = FormatLog(level, file, line, function, message);
+    /**
+     * @brief 不检查级别直接输出日志，由已经检查过级别的 LOG_* 宏调用
+     */
+    void Emit(LogLevel level, const char* file, int line, const char* function,
+              const std::string& message) {
+        Emit(level, file, line, function, message.data(), message.size());
+    }
 
-        if (config_.async_mode) {
-            // 异步模式：将日志放入队列
-            std::lock_guard<std::mutex> lock(queue_mutex_);
-            log_queue_.push(log_entry);
-            queue_cv_.notify_one();
+    void Emit(LogLevel level, const char* file, int line, const char* function, const char* message) {
+        Emit(level, file, line, function, message, std::strlen(message));
+    }
+
+    void Emit(LogLevel level, const char* file, int line, const char* function, const char* message,
+              size_t message_length) {
+        cMetrics::ScopedTimer timer(cMetrics::ShouldSample<EmitSample>() ? &emit_ns_ : nullptr);
+        logged_num_.Add(1);
+        // 格式化到线程局部的固定缓冲区，超长日志才分配内存
+        static thread_local char buffer[kFormatBufferSize];
+        std::string long_entry;
+        const char* log_entry = buffer;
+        int64_t timestamp_ms = CurrentTimeMs();
+        size_t length = FormatLogTo(buffer, sizeof(buffer), timestamp_ms, level, file, line, function, message,
+                                    message_length);
+        if (length > sizeof(buffer)) {
+            long_entry.resize(length);
+            FormatLogTo(&long_entry[0], length, timestamp_ms, level, file, line, function, message, message_length);
+            log_entry = long_entry.data();
+        }
+
+        Dispatch(log_entry, length, timestamp_ms);
+
+        // FATAL 日志之后进程往往马上退出，立即写出所有缓冲的日志
+        if (level == LogLevel::FATAL) {
+            Flush();
+        }
+    }
+
+    /**
+     * @brief 记录延迟格式化的日志，由 LOGF_* 宏调用
+     * 调用线程只编码调用点ID、时间戳、线程ID和参数，deferred_mode 且异步线程运行时交给异步线程格式化，
+     * 否则在当前线程格式化；配置了 binary_log_path 时不格式化，直接写入二进制日志
+     * @param site 调用点
+     * @param format 格式串，按顺序用参数替换其中的 "{}"
+     */
+    template <typename... Args>
+    void LogDeferred(LogSite& site, const char* format, const Args&... args) {
+        if (IsEnabled(site.level)) {
+            EmitDeferred(site, format, args...);
+        }
+    }
+
+    /**
+     * @brief 不检查级别直接记录延迟格式化的日志，由已经检查过级别的 LOGF_* 宏调用
+     */
+    template <typename... Args>
+    void EmitDeferred(LogSite& site, const char* format, const Args&... args) {
+        cMetrics::ScopedTimer timer(cMetrics::ShouldSample<EmitSample>() ? &emit_ns_ : nullptr);
+        logged_num_.Add(1);
+        uint32_t site_id = site.id.load(std::memory_order_acquire);
+        if (site_id == 0) {
+            site_id = RegisterSite(site, format);
+        }
+
+        // 线程局部缓冲区清空后保留容量，稳定后不再分配内存
+        static thread_local std::string record;
+        record.clear();
+        DeferredHeader header{site_id, CurrentTimeMs(), CurrentThreadNumber()};
+        AppendDeferredHeader(record, header);
+        EncodeArgs(record, args...);
+
+        uint32_t flags = emit_flags_.load(std::memory_order_acquire);
+        if ((flags & kEmitDeferredAsync) != 0 && AcquireAsyncRing()) {
+            PushAsync(record.data(), record.size(), kDeferredRecordTag);
+            ReleaseAsyncRing();
+        } else if ((flags & kEmitBinaryFile) != 0) {
+            std::string records;
+            AppendBinaryString(records, record.data(), record.size());
+            WriteBinaryRecords(records);
         } else {
-            // 同步模式：直接输出
-            WriteLog(log_entry);
+            std::string log_entry;
+            AppendDeferredText(log_entry, record.data(), record.size());
+            Dispatch(log_entry.data(), log_entry.size(), header.timestamp_ms);
+        }
+
+        if (site.level == LogLevel::FATAL) {
+            Flush();
         }
     }
 
+    /**
+     * @brief 把一条日志格式化到 buffer 中，不分配内存；thread_id 或 file 为 nullptr 时不输出对应字段
+     * 二进制日志的解码工具也使用该函数，保证输出格式一致
+     * @return 完整日志需要的字节数，大于 size 时 buffer 中的内容被截断，调用者需要用更大的缓冲区重新格式化
+     */
+    static size_t FormatLogLine(char* buffer, size_t size, int64_t timestamp_ms, LogLevel level,
+                                const char* thread_id, const char* file, int line, const char* function,
+                                const char* message, size_t message_length) {
+        LineWriter writer{buffer, buffer + size, 0};
+
+        // 时间戳
+        AppendTimestamp(writer, timestamp_ms);
+
+        // 日志级别
+        writer.Append(" [");
+        writer.Append(LevelToString(level));
+        writer.Append("]");
+
+        // 线程ID
+        if (thread_id != nullptr) {
+            writer.Append(" [T:");
+            writer.Append(thread_id);
+            writer.Append("]");
+        }
+
+        // 文件信息
+        if (file != nullptr) {
+            writer.Append(" [");
+            writer.Append(GetFileBaseName(file));
+            writer.Append(":");
+            char line_str[16];
+            char* line_end = std::to_chars(line_str, line_str + sizeof(line_str), line).ptr;
+            writer.Append(line_str, line_end - line_str);
+            writer.Append(":");
+            writer.Append(function);
+            writer.Append("]");
+        }
+
+        // 日志消息
+        writer.Append(" ");
+        writer.Append(message, message_length);
+        writer.Append("\n");
+        return writer.length;
+    }
+
     /**
      * @brief 刷新日志缓冲区
      */
     void Flush() {
-        if (config_.async_mode) {
-            // 等待队列为空
+        if (staging_running_.load(std::memory_order_acquire)) {
+            // 等待收集线程完成一轮在本次 Flush 之后开始的收集
+            std::unique_lock<std::mutex> lock(collector_mutex_);
+            uint64_t generation = ++flush_requested_gen_;
+            collector_cv_.notify_all();
+            collector_done_cv_.wait(lock, [this, generation] {
+                return flush_done_gen_ >= generation || !staging_running_.load();
+            });
+        }
+        if (AcquireAsyncRing()) {
+            // 等待调用 Flush 之前入队的日志全部写出
+            uint64_t target = log_ring_->GetPushedCount();
+            ReleaseAsyncRing();
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            queue_cv_.wait(lock, [this] { return log_queue_.empty(); });
+            ++flush_waiters_;
+            queue_cv_.notify_one();
+            flush_cv_.wait(lock, [this, target] {
+                return written_num_.load() >= target || !async_running_.load();
+            });
+            --flush_waiters_;
         }
 
         std::lock_guard<std::mutex> lock(mutex_);
+        FlushFileBuffer();
         if (log_file_.is_open()) {
             log_file_.flush();
         }
         std::cout.flush();
     }
 
+    /**
+     * @brief 获取异步队列已满时被丢弃的日志条数（DROP_AND_COUNT 策略下统计）
+     */
+    uint64_t GetDroppedCount() const { return dropped_num_.load(); }
+
+    /**
+     * @brief 获取运行指标
+     */
+    LoggerMetrics GetMetrics() const {
+        LoggerMetrics metrics;
+        metrics.logged = logged_num_.Value();
+        metrics.written = written_num_.load();
+        metrics.dropped = dropped_num_.load();
+        metrics.blocked = blocked_num_.Value();
+        if (AcquireAsyncRing()) {
+            metrics.queue_depth = log_ring_->size();
+            ReleaseAsyncRing();
+        }
+        metrics.emit_ns = emit_ns_.Snapshot();
+        metrics.block_wait_ns = block_wait_ns_.Snapshot();
+        return metrics;
+    }
+
+    /**
+     * @brief 把运行指标以 prefix.logged、prefix.emit_ns.p99 等名称注册到 registry，再次调用时替换之前的注册
+     */
+    void ExportMetrics(const std::string& prefix, cMetrics::Registry& registry = cMetrics::Registry::Global()) {
+        metrics_registration_ = registry.AddCollector([this, prefix](cMetrics::Samples& samples) {
+            LoggerMetrics metrics = GetMetrics();
+            samples.push_back({prefix + ".logged", static_cast<double>(metrics.logged)});
+            samples.push_back({prefix + ".written", static_cast<double>(metrics.written)});
+            samples.push_back({prefix + ".dropped", static_cast<double>(metrics.dropped)});
+            samples.push_back({prefix + ".blocked", static_cast<double>(metrics.blocked)});
+            samples.push_back({prefix + ".queue_depth", static_cast<double>(metrics.queue_depth)});
+            cMetrics::AppendHistogram(samples, prefix + ".emit_ns", metrics.emit_ns);
+            cMetrics::AppendHistogram(samples, prefix + ".block_wait_ns", metrics.block_wait_ns);
+        });
+    }
+
     /**
      * @brief 关闭日志系统
      */
     void Shutdown() {
-        if (config_.async_mode) {
-            StopAsyncWorker();
+        StopAsyncWorker();
+        StopCollector();
+        StopFileFlusher();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            FlushFileBuffer();
+            if (log_file_.is_open()) {
+                log_file_.close();
+            }
+            if (binary_file_.is_open()) {
+                binary_file_.close();
+            }
+            UpdateEmitFlagsLocked();
         }
+        StopCompressWorker();
+    }
 
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (log_file_.is_open()) {
-            log_file_.close();
+    /**
+     * @brief 等待后台压缩线程处理完已经轮转出的备份文件
+     */
+    void WaitForCompression() { StopCompressWorker(); }
+
+    /**
+     * @brief 安装崩溃信号处理（SIGSEGV/SIGABRT/SIGBUS/SIGFPE/SIGILL）
+     * 崩溃时不加锁地把文件缓冲区和各线程暂存区中尚未写出的日志直接 write 到日志文件（未开启文件输出时写到 stderr），
+     * 之后恢复默认处理并重新触发信号；属于尽力而为，与正在进行的写出可能产生少量重复
+     */
+    static void InstallCrashHandler() {
+#if defined(__unix__) || defined(__APPLE__)
+        for (int sig : {SIGSEGV, SIGABRT, SIGBUS, SIGFPE, SIGILL}) {
+            std::signal(sig, &Logger::CrashSignalHandler);
         }
+#endif
     }
 
    private:
@@ -148,53 +531,125 @@ class Logger {
 
     void OpenLogFile() {
         if (log_file_.is_open()) {
+            FlushFileBuffer();
             log_file_.close();
         }
         log_file_.open(config_.log_file_path, std::ios::app);
         if (!log_file_.is_open()) {
             std::cerr << "Failed to open log file: " << config_.log_file_path
                       << std::endl;
+            return;
         }
+        // 只在打开时查询一次文件大小，之后在内存中累加
+        log_file_.seekp(0, std::ios::end);
+        file_size_ = static_cast<size_t>(log_file_.tellp());
+        last_file_flush_ = std::chrono::steady_clock::now();
     }
 
     std::string FormatLog(LogLevel level, const char* file, int line,
-                          const char* function, const std::string& message) {
-        std::ostringstream oss;
+                          const char* function, const char* message, size_t message_length) {
+        std::string log_entry(kFormatBufferSize, '\0');
+        int64_t timestamp_ms = CurrentTimeMs();
+        size_t length = FormatLogTo(&log_entry[0], log_entry.size(), timestamp_ms, level, file, line, function,
+                                    message, message_length);
+        if (length > log_entry.size()) {
+            log_entry.resize(length);
+            FormatLogTo(&log_entry[0], length, timestamp_ms, level, file, line, function, message, message_length);
+        }
+        log_entry.resize(length);
+        return log_entry;
+    }
 
-        // 时间戳
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                      now.time_since_epoch()) %
-                  1000;
-
-        char time_str[64];
-        std::strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S",
-                      std::localtime(&time_t));
-        oss << "[" << time_str << "." << std::setfill('0') << std::setw(3)
-            << ms.count() << "]";
+    size_t FormatLogTo(char* buffer, size_t size, int64_t timestamp_ms, LogLevel level, const char* file,
+                       int line, const char* function, const char* message, size_t message_length) {
+        uint32_t flags = emit_flags_.load(std::memory_order_relaxed);
+        return FormatLogLine(buffer, size, timestamp_ms, level,
+                             (flags & kEmitThreadId) != 0 ? CurrentThreadId() : nullptr,
+                             (flags & kEmitFileInfo) != 0 ? file : nullptr, line, function, message,
+                             message_length);
+    }
 
-        // 日志级别
-        oss << " [" << LevelToString(level) << "]";
+    /**
+     * @brief 把调用线程无锁读取的配置项写入 emit_flags_，调用者需持有 mutex_
+     * Initialize 在 mutex_ 内整体替换 config_，Emit/EmitDeferred 不加锁，只通过 emit_flags_ 读取这些配置
+     */
+    void UpdateEmitFlagsLocked() {
+        uint32_t flags = 0;
+        flags |= config_.deferred_mode && config_.async_mode ? kEmitDeferredAsync : 0;
+        flags |= binary_file_.is_open() ? kEmitBinaryFile : 0;
+        flags |= config_.enable_thread_id ? kEmitThreadId : 0;
+        flags |= config_.enable_file_info ? kEmitFileInfo : 0;
+        emit_flags_.store(flags, std::memory_order_release);
+    }
 
-        // 线程ID
-        if (config_.enable_thread_id) {
-            oss << " [T:" << std::this_thread::get_id() << "]";
+    // 向固定缓冲区追加内容，空间不足时只累加长度
+    struct LineWriter {
+        char* pos;
+        char* end;
+        size_t length;
+
+        void Append(const char* data, size_t count) {
+            if (count <= static_cast<size_t>(end - pos)) {
+                std::memcpy(pos, data, count);
+                pos += count;
+            } else {
+                pos = end;
+            }
+            length += count;
         }
 
-        // 文件信息
-        if (config_.enable_file_info) {
-            std::string filename = ExtractFileName(file);
-            oss << " [" << filename << ":" << line << ":" << function << "]";
+        void Append(const char* str) { Append(str, std::strlen(str)); }
+    };
+
+    /**
+     * @brief 写入 "[YYYY-mm-dd HH:MM:SS.mmm]"
+     * 每个线程缓存当前秒的日期时间前缀，同一秒内只需要填入毫秒；跨秒时使用线程安全的 localtime_r
+     */
+    static void AppendTimestamp(LineWriter& writer, int64_t ms) {
+        struct TimestampCache {
+            std::time_t second = -1;
+            char prefix[32];
+            size_t length = 0;
+        };
+        static thread_local TimestampCache cache;
+
+        std::time_t second = static_cast<std::time_t>(ms / 1000);
+        if (second != cache.second) {
+            std::tm tm_now;
+#if defined(_WIN32)
+            localtime_s(&tm_now, &second);
+#else
+            localtime_r(&second, &tm_now);
+#endif
+            cache.prefix[0] = '[';
+            cache.length = 1 + std::strftime(cache.prefix + 1, sizeof(cache.prefix) - 1, "%Y-%m-%d %H:%M:%S.",
+                                             &tm_now);
+            cache.second = second;
         }
+        int millis = static_cast<int>(ms % 1000);
+        char suffix[5] = {static_cast<char>('0' + millis / 100), static_cast<char>('0' + millis / 10 % 10),
+                          static_cast<char>('0' + millis % 10), ']', '\0'};
+        writer.Append(cache.prefix, cache.length);
+        writer.Append(suffix, 4);
+    }
 
-        // 日志消息
-        oss << " " << message << std::endl;
+    static int64_t CurrentTimeMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
 
-        return oss.str();
+    // 每个线程只格式化一次自己的线程ID
+    static const char* CurrentThreadId() {
+        static thread_local std::string thread_id = [] {
+            std::ostringstream oss;
+            oss << std::this_thread::get_id();
+            return oss.str();
+        }();
+        return thread_id.c_str();
     }
 
-    std::string LevelToString(LogLevel level) {
+    static constexpr const char* LevelToString(LogLevel level) {
         switch (level) {
             case LogLevel::DEBUG:
                 return "DEBUG";
@@ -211,69 +666,224 @@ class Logger {
         }
     }
 
-    std::string ExtractFileName(const char* filepath) {
-        std::string path(filepath);
-        size_t pos = path.find_last_of("/\\");
-        if (pos != std::string::npos) {
-            return path.substr(pos + 1);
+    void WriteLog(const std::string& log_entry) { WriteLog(log_entry.data(), log_entry.size()); }
+
+    // 与 CurrentThreadId 输出相同的数字形式，编码进延迟日志
+    static uint64_t CurrentThreadNumber() {
+        static thread_local uint64_t thread_number = std::strtoull(CurrentThreadId(), nullptr, 10);
+        return thread_number;
+    }
+
+    uint32_t RegisterSite(LogSite& site, const char* format) {
+        std::lock_guard<std::mutex> lock(site_mutex_);
+        uint32_t site_id = site.id.load(std::memory_order_relaxed);
+        if (site_id == 0) {
+            site.format = format;
+            sites_.push_back(&site);
+            site_id = static_cast<uint32_t>(sites_.size());
+            site.id.store(site_id, std::memory_order_release);
+        }
+        return site_id;
+    }
+
+    const LogSite* GetSite(uint32_t site_id) {
+        std::lock_guard<std::mutex> lock(site_mutex_);
+        return site_id > 0 && site_id <= sites_.size() ? sites_[site_id - 1] : nullptr;
+    }
+
+    // 把一条延迟日志格式化为文本追加到 out
+    void AppendDeferredText(std::string& out, const char* record, size_t length) {
+        DeferredHeader header;
+        const char* pos = record;
+        const LogSite* site = ReadDeferredHeader(pos, record + length, header) ? GetSite(header.site_id) : nullptr;
+        if (site == nullptr) {
+            return;
+        }
+        // 同步模式下由各调用线程直接调用，使用线程局部缓冲区
+        static thread_local std::string message;
+        message.clear();
+        FormatDeferredMessage(site->format, pos, record + length - pos, message);
+
+        char thread_id[24];
+        *std::to_chars(thread_id, thread_id + sizeof(thread_id) - 1, header.thread_id).ptr = '\0';
+        size_t offset = out.size();
+        uint32_t flags = emit_flags_.load(std::memory_order_relaxed);
+        auto format_line = [&](size_t size) {
+            return FormatLogLine(&out[offset], size, header.timestamp_ms, site->level,
+                                 (flags & kEmitThreadId) != 0 ? thread_id : nullptr,
+                                 (flags & kEmitFileInfo) != 0 ? site->file : nullptr, site->line, site->function,
+                                 message.data(), message.size());
+        };
+        out.resize(offset + kFormatBufferSize);
+        size_t line_length = format_line(kFormatBufferSize);
+        if (line_length > kFormatBufferSize) {
+            out.resize(offset + line_length);
+            format_line(line_length);
+        }
+        out.resize(offset + line_length);
+    }
+
+    // 打开二进制日志并写入文件头，之后的调用点ID重新编号
+    void OpenBinaryFile() {
+        if (binary_file_.is_open()) {
+            binary_file_.close();
+        }
+        binary_sites_written_.clear();
+        if (config_.binary_log_path.empty()) {
+            return;
+        }
+        binary_file_.open(config_.binary_log_path, std::ios::binary | std::ios::app);
+        if (!binary_file_.is_open()) {
+            std::cerr << "Failed to open binary log file: " << config_.binary_log_path << std::endl;
+            return;
+        }
+        binary_file_.write(kBinaryLogMagic, sizeof(kBinaryLogMagic));
+    }
+
+    /**
+     * @brief 把一批延迟日志写入二进制文件，records 为若干个 u32 长度 + 记录内容
+     * 调用点第一次出现时先写入调用点定义
+     */
+    void WriteBinaryRecords(const std::string& records) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!binary_file_.is_open()) {
+            return;
+        }
+        binary_out_.clear();
+        const char* pos = records.data();
+        const char* end = pos + records.size();
+        const char* record;
+        uint32_t length;
+        while (ReadBinaryString(pos, end, record, length)) {
+            DeferredHeader header;
+            const char* body = record;
+            if (!ReadDeferredHeader(body, record + length, header)) {
+                continue;
+            }
+            if (header.site_id >= binary_sites_written_.size()) {
+                binary_sites_written_.resize(header.site_id + 1, false);
+            }
+            if (!binary_sites_written_[header.site_id]) {
+                const LogSite* site = GetSite(header.site_id);
+                if (site == nullptr) {
+                    continue;
+                }
+                binary_out_.push_back(kBinarySiteRecord);
+                AppendBinary(binary_out_, header.site_id);
+                AppendBinary(binary_out_, static_cast<uint8_t>(site->level));
+                AppendBinary(binary_out_, static_cast<int32_t>(site->line));
+                AppendBinaryString(binary_out_, site->file, std::strlen(site->file));
+                AppendBinaryString(binary_out_, site->function, std::strlen(site->function));
+                AppendBinaryString(binary_out_, site->format, std::strlen(site->format));
+                binary_sites_written_[header.site_id] = true;
+            }
+            binary_out_.push_back(kBinaryEntryRecord);
+            AppendBinaryString(binary_out_, record, length);
         }
-        return path;
+        binary_file_.write(binary_out_.data(), binary_out_.size());
+        binary_file_.flush();
     }
 
-    void WriteLog(const std::string& log_entry) {
+    void WriteLog(const char* log_entry, size_t length) {
         std::lock_guard<std::mutex> lock(mutex_);
 
         // 输出到控制台
         if (config_.enable_console) {
-            std::cout << log_entry;
+            std::cout.write(log_entry, length);
         }
 
         // 输出到文件
         if (config_.enable_file && log_file_.is_open()) {
-            log_file_ << log_entry;
-            log_file_.flush();
+            if (config_.file_flush_policy == FileFlushPolicy::BUFFERED) {
+                file_buffer_.append(log_entry, length);
+                if (file_buffer_.size() >= config_.file_buffer_size || IsFileFlushDue()) {
+                    FlushFileBuffer();
+                }
+            } else {
+                log_file_.write(log_entry, length);
+                log_file_.flush();
+            }
+            file_size_ += length;
 
             // 检查文件大小，进行日志轮转
             CheckAndRotateLog();
         }
     }
 
+    bool IsFileFlushDue() const {
+        return std::chrono::steady_clock::now() - last_file_flush_ >=
+               std::chrono::milliseconds(config_.file_flush_interval_ms);
+    }
+
+    // 把缓冲区中的日志一次性写入文件，调用者需持有 mutex_
+    void FlushFileBuffer() {
+        if (!file_buffer_.empty() && log_file_.is_open()) {
+            log_file_.write(file_buffer_.data(), file_buffer_.size());
+            log_file_.flush();
+        }
+        file_buffer_.clear();
+        last_file_flush_ = std::chrono::steady_clock::now();
+    }
+
+    // 缓冲日志停留超过 file_flush_interval_ms 时写出，由后台线程定期调用
+    void FlushFileBufferIfDue() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!file_buffer_.empty() && IsFileFlushDue()) {
+            FlushFileBuffer();
+        }
+    }
+
+    // 同步模式 + BUFFERED 策略时没有异步线程，由该线程按时间间隔写出缓冲日志
+    void StartFileFlusher() {
+        std::lock_guard<std::mutex> lock(flusher_mutex_);
+        if (flusher_running_) {
+            return;
+        }
+        flusher_running_ = true;
+        flusher_thread_ = std::thread([this]() {
+            auto interval = std::chrono::milliseconds(std::max(config_.file_flush_interval_ms, 1));
+            std::unique_lock<std::mutex> lock(flusher_mutex_);
+            while (flusher_running_) {
+                flusher_cv_.wait_for(lock, interval, [this] { return !flusher_running_; });
+                FlushFileBufferIfDue();
+            }
+        });
+    }
+
+    void StopFileFlusher() {
+        {
+            std::lock_guard<std::mutex> lock(flusher_mutex_);
+            if (!flusher_running_) {
+                return;
+            }
+            flusher_running_ = false;
+        }
+        flusher_cv_.notify_all();
+        if (flusher_thread_.joinable()) {
+            flusher_thread_.join();
+        }
+    }
+
     void CheckAndRotateLog() {
         if (!log_file_.is_open()) {
             return;
         }
 
-        // 获取当前文件大小
-        log_file_.seekp(0, std::ios::end);
-        size_t file_size = log_file_.tellp();
-        log_file_.seekp(0, std::ios::end);
-
-        if (file_size >= config_.max_file_size) {
+        if (file_size_ >= config_.max_file_size) {
+            FlushFileBuffer();
             log_file_.close();
 
-            // 轮转日志文件
-            for (int i = config_.max_backup_files - 1; i > 0; --i) {
-                std::string old_file = config_.log_file_path + "." +
-                                       std::to_string(i);
-                std::string new_file = config_.log_file_path + "." +
-                                       std::to_string(i + 1);
-                std::ifstream src(old_file, std::ios::binary);
-                if (src.is_open()) {
-                    std::ofstream dst(new_file, std::ios::binary);
-                    dst << src.rdbuf();
-                    src.close();
-                    dst.close();
+            if (config_.max_backup_files <= 0) {
+                std::remove(config_.log_file_path.c_str());
+            } else if (config_.compress_rotated && kCompressSupported) {
+                // 只做一次重命名，移位和压缩交给后台线程，不阻塞写日志的线程
+                std::string pending_file = MakePendingFileName();
+                if (std::rename(config_.log_file_path.c_str(), pending_file.c_str()) == 0) {
+                    EnqueueCompressJob({pending_file, config_.log_file_path, config_.max_backup_files});
                 }
-            }
-
-            // 将当前日志文件重命名为 .1
-            std::string backup_file = config_.log_file_path + ".1";
-            std::ifstream src(config_.log_file_path, std::ios::binary);
-            if (src.is_open()) {
-                std::ofstream dst(backup_file, std::ios::binary);
-                dst << src.rdbuf();
-                src.close();
-                dst.close();
+            } else {
+                ShiftBackupFiles(config_.log_file_path, config_.max_backup_files);
+                std::rename(config_.log_file_path.c_str(), (config_.log_file_path + ".1").c_str());
             }
 
             // 重新打开日志文件
@@ -281,86 +891,687 @@ class Logger {
         }
     }
 
+    /**
+     * @brief 待压缩文件名：<日志文件>.pending.<进程号>.<时间戳 ns>.<序号>
+     * 序号在进程重启后从 0 开始，加上进程号和时间戳后不会与上次运行遗留的 pending 文件重名，
+     * 多个进程轮转同一路径时也不会互相覆盖
+     */
+    std::string MakePendingFileName() {
+#if defined(__unix__) || defined(__APPLE__)
+        long pid = static_cast<long>(::getpid());
+#else
+        long pid = 0;
+#endif
+        auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count();
+        return config_.log_file_path + ".pending." + std::to_string(pid) + "." + std::to_string(now_ns) + "." +
+               std::to_string(rotate_seq_++);
+    }
+
+    /**
+     * @brief 备份文件依次后移：.N -> .N+1，.N.gz -> .N+1.gz，超过 max_backup_files 的备份被删除
+     * 只使用 rename，耗时与文件大小无关
+     */
+    static void ShiftBackupFiles(const std::string& path, int max_backup_files) {
+        for (const char* suffix : {"", ".gz"}) {
+            std::remove((path + "." + std::to_string(max_backup_files) + suffix).c_str());
+        }
+        for (int i = max_backup_files - 1; i > 0; --i) {
+            for (const char* suffix : {"", ".gz"}) {
+                std::string old_file = path + "." + std::to_string(i) + suffix;
+                std::string new_file = path + "." + std::to_string(i + 1) + suffix;
+                std::rename(old_file.c_str(), new_file.c_str());
+            }
+        }
+    }
+
+    struct CompressJob {
+        std::string pending_file;  // 轮转时重命名得到的待压缩文件
+        std::string log_file_path;
+        int max_backup_files;
+    };
+
+    void EnqueueCompressJob(CompressJob job) {
+        std::lock_guard<std::mutex> lock(compress_mutex_);
+        compress_jobs_.push_back(std::move(job));
+        if (!compress_thread_.joinable()) {
+            compress_thread_ = std::thread(&Logger::CompressWorkerLoop, this);
+        }
+        compress_cv_.notify_one();
+    }
+
+    // 等待已提交的压缩任务全部完成后退出压缩线程
+    void StopCompressWorker() {
+        {
+            std::lock_guard<std::mutex> lock(compress_mutex_);
+            compress_stop_ = true;
+        }
+        compress_cv_.notify_all();
+        if (compress_thread_.joinable()) {
+            compress_thread_.join();
+        }
+        std::lock_guard<std::mutex> lock(compress_mutex_);
+        compress_stop_ = false;
+    }
+
+    /**
+     * @brief 后台压缩线程：压缩 pending 文件后再移位备份并重命名为 .1.gz
+     * 备份链只由该线程按提交顺序修改，因此不会与前台的轮转互相覆盖
+     */
+    void CompressWorkerLoop() {
+        std::unique_lock<std::mutex> lock(compress_mutex_);
+        while (true) {
+            compress_cv_.wait(lock, [this] { return compress_stop_ || !compress_jobs_.empty(); });
+            if (compress_jobs_.empty()) {
+                break;
+            }
+            CompressJob job = std::move(compress_jobs_.front());
+            compress_jobs_.pop_front();
+            lock.unlock();
+
+            std::string gz_file = job.pending_file + ".gz";
+            ShiftBackupFiles(job.log_file_path, job.max_backup_files);
+            if (CompressFile(job.pending_file, gz_file)) {
+                std::remove(job.pending_file.c_str());
+                std::rename(gz_file.c_str(), (job.log_file_path + ".1.gz").c_str());
+            } else {
+                std::remove(gz_file.c_str());
+                std::rename(job.pending_file.c_str(), (job.log_file_path + ".1").c_str());
+            }
+            lock.lock();
+        }
+    }
+
+#ifdef CLOGGER_HAVE_ZLIB
+    static constexpr bool kCompressSupported = true;
+
+    static bool CompressFile(const std::string& src_file, const std::string& dst_file) {
+        std::ifstream src(src_file, std::ios::binary);
+        gzFile dst = gzopen(dst_file.c_str(), "wb");
+        if (!src.is_open() || dst == nullptr) {
+            if (dst != nullptr) {
+                gzclose(dst);
+            }
+            return false;
+        }
+        std::vector<char> buffer(64 * 1024);
+        bool ok = true;
+        while (ok && src) {
+            src.read(buffer.data(), buffer.size());
+            std::streamsize count = src.gcount();
+            if (count > 0 && gzwrite(dst, buffer.data(), static_cast<unsigned>(count)) != count) {
+                ok = false;
+            }
+        }
+        return gzclose(dst) == Z_OK && ok;
+    }
+#else
+    static constexpr bool kCompressSupported = false;
+
+    static bool CompressFile(const std::string&, const std::string&) { return false; }
+#endif
+
+    // 按当前模式把格式化好的日志交给线程暂存区、异步队列或直接写出
+    void Dispatch(const char* log_entry, size_t length, int64_t timestamp_ms) {
+        if (staging_running_.load(std::memory_order_acquire) && AcquireStaging()) {
+            PushStaging(log_entry, length, timestamp_ms);
+            ReleaseStaging();
+        } else if (AcquireAsyncRing()) {
+            // 异步模式：将日志放入无锁环形队列，async_running_ 只在异步模式下为 true
+            PushAsync(log_entry, length);
+            ReleaseAsyncRing();
+        } else {
+            // 同步模式：直接输出
+            WriteLog(log_entry, length);
+        }
+    }
+
+    /**
+     * @brief 线程局部的暂存区句柄，线程退出时标记暂存区为 closed
+     * epoch 与 staging_epoch_ 不一致说明收集线程已经重启，需要重新注册
+     */
+    struct StagingHandle {
+        std::shared_ptr<ThreadLogBuffer> buffer;
+        uint64_t epoch = 0;
+
+        ~StagingHandle() {
+            if (buffer) {
+                buffer->closed.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    ThreadLogBuffer* CurrentStagingBuffer() {
+        static thread_local StagingHandle handle;
+        uint64_t epoch = staging_epoch_.load(std::memory_order_acquire);
+        if (!handle.buffer || handle.epoch != epoch) {
+            if (handle.buffer) {
+                handle.buffer->closed.store(true, std::memory_order_release);
+            }
+            handle.buffer = std::make_shared<ThreadLogBuffer>(config_.thread_buffer_size);
+            handle.epoch = epoch;
+            std::lock_guard<std::mutex> lock(staging_mutex_);
+            staging_buffers_.push_back(handle.buffer);
+        }
+        return handle.buffer.get();
+    }
+
+    void PushStaging(const char* log_entry, size_t length, int64_t timestamp_ms) {
+        ThreadLogBuffer* buffer = CurrentStagingBuffer();
+        if (!buffer->Fits(length)) {
+            // 超过整个暂存区的日志直接写出
+            WriteLog(log_entry, length);
+            return;
+        }
+        if (buffer->TryPush(timestamp_ms, log_entry, length)) {
+            if (buffer->size() >= buffer->capacity() / 2) {
+                WakeCollector();
+            }
+            return;
+        }
+        switch (config_.overflow_policy) {
+            case OverflowPolicy::BLOCK: {
+                uint64_t wait_start_ns = cMetrics::NowNs();
+                while (!buffer->TryPush(timestamp_ms, log_entry, length)) {
+                    WakeCollector();
+                    std::this_thread::yield();
+                }
+                RecordBlockWait(wait_start_ns);
+                break;
+            }
+            case OverflowPolicy::DROP:
+                break;
+            case OverflowPolicy::DROP_AND_COUNT:
+                dropped_num_.fetch_add(1, std::memory_order_relaxed);
+                break;
+        }
+    }
+
+    void WakeCollector() {
+        if (collector_wake_.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        { std::lock_guard<std::mutex> lock(collector_mutex_); }
+        collector_cv_.notify_one();
+    }
+
+    /**
+     * @brief 写入线程暂存区之前登记，收集线程未运行时返回 false；返回 true 时用完需调用 ReleaseStaging
+     * 与 AcquireAsyncRing 相同：StopCollector 清除 staging_running_ 后等待登记数归零，再做最后一次收集
+     */
+    bool AcquireStaging() {
+        staging_users_.fetch_add(1);
+        if (staging_running_.load()) {
+            return true;
+        }
+        staging_users_.fetch_sub(1);
+        return false;
+    }
+
+    void ReleaseStaging() { staging_users_.fetch_sub(1, std::memory_order_release); }
+
+    void StartCollector() {
+        if (staging_running_.load()) {
+            return;
+        }
+        ++staging_epoch_;
+        staging_running_.store(true, std::memory_order_release);
+        collector_thread_ = std::thread(&Logger::CollectorLoop, this);
+    }
+
+    void StopCollector() {
+        {
+            std::lock_guard<std::mutex> lock(collector_mutex_);
+            if (!staging_running_.exchange(false)) {
+                return;
+            }
+        }
+        collector_cv_.notify_all();
+        collector_done_cv_.notify_all();
+        if (collector_thread_.joinable()) {
+            collector_thread_.join();
+        }
+
+        // 等待仍在写暂存区的线程离开，期间继续收集，BLOCK 策略下等待空间的生产者才能完成写入
+        while (staging_users_.load(std::memory_order_acquire) > 0) {
+            CollectStaging();
+            std::this_thread::yield();
+        }
+        ++staging_epoch_;
+        CollectStaging();
+        std::lock_guard<std::mutex> lock(staging_mutex_);
+        staging_buffers_.clear();
+    }
+
+    /**
+     * @brief 收集线程：每个周期（async_flush_interval_ms）或被唤醒时取出所有暂存区的日志，
+     * 按时间戳合并后一次写出；Flush 通过 flush_requested_gen_ 等待一轮完整的收集。
+     * 合并只在一轮收集内进行，相邻两轮的边界处可能有毫秒级的先后交错
+     */
+    void CollectorLoop() {
+        auto interval = std::chrono::milliseconds(std::max(config_.async_flush_interval_ms, 1));
+        std::unique_lock<std::mutex> lock(collector_mutex_);
+        while (true) {
+            uint64_t generation = flush_requested_gen_;
+            collector_wake_.store(false, std::memory_order_release);
+            lock.unlock();
+            CollectStaging();
+            FlushFileBufferIfDue();
+            lock.lock();
+            flush_done_gen_ = generation;
+            collector_done_cv_.notify_all();
+            if (!staging_running_) {
+                break;
+            }
+            collector_cv_.wait_for(lock, interval, [this, generation] {
+                return !staging_running_ || flush_requested_gen_ != generation || collector_wake_.load();
+            });
+        }
+    }
+
+    void CollectStaging() {
+        std::vector<std::shared_ptr<ThreadLogBuffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(staging_mutex_);
+            buffers = staging_buffers_;
+        }
+        staging_text_.clear();
+        staging_records_.clear();
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            buffers[i]->Drain(staging_text_, staging_records_, static_cast<uint32_t>(i));
+        }
+        if (!staging_records_.empty()) {
+            // 各线程内部已经有序，稳定排序后同一毫秒内保持线程内的先后顺序
+            std::stable_sort(staging_records_.begin(), staging_records_.end(),
+                             [](const ThreadLogBuffer::Record& a, const ThreadLogBuffer::Record& b) {
+                                 return a.timestamp_ms < b.timestamp_ms;
+                             });
+            async_batch_.clear();
+            for (const ThreadLogBuffer::Record& record : staging_records_) {
+                async_batch_.append(&staging_text_[record.offset], record.length);
+            }
+            WriteLog(async_batch_);
+            async_batch_.clear();
+        }
+        ReportDroppedLogs();
+
+        // 线程已经退出且日志已经取完的暂存区可以释放
+        std::lock_guard<std::mutex> lock(staging_mutex_);
+        staging_buffers_.erase(std::remove_if(staging_buffers_.begin(), staging_buffers_.end(),
+                                              [](const std::shared_ptr<ThreadLogBuffer>& buffer) {
+                                                  return buffer->closed.load(std::memory_order_acquire) &&
+                                                         buffer->empty();
+                                              }),
+                               staging_buffers_.end());
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    static void CrashSignalHandler(int sig) {
+        GetInstance().EmergencyFlush();
+        std::signal(sig, SIG_DFL);
+        std::raise(sig);
+    }
+
+    // 只使用 open/write/close，不加锁
+    void EmergencyFlush() {
+        int fd = STDERR_FILENO;
+        if (config_.enable_file) {
+            int file_fd = ::open(config_.log_file_path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+            if (file_fd >= 0) {
+                fd = file_fd;
+            }
+        }
+        auto write_all = [fd](const char* data, size_t length) {
+            while (length > 0) {
+                ssize_t written = ::write(fd, data, length);
+                if (written <= 0) {
+                    break;
+                }
+                data += written;
+                length -= static_cast<size_t>(written);
+            }
+        };
+        write_all(file_buffer_.data(), file_buffer_.size());
+        for (const std::shared_ptr<ThreadLogBuffer>& buffer : staging_buffers_) {
+            buffer->Peek(write_all);
+        }
+        if (fd != STDERR_FILENO) {
+            ::close(fd);
+        }
+    }
+#endif
+
+    void PushAsync(const char* log_entry, size_t length, uint8_t tag = kTextRecordTag) {
+        if (log_ring_->TryPush(log_entry, length, tag)) {
+            // 后台线程按时间间隔批量写出，只有积压超过一半时才提前唤醒
+            if (consumer_sleeping_.load() && log_ring_->size() >= log_ring_->capacity() / 2) {
+                WakeAsyncWorker();
+            }
+            return;
+        }
+        switch (config_.overflow_policy) {
+            case OverflowPolicy::BLOCK: {
+                uint64_t wait_start_ns = cMetrics::NowNs();
+                while (!log_ring_->TryPush(log_entry, length, tag)) {
+                    WakeAsyncWorker();
+                    std::this_thread::yield();
+                }
+                RecordBlockWait(wait_start_ns);
+                break;
+            }
+            case OverflowPolicy::DROP:
+                break;
+            case OverflowPolicy::DROP_AND_COUNT:
+                dropped_num_.fetch_add(1, std::memory_order_relaxed);
+                break;
+        }
+    }
+
+    void RecordBlockWait(uint64_t wait_start_ns) {
+        blocked_num_.Add(1);
+        block_wait_ns_.Record(cMetrics::NowNs() - wait_start_ns);
+    }
+
+    void WakeAsyncWorker() {
+        { std::lock_guard<std::mutex> lock(queue_mutex_); }
+        queue_cv_.notify_one();
+    }
+
+    /**
+     * @brief 访问 log_ring_ 之前登记，异步线程未运行时返回 false；返回 true 时用完需调用 ReleaseAsyncRing
+     * 登记与 async_running_ 都使用顺序一致的读写：StopAsyncWorker 清除 async_running_ 之后，
+     * 要么生产者看到未运行，要么 Stop 看到登记数不为 0 并等待其离开，因此最后一次取出不会遗漏日志，
+     * 之后 StartAsyncWorker 替换 log_ring_ 时也没有线程在访问旧队列
+     */
+    bool AcquireAsyncRing() const {
+        async_ring_users_.fetch_add(1);
+        if (async_running_.load()) {
+            return true;
+        }
+        async_ring_users_.fetch_sub(1);
+        return false;
+    }
+
+    void ReleaseAsyncRing() const { async_ring_users_.fetch_sub(1, std::memory_order_release); }
+
     void StartAsyncWorker() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (async_running_) {
+        if (async_running_.load()) {
             return;
         }
-        async_running_ = true;
+        size_t queue_size = std::max<size_t>(config_.async_queue_size, 2);
+        if (!log_ring_ || log_ring_->capacity() < queue_size || log_ring_->slot_size() != config_.async_slot_size) {
+            log_ring_ = std::make_unique<MpscRingBuffer>(queue_size, config_.async_slot_size);
+        }
+        written_num_.store(log_ring_->GetPoppedCount());
+        async_running_.store(true, std::memory_order_release);
         async_thread_ = std::thread(&Logger::AsyncWorkerLoop, this);
     }
 
     void StopAsyncWorker() {
         {
-            std::lock_guard<std::mutex> lock(mutex_);
-            if (!async_running_) {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            if (!async_running_.exchange(false)) {
                 return;
             }
-            async_running_ = false;
         }
         queue_cv_.notify_all();
+        flush_cv_.notify_all();
         if (async_thread_.joinable()) {
             async_thread_.join();
         }
 
+        // 等待仍在访问队列的线程离开，期间继续取出，BLOCK 策略下等待空间的生产者才能完成入队
+        while (async_ring_users_.load(std::memory_order_acquire) > 0) {
+            if (DrainAsyncQueue() == 0) {
+                std::this_thread::yield();
+            }
+        }
+
         // 处理剩余的日志
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        while (!log_queue_.empty()) {
-            WriteLog(log_queue_.front());
-            log_queue_.pop();
+        while (DrainAsyncQueue() > 0) {
+        }
+    }
+
+    // 一次取出一批日志合并后写出，返回取出的条数
+    size_t DrainAsyncQueue() {
+        bool is_binary = binary_file_.is_open();
+        size_t count = log_ring_->PopBatch(
+            [this, is_binary](const char* data, size_t length, uint8_t tag) {
+                if (tag == kTextRecordTag) {
+                    async_batch_.append(data, length);
+                } else if (is_binary) {
+                    AppendBinaryString(deferred_batch_, data, length);
+                } else {
+                    AppendDeferredText(async_batch_, data, length);
+                }
+            },
+            kAsyncBatchSize);
+        if (count > 0) {
+            if (!async_batch_.empty()) {
+                WriteLog(async_batch_);
+                async_batch_.clear();
+            }
+            if (!deferred_batch_.empty()) {
+                WriteBinaryRecords(deferred_batch_);
+                deferred_batch_.clear();
+            }
+            written_num_.fetch_add(count);
+        }
+        ReportDroppedLogs();
+        return count;
+    }
+
+    // 把新增的丢弃条数作为一条 WARN 日志写出，只由异步线程或收集线程调用
+    void ReportDroppedLogs() {
+        uint64_t dropped_num = dropped_num_.load(std::memory_order_relaxed);
+        if (dropped_num != reported_dropped_num_) {
+            std::string message = "log buffer full, dropped " + std::to_string(dropped_num - reported_dropped_num_) +
+                                  " log entries";
+            reported_dropped_num_ = dropped_num;
+            WriteLog(FormatLog(LogLevel::WARN, CLOGGER_FILE_NAME, __LINE__, __FUNCTION__, message.data(),
+                               message.size()));
         }
     }
 
     void AsyncWorkerLoop() {
+        auto interval = std::chrono::milliseconds(std::max(config_.async_flush_interval_ms, 1));
         while (true) {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            queue_cv_.wait(lock,
-                           [this] { return !log_queue_.empty() || !async_running_; });
+            size_t count = DrainAsyncQueue();
+            if (count > 0 && flush_waiters_.load() > 0) {
+                { std::lock_guard<std::mutex> lock(queue_mutex_); }
+                flush_cv_.notify_all();
+            }
+            if (count == kAsyncBatchSize) {
+                continue;
+            }
 
-            if (!async_running_ && log_queue_.empty()) {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            if (!async_running_) {
                 break;
             }
-
-            while (!log_queue_.empty()) {
-                std::string log_entry = log_queue_.front();
-                log_queue_.pop();
-                lock.unlock();
-                WriteLog(log_entry);
-                lock.lock();
+            if (log_ring_->size() > 0 && flush_waiters_.load() > 0) {
+                continue;
             }
+            consumer_sleeping_.store(true);
+            queue_cv_.wait_for(lock, interval, [this] {
+                return !async_running_ || flush_waiters_.load() > 0 ||
+                       log_ring_->size() >= log_ring_->capacity() / 2;
+            });
+            consumer_sleeping_.store(false);
+            lock.unlock();
+            FlushFileBufferIfDue();
         }
     }
 
+    static constexpr size_t kAsyncBatchSize = 256;
+    static constexpr size_t kFormatBufferSize = 4096;
+    static constexpr uint8_t kTextRecordTag = 0;
+    static constexpr uint8_t kDeferredRecordTag = 1;
+
+    // emit_flags_ 的各位
+    static constexpr uint32_t kEmitDeferredAsync = 1;  // deferred_mode 且 async_mode
+    static constexpr uint32_t kEmitBinaryFile = 2;     // 二进制日志文件已打开
+    static constexpr uint32_t kEmitThreadId = 4;       // enable_thread_id
+    static constexpr uint32_t kEmitFileInfo = 8;       // enable_file_info
+
+    // cMetrics::ShouldSample 的抽样点
+    struct EmitSample {};
+
     mutable std::mutex mutex_;
     std::mutex queue_mutex_;
     std::condition_variable queue_cv_;
+    std::condition_variable flush_cv_;
     LoggerConfig config_;
+    std::atomic<int> min_level_{static_cast<int>(LogLevel::DEBUG)};
+    std::atomic<uint32_t> emit_flags_{kEmitThreadId | kEmitFileInfo};  // 与默认的 LoggerConfig 一致
+    std::mutex module_mutex_;
+    std::deque<LogModule> modules_;
     std::ofstream log_file_;
-    std::queue<std::string> log_queue_;
+    size_t file_size_ = 0;
+    std::string file_buffer_;
+    std::chrono::steady_clock::time_point last_file_flush_;
+    std::thread flusher_thread_;
+    std::mutex flusher_mutex_;
+    std::condition_variable flusher_cv_;
+    bool flusher_running_ = false;
+    int rotate_seq_ = 0;
+    std::mutex compress_mutex_;
+    std::condition_variable compress_cv_;
+    std::deque<CompressJob> compress_jobs_;
+    std::thread compress_thread_;
+    bool compress_stop_ = false;
+    std::unique_ptr<MpscRingBuffer> log_ring_;
+    std::string async_batch_;
+    std::string deferred_batch_;
+    std::mutex site_mutex_;
+    std::vector<LogSite*> sites_;
+    std::ofstream binary_file_;
+    std::string binary_out_;
+    std::vector<bool> binary_sites_written_;
     std::thread async_thread_;
     std::atomic<bool> async_running_{false};
+    mutable std::atomic<int> async_ring_users_{0};  // 正在访问 log_ring_ 的线程数
+    std::atomic<bool> consumer_sleeping_{false};
+    std::atomic<int> flush_waiters_{0};
+    std::atomic<uint64_t> written_num_{0};
+    std::atomic<uint64_t> dropped_num_{0};
+    uint64_t reported_dropped_num_ = 0;
+    std::mutex staging_mutex_;
+    std::vector<std::shared_ptr<ThreadLogBuffer>> staging_buffers_;
+    std::atomic<uint64_t> staging_epoch_{0};
+    std::atomic<bool> staging_running_{false};
+    std::atomic<int> staging_users_{0};  // 正在写线程暂存区的线程数
+    std::string staging_text_;
+    std::vector<ThreadLogBuffer::Record> staging_records_;
+    std::thread collector_thread_;
+    std::mutex collector_mutex_;
+    std::condition_variable collector_cv_;
+    std::condition_variable collector_done_cv_;
+    std::atomic<bool> collector_wake_{false};
+    uint64_t flush_requested_gen_ = 0;
+    uint64_t flush_done_gen_ = 0;
+    cMetrics::Counter logged_num_;
+    cMetrics::Counter blocked_num_;
+    cMetrics::Histogram emit_ns_;
+    cMetrics::Histogram block_wait_ns_;
+    // 放在最后，最先析构，注销之后不会再有采集函数访问其他成员
+    cMetrics::Registration metrics_registration_;
 };
 
+/**
+ * 编译期最小日志级别（LogLevel 的数值），低于该级别的 LOG_* / LOGM_* / LOGF_* 宏展开为空语句，
+ * 参数不会被求值也不会产生任何代码；FATAL 始终保留。例如 -DCLOGGER_MIN_LEVEL=1 去掉所有 DEBUG 日志
+ */
+#ifndef CLOGGER_MIN_LEVEL
+#define CLOGGER_MIN_LEVEL 0
+#endif
+
+#define CLOGGER_DISCARD() \
+    do {                  \
+    } while (0)
+
+// 先做无锁的级别检查，通过后才求值 message
+#define CLOGGER_LOG(level, message)                                                       \
+    do {                                                                                  \
+        cLogger::Logger& clogger_logger = cLogger::Logger::GetInstance();                 \
+        if (clogger_logger.IsEnabled(level)) {                                            \
+            clogger_logger.Emit(level, CLOGGER_FILE_NAME, __LINE__, __FUNCTION__, message); \
+        }                                                                                 \
+    } while (0)
+
+// 只接受字符串字面量："" name 的拼接对变量无法编译，非字面量的模块名会在这里报错
+#define CLOGGER_MODULE_LITERAL(module_name) ("" module_name)
+
+// 按模块过滤：LOGM_DEBUG("net", "connected")，模块级别通过 SetModuleLevel 设置
+// 每个调用点把第一次解析到的模块缓存在静态变量中，因此 module_name 必须是字符串字面量；
+// 运行时才确定的模块名请用 GetModule 取得模块后调用 IsEnabled(level, module) 与 Emit
+#define CLOGGER_LOGM(module_name, level, message)                                                          \
+    do {                                                                                                   \
+        static_assert(sizeof(CLOGGER_MODULE_LITERAL(module_name)) > 1,                                     \
+                      "LOGM_* 的模块名必须是非空的字符串字面量");                                          \
+        cLogger::Logger& clogger_logger = cLogger::Logger::GetInstance();                                  \
+        static cLogger::LogModule& clogger_module =                                                        \
+            clogger_logger.GetModule(CLOGGER_MODULE_LITERAL(module_name));                                 \
+        if (clogger_logger.IsEnabled(level, clogger_module)) {                                             \
+            clogger_logger.Emit(level, CLOGGER_FILE_NAME, __LINE__, __FUNCTION__, message);                \
+        }                                                                                                  \
+    } while (0)
+
+// 延迟格式化日志：LOGF_INFO("user {} login from {}", user_id, ip)
+#define CLOGGER_LOGF(level, ...)                                                              \
+    do {                                                                                      \
+        static cLogger::LogSite clogger_site{level, CLOGGER_FILE_NAME, __LINE__, __FUNCTION__}; \
+        cLogger::Logger& clogger_logger = cLogger::Logger::GetInstance();                     \
+        if (clogger_logger.IsEnabled(level)) {                                                \
+            clogger_logger.EmitDeferred(clogger_site, __VA_ARGS__);                           \
+        }                                                                                     \
+    } while (0)
+
 // 便捷宏定义
-#define LOG_DEBUG(message) \
-    cLogger::Logger::GetInstance().Log( \
-        cLogger::LogLevel::DEBUG, __FILE__, __LINE__, __FUNCTION__, message)
+#if CLOGGER_MIN_LEVEL <= 0
+#define LOG_DEBUG(message) CLOGGER_LOG(cLogger::LogLevel::DEBUG, message)
+#define LOGM_DEBUG(module_name, message) CLOGGER_LOGM(module_name, cLogger::LogLevel::DEBUG, message)
+#define LOGF_DEBUG(...) CLOGGER_LOGF(cLogger::LogLevel::DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(message) CLOGGER_DISCARD()
+#define LOGM_DEBUG(module_name, message) CLOGGER_DISCARD()
+#define LOGF_DEBUG(...) CLOGGER_DISCARD()
+#endif
 
-#define LOG_INFO(message) \
-    cLogger::Logger::GetInstance().Log( \
-        cLogger::LogLevel::INFO, __FILE__, __LINE__, __FUNCTION__, message)
+#if CLOGGER_MIN_LEVEL <= 1
+#define LOG_INFO(message) CLOGGER_LOG(cLogger::LogLevel::INFO, message)
+#define LOGM_INFO(module_name, message) CLOGGER_LOGM(module_name, cLogger::LogLevel::INFO, message)
+#define LOGF_INFO(...) CLOGGER_LOGF(cLogger::LogLevel::INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(message) CLOGGER_DISCARD()
+#define LOGM_INFO(module_name, message) CLOGGER_DISCARD()
+#define LOGF_INFO(...) CLOGGER_DISCARD()
+#endif
 
-#define LOG_WARN(message) \
-    cLogger::Logger::GetInstance().Log( \
-        cLogger::LogLevel::WARN, __FILE__, __LINE__, __FUNCTION__, message)
+#if CLOGGER_MIN_LEVEL <= 2
+#define LOG_WARN(message) CLOGGER_LOG(cLogger::LogLevel::WARN, message)
+#define LOGM_WARN(module_name, message) CLOGGER_LOGM(module_name, cLogger::LogLevel::WARN, message)
+#define LOGF_WARN(...) CLOGGER_LOGF(cLogger::LogLevel::WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(message) CLOGGER_DISCARD()
+#define LOGM_WARN(module_name, message) CLOGGER_DISCARD()
+#define LOGF_WARN(...) CLOGGER_DISCARD()
+#endif
 
-#define LOG_ERROR(message) \
-    cLogger::Logger::GetInstance().Log( \
-        cLogger::LogLevel::ERROR, __FILE__, __LINE__, __FUNCTION__, message)
+#if CLOGGER_MIN_LEVEL <= 3
+#define LOG_ERROR(message) CLOGGER_LOG(cLogger::LogLevel::ERROR, message)
+#define LOGM_ERROR(module_name, message) CLOGGER_LOGM(module_name, cLogger::LogLevel::ERROR, message)
+#define LOGF_ERROR(...) CLOGGER_LOGF(cLogger::LogLevel::ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(message) CLOGGER_DISCARD()
+#define LOGM_ERROR(module_name, message) CLOGGER_DISCARD()
+#define LOGF_ERROR(...) CLOGGER_DISCARD()
+#endif
 
-#define LOG_FATAL(message) \
-    cLogger::Logger::GetInstance().Log( \
-        cLogger::LogLevel::FATAL, __FILE__, __LINE__, __FUNCTION__, message)
+#define LOG_FATAL(message) CLOGGER_LOG(cLogger::LogLevel::FATAL, message)
+#define LOGM_FATAL(module_name, message) CLOGGER_LOGM(module_name, cLogger::LogLevel::FATAL, message)
+#define LOGF_FATAL(...) CLOGGER_LOGF(cLogger::LogLevel::FATAL, __VA_ARGS__)
 
 }  // namespace cLogger
 
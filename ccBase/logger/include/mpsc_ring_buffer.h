@@ -0,0 +1,135 @@
+#ifndef __MPSC_RING_BUFFER__
+#define __MPSC_RING_BUFFER__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace cLogger {
+
+/**
+ * @brief 有界无锁多生产者单消费者环形缓冲区，用于异步日志
+ *
+ * 槽位数为 2 的幂，每个槽位带一个序号（Vyukov 有界队列）：生产者通过 CAS 抢占写位置，
+ * 写完数据后发布序号；消费者按顺序读取已发布的槽位，读完后把序号推进一圈归还给生产者。
+ * 每个槽位在构造时预分配 slot_size 字节，不超过该长度的日志直接拷贝进槽位，入队出队不分配内存；
+ * 超长日志存放在槽位的 overflow 字符串中
+ */
+class MpscRingBuffer {
+   public:
+    MpscRingBuffer(size_t capacity, size_t slot_size) : slot_size_(slot_size) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        slots_.reset(new Slot[size]);
+        data_.reset(new char[size * slot_size_]);
+        for (size_t i = 0; i < size; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRingBuffer(const MpscRingBuffer&) = delete;
+    MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+    /**
+     * @brief 写入一条日志，缓冲区已满时立即返回 false
+     * tag 由使用者定义，随数据一起交给消费者，用于区分不同类型的记录
+     * 可被多个线程同时调用
+     */
+    bool TryPush(const char* data, size_t length, uint8_t tag = 0) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->length = length;
+        slot->tag = tag;
+        if (length <= slot_size_) {
+            std::memcpy(&data_[(pos & mask_) * slot_size_], data, length);
+        } else {
+            slot->overflow.assign(data, length);
+        }
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 依次取出最多 max_count 条已发布的日志，对每条调用 consume(data, length, tag)
+     * 只能由唯一的消费者线程调用
+     * @return 取出的日志条数
+     */
+    template <typename Consume>
+    size_t PopBatch(Consume&& consume, size_t max_count) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        size_t count = 0;
+        while (count < max_count) {
+            Slot& slot = slots_[pos & mask_];
+            if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+            if (slot.length <= slot_size_) {
+                consume(&data_[(pos & mask_) * slot_size_], slot.length, slot.tag);
+            } else {
+                consume(slot.overflow.data(), slot.length, slot.tag);
+                slot.overflow.clear();
+            }
+            slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+            ++pos;
+            ++count;
+        }
+        dequeue_pos_.store(pos, std::memory_order_relaxed);
+        return count;
+    }
+
+    // 已被生产者占用的写位置总数（包括尚未发布的槽位）
+    uint64_t GetPushedCount() const { return enqueue_pos_.load(std::memory_order_relaxed); }
+
+    // 已被消费者取出的日志总数
+    uint64_t GetPoppedCount() const { return dequeue_pos_.load(std::memory_order_relaxed); }
+
+    // 当前缓冲区中的日志条数（近似值）
+    size_t size() const {
+        size_t pushed = enqueue_pos_.load(std::memory_order_relaxed);
+        size_t popped = dequeue_pos_.load(std::memory_order_relaxed);
+        return pushed > popped ? pushed - popped : 0;
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    size_t slot_size() const { return slot_size_; }
+
+   private:
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        size_t length = 0;
+        uint8_t tag = 0;
+        std::string overflow;
+    };
+
+    size_t mask_ = 0;
+    size_t slot_size_ = 0;
+    std::unique_ptr<Slot[]> slots_;
+    std::unique_ptr<char[]> data_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+};
+
+}  // namespace cLogger
+
+#endif  // __MPSC_RING_BUFFER__
@@ -0,0 +1,147 @@
+#ifndef __THREAD_LOG_BUFFER__
+#define __THREAD_LOG_BUFFER__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cLogger {
+
+/**
+ * @brief 单个线程独占的日志暂存区：单生产者单消费者的字节环形缓冲区
+ *
+ * 每条记录为 u32 长度 + i64 时间戳（毫秒） + 已格式化的日志内容，生产者只写 tail_，收集线程只写 head_，
+ * 两个位置各占一个缓存行，不同线程之间没有共享写入。容量固定，满时由调用者按溢出策略处理，内存有上界
+ */
+class ThreadLogBuffer {
+   public:
+    static constexpr size_t kRecordHeaderSize = sizeof(uint32_t) + sizeof(int64_t);
+
+    /**
+     * @brief 收集时取出的一条记录，内容位于 Drain 的输出字符串中
+     */
+    struct Record {
+        int64_t timestamp_ms;
+        uint32_t source;  // 记录来自第几个暂存区，时间戳相同时保持各线程内部的顺序
+        size_t offset;
+        size_t length;
+    };
+
+    explicit ThreadLogBuffer(size_t capacity) {
+        size_t size = 1024;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        data_.reset(new char[size]);
+    }
+
+    ThreadLogBuffer(const ThreadLogBuffer&) = delete;
+    ThreadLogBuffer& operator=(const ThreadLogBuffer&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // 单条记录能否放入暂存区
+    bool Fits(size_t length) const { return kRecordHeaderSize + length <= capacity(); }
+
+    /**
+     * @brief 追加一条日志，剩余空间不足时返回 false，只能由所属线程调用
+     */
+    bool TryPush(int64_t timestamp_ms, const char* data, size_t length) {
+        size_t need = kRecordHeaderSize + length;
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+        if (capacity() - (tail - head) < need) {
+            return false;
+        }
+        uint32_t record_length = static_cast<uint32_t>(length);
+        CopyIn(tail, &record_length, sizeof(record_length));
+        CopyIn(tail + sizeof(record_length), &timestamp_ms, sizeof(timestamp_ms));
+        CopyIn(tail + kRecordHeaderSize, data, length);
+        tail_.store(tail + need, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 取出全部已写入的记录，内容追加到 out，位置信息追加到 records，只能由收集线程调用
+     * @return 取出的记录条数
+     */
+    size_t Drain(std::string& out, std::vector<Record>& records, uint32_t source) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t count = 0;
+        while (head < tail) {
+            uint32_t length;
+            int64_t timestamp_ms;
+            CopyOut(head, &length, sizeof(length));
+            CopyOut(head + sizeof(length), &timestamp_ms, sizeof(timestamp_ms));
+            size_t offset = out.size();
+            out.resize(offset + length);
+            CopyOut(head + kRecordHeaderSize, &out[offset], length);
+            records.push_back({timestamp_ms, source, offset, length});
+            head += kRecordHeaderSize + length;
+            ++count;
+        }
+        head_.store(head, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief 崩溃时使用：不修改读位置，依次对尚未取出的日志内容调用 write(data, length)
+     * 只读取数据，可以在信号处理函数中调用
+     */
+    template <typename Write>
+    void Peek(Write&& write) const {
+        size_t head = head_.load(std::memory_order_acquire);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        while (head < tail) {
+            uint32_t length;
+            CopyOut(head, &length, sizeof(length));
+            size_t begin = (head + kRecordHeaderSize) & mask_;
+            size_t first = length < capacity() - begin ? length : capacity() - begin;
+            write(&data_[begin], first);
+            if (first < length) {
+                write(&data_[0], length - first);
+            }
+            head += kRecordHeaderSize + length;
+        }
+    }
+
+    // 尚未取出的字节数（近似值）
+    size_t size() const { return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_relaxed); }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    // 所属线程退出后置为 true，收集线程取完剩余日志后释放暂存区
+    std::atomic<bool> closed{false};
+
+   private:
+    void CopyIn(size_t pos, const void* src, size_t length) {
+        size_t begin = pos & mask_;
+        size_t first = length < capacity() - begin ? length : capacity() - begin;
+        std::memcpy(&data_[begin], src, first);
+        std::memcpy(&data_[0], static_cast<const char*>(src) + first, length - first);
+    }
+
+    void CopyOut(size_t pos, void* dst, size_t length) const {
+        size_t begin = pos & mask_;
+        size_t first = length < capacity() - begin ? length : capacity() - begin;
+        std::memcpy(dst, &data_[begin], first);
+        std::memcpy(static_cast<char*>(dst) + first, &data_[0], length - first);
+    }
+
+    size_t mask_ = 0;
+    std::unique_ptr<char[]> data_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
+
+}  // namespace cLogger
+
+#endif  // __THREAD_LOG_BUFFER__
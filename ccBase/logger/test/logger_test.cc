@@ -1,6 +1,13 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <string>
 #include <thread>
 #include <vector>
+#include "log_decoder.h"
 #include "logger.h"
 
 using namespace cLogger;
@@ -122,6 +129,86 @@ void TestAsyncLogging() {
     cout << "异步日志写入完成" << endl;
 }
 
+// 统计文件行数，用于检查异步日志是否完整写出
+size_t CountFileLines(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    size_t count = 0;
+    while (std::getline(file, line)) {
+        ++count;
+    }
+    return count;
+}
+
+void TestAsyncOverflowPolicy() {
+    cout << "\n========== 测试8: 异步队列溢出策略 ==========" << endl;
+
+    const int num_threads = 8;
+    const int logs_per_thread = 2000;
+    auto run_producers = [num_threads, logs_per_thread]() {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < num_threads; ++i) {
+            threads.emplace_back([i, logs_per_thread]() {
+                for (int j = 0; j < logs_per_thread; ++j) {
+                    LOG_INFO("线程 " + std::to_string(i) + " 异步日志 " + std::to_string(j));
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    };
+
+    // BLOCK：队列很小，生产者需要等待，但不丢日志
+    std::remove("async_block.log");
+    LoggerConfig config;
+    config.min_level = LogLevel::INFO;
+    config.enable_console = false;
+    config.enable_file = true;
+    config.log_file_path = "async_block.log";
+    config.max_file_size = 64 * 1024 * 1024;
+    config.async_mode = true;
+    config.async_queue_size = 64;
+    config.async_slot_size = 64;  // 部分日志超过槽位长度
+    config.overflow_policy = OverflowPolicy::BLOCK;
+    Logger::GetInstance().Initialize(config);
+    run_producers();
+    Logger::GetInstance().Flush();
+    size_t lines = CountFileLines("async_block.log");
+    cout << "BLOCK 策略写出 " << lines << " / " << num_threads * logs_per_thread << " 条日志" << endl;
+
+    // DROP_AND_COUNT：队列满时丢弃并计数
+    std::remove("async_drop.log");
+    config.log_file_path = "async_drop.log";
+    config.overflow_policy = OverflowPolicy::DROP_AND_COUNT;
+    config.async_flush_interval_ms = 50;
+    Logger::GetInstance().Initialize(config);
+    uint64_t dropped_before = Logger::GetInstance().GetDroppedCount();
+    run_producers();
+    Logger::GetInstance().Flush();
+    uint64_t dropped = Logger::GetInstance().GetDroppedCount() - dropped_before;
+    cout << "DROP_AND_COUNT 策略丢弃 " << dropped << " 条日志" << endl;
+    Logger::GetInstance().Initialize(LoggerConfig());
+    lines = CountFileLines("async_drop.log");
+    cout << "写出 " << lines << " 条（含丢弃统计）" << endl;
+
+    // 生产者写日志期间反复重新初始化并改变队列大小：旧队列中的日志在替换前全部写出
+    std::remove("async_reinit.log");
+    config.log_file_path = "async_reinit.log";
+    config.overflow_policy = OverflowPolicy::BLOCK;
+    Logger::GetInstance().Initialize(config);
+    std::thread producers(run_producers);
+    for (int i = 0; i < 20; ++i) {
+        config.async_queue_size = (i % 2 == 0) ? 256 : 64;
+        Logger::GetInstance().Initialize(config);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    producers.join();
+    Logger::GetInstance().Initialize(LoggerConfig());
+    lines = CountFileLines("async_reinit.log");
+    cout << "重新初始化期间写出 " << lines << " / " << num_threads * logs_per_thread << " 条日志" << endl;
+}
+
 void TestFormatting() {
     cout << "\n========== 测试6: 日志格式化 ==========" << endl;
 
@@ -160,6 +247,293 @@ void TestWithoutFileInfo() {
     Logger::GetInstance().Flush();
 }
 
+void TestBufferedFileLogging() {
+    cout << "\n========== 测试9: 缓冲文件输出 ==========" << endl;
+
+    std::remove("buffered.log");
+    LoggerConfig config;
+    config.min_level = LogLevel::INFO;
+    config.enable_console = false;
+    config.enable_file = true;
+    config.log_file_path = "buffered.log";
+    config.max_file_size = 64 * 1024 * 1024;
+    config.file_flush_policy = FileFlushPolicy::BUFFERED;
+    config.file_buffer_size = 1024 * 1024;
+    config.file_flush_interval_ms = 200;
+    Logger::GetInstance().Initialize(config);
+
+    for (int i = 0; i < 50; ++i) {
+        LOG_INFO("缓冲日志 " + std::to_string(i));
+    }
+    cout << "写入 50 条后文件行数: " << CountFileLines("buffered.log") << endl;
+    LOG_FATAL("FATAL 日志立即写出");
+    cout << "FATAL 之后文件行数: " << CountFileLines("buffered.log") << endl;
+    for (int i = 0; i < 10; ++i) {
+        LOG_INFO("缓冲日志 " + std::to_string(i));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    cout << "超过刷新间隔后文件行数: " << CountFileLines("buffered.log") << endl;
+    Logger::GetInstance().Initialize(LoggerConfig());
+}
+
+bool FileExists(const std::string& path) {
+    std::ifstream file(path);
+    return file.is_open();
+}
+
+void TestRotation() {
+    cout << "\n========== 测试10: 日志轮转 ==========" << endl;
+
+    for (bool compress : {false, true}) {
+        std::string path = compress ? "rotate_gz.log" : "rotate.log";
+        for (int i = 1; i <= 4; ++i) {
+            std::remove((path + "." + std::to_string(i)).c_str());
+            std::remove((path + "." + std::to_string(i) + ".gz").c_str());
+        }
+        std::remove(path.c_str());
+
+        LoggerConfig config;
+        config.min_level = LogLevel::INFO;
+        config.enable_console = false;
+        config.enable_file = true;
+        config.log_file_path = path;
+        config.max_file_size = 4 * 1024;
+        config.max_backup_files = 3;
+        config.compress_rotated = compress;
+        Logger::GetInstance().Initialize(config);
+        for (int i = 0; i < 500; ++i) {
+            LOG_INFO("轮转日志 " + std::to_string(i));
+        }
+        Logger::GetInstance().Flush();
+        Logger::GetInstance().WaitForCompression();
+
+        std::string suffix = compress ? ".gz" : "";
+        cout << path << " 当前文件行数: " << CountFileLines(path) << "，备份:";
+        for (int i = 1; i <= 4; ++i) {
+            std::string backup = path + "." + std::to_string(i) + suffix;
+            cout << " " << backup << (FileExists(backup) ? "(有)" : "(无)");
+        }
+        cout << endl;
+    }
+    Logger::GetInstance().Initialize(LoggerConfig());
+}
+
+void TestFormattingPerformance() {
+    cout << "\n========== 测试11: 格式化性能 ==========" << endl;
+
+    LoggerConfig config;
+    config.min_level = LogLevel::INFO;
+    config.enable_console = false;
+    config.enable_file = false;
+    Logger::GetInstance().Initialize(config);
+
+    const int count = 200000;
+    const std::string message = "perf";
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        LOG_INFO(message);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    cout << "平均每条日志耗时: " << elapsed.count() / count << " ns" << endl;
+    Logger::GetInstance().Initialize(LoggerConfig());
+}
+
+void TestDeferredLogging() {
+    cout << "\n========== 测试12: 延迟格式化与二进制日志 ==========" << endl;
+
+    const int num_threads = 4;
+    const int logs_per_thread = 1000;
+    auto run_producers = [num_threads, logs_per_thread]() {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < num_threads; ++i) {
+            threads.emplace_back([i, logs_per_thread]() {
+                for (int j = 0; j < logs_per_thread; ++j) {
+                    LOGF_INFO("线程 {} 第 {} 条，耗时 {} ms，成功 {}，用户 {}", i, j, 1.5, true, std::string("bob"));
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    };
+
+    // 文本模式：在异步线程格式化
+    std::remove("deferred.log");
+    LoggerConfig config;
+    config.min_level = LogLevel::INFO;
+    config.enable_console = false;
+    config.enable_file = true;
+    config.log_file_path = "deferred.log";
+    config.max_file_size = 64 * 1024 * 1024;
+    config.async_mode = true;
+    config.deferred_mode = true;
+    Logger::GetInstance().Initialize(config);
+    run_producers();
+    LOGF_INFO("字符串参数 {} 和指针 {}", "text", static_cast<void*>(nullptr));
+    Logger::GetInstance().Flush();
+    cout << "文本延迟日志行数: " << CountFileLines("deferred.log") << endl;
+
+    // 同步模式：各调用线程自己格式化，互不干扰
+    std::remove("deferred_sync.log");
+    LoggerConfig sync_config = config;
+    sync_config.log_file_path = "deferred_sync.log";
+    sync_config.async_mode = false;
+    Logger::GetInstance().Initialize(sync_config);
+    run_producers();
+    Logger::GetInstance().Flush();
+    size_t complete_lines = 0;
+    {
+        std::ifstream sync_file("deferred_sync.log");
+        std::string line;
+        while (std::getline(sync_file, line)) {
+            complete_lines += line.find("成功 true，用户 bob") != std::string::npos ? 1 : 0;
+        }
+    }
+    cout << "同步延迟日志完整行数: " << complete_lines << "（期望 " << num_threads * logs_per_thread << "）" << endl;
+
+    // 二进制模式：异步线程直接写二进制记录，解码后与文本格式相同
+    std::remove("deferred.bin");
+    config.binary_log_path = "deferred.bin";
+    Logger::GetInstance().Initialize(config);
+    run_producers();
+    Logger::GetInstance().Initialize(LoggerConfig());
+
+    std::ifstream in("deferred.bin", std::ios::binary);
+    std::ostringstream out;
+    size_t count = DecodeBinaryLog(in, out);
+    std::string text = out.str();
+    cout << "二进制日志解码条数: " << count << endl;
+    cout << "第一条: " << text.substr(0, text.find('\n')) << endl;
+}
+
+int g_message_eval_count = 0;
+
+std::string CountedMessage(const std::string& text) {
+    g_message_eval_count++;
+    return text;
+}
+
+void TestLevelCheckAndModules() {
+    cout << "\n========== 测试13: 级别检查与模块级别 ==========" << endl;
+
+    std::remove("module.log");
+    LoggerConfig config;
+    config.min_level = LogLevel::INFO;
+    config.enable_console = false;
+    config.enable_file = true;
+    config.log_file_path = "module.log";
+    Logger::GetInstance().Initialize(config);
+
+    // 被过滤的日志不会求值参数
+    g_message_eval_count = 0;
+    for (int i = 0; i < 100; ++i) {
+        LOG_DEBUG(CountedMessage("不会输出"));
+        LOGF_DEBUG("不会输出 {}", CountedMessage("参数"));
+    }
+    LOG_INFO(CountedMessage("会输出"));
+    cout << "参数求值次数: " << g_message_eval_count << "（期望 1）" << endl;
+
+    // 模块级别覆盖全局级别
+    Logger::GetInstance().SetModuleLevel("net", LogLevel::DEBUG);
+    Logger::GetInstance().SetModuleLevel("db", LogLevel::ERROR);
+    LOGM_DEBUG("net", "net debug 会输出");
+    LOGM_WARN("db", "db warn 不会输出");
+    LOGM_ERROR("db", "db error 会输出");
+    LOGM_INFO("cache", "cache 使用全局级别，会输出");
+    LOGM_DEBUG("cache", "cache debug 不会输出");
+    Logger::GetInstance().ResetModuleLevel("net");
+    LOGM_DEBUG("net", "恢复全局级别后不会输出");
+    Logger::GetInstance().SetLevel(LogLevel::ERROR);
+    LOG_WARN("全局级别调整为 ERROR 后不会输出");
+    // 运行时才确定的模块名不能用 LOGM_*（只接受字面量），先取得模块再检查级别
+    std::string runtime_module = std::string("d") + "b";
+    LogModule& module = Logger::GetInstance().GetModule(runtime_module);
+    if (Logger::GetInstance().IsEnabled(LogLevel::ERROR, module)) {
+        Logger::GetInstance().Emit(LogLevel::ERROR, __FILE__, __LINE__, __FUNCTION__, "运行时模块名 db error 会输出");
+    }
+    Logger::GetInstance().Flush();
+    cout << "模块日志行数: " << CountFileLines("module.log") << "（期望 5）" << endl;
+    Logger::GetInstance().Initialize(LoggerConfig());
+}
+
+void TestPerThreadBuffer() {
+    cout << "\n========== 测试14: 线程暂存区合并 ==========" << endl;
+
+    const int num_threads = 8;
+    const int logs_per_thread = 2000;
+    std::remove("staging.log");
+    LoggerConfig config;
+    config.enable_console = false;
+    config.enable_file = true;
+    config.log_file_path = "staging.log";
+    config.per_thread_buffer = true;
+    config.thread_buffer_size = 16 * 1024;
+    Logger::GetInstance().Initialize(config);
+
+    // 线程退出后其暂存区中剩余的日志仍会被收集线程写出
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([i]() {
+            for (int j = 0; j < logs_per_thread; ++j) {
+                LOG_INFO("线程 " + std::to_string(i) + " 日志 " + std::to_string(j));
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    Logger::GetInstance().Flush();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    cout << "写入 " << CountFileLines("staging.log") << " / " << num_threads * logs_per_thread
+         << " 行，耗时 " << duration.count() << " ms" << endl;
+
+    // 写日志期间反复重新初始化：StopCollector 等待正在写暂存区的线程离开后再做最后一次收集
+    std::remove("staging_reinit.log");
+    config.log_file_path = "staging_reinit.log";
+    config.overflow_policy = OverflowPolicy::BLOCK;
+    Logger::GetInstance().Initialize(config);
+    std::atomic<bool> producing{true};
+    threads.clear();
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([i]() {
+            for (int j = 0; j < logs_per_thread; ++j) {
+                LOG_INFO("重新初始化 线程 " + std::to_string(i) + " 日志 " + std::to_string(j));
+            }
+        });
+    }
+    std::thread reinit([&config, &producing]() {
+        while (producing.load()) {
+            Logger::GetInstance().Initialize(config);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    for (auto& t : threads) {
+        t.join();
+    }
+    producing.store(false);
+    reinit.join();
+    Logger::GetInstance().Flush();
+    cout << "重新初始化期间写出 " << CountFileLines("staging_reinit.log") << " 行（期望 "
+         << num_threads * logs_per_thread << "）" << endl;
+
+    // 暂存区很小且丢弃时计数
+    std::remove("staging_drop.log");
+    config.log_file_path = "staging_drop.log";
+    config.thread_buffer_size = 1024;
+    config.async_flush_interval_ms = 100;
+    config.overflow_policy = OverflowPolicy::DROP_AND_COUNT;
+    Logger::GetInstance().Initialize(config);
+    uint64_t dropped_before = Logger::GetInstance().GetDroppedCount();
+    for (int j = 0; j < 1000; ++j) {
+        LOG_INFO("小暂存区日志 " + std::to_string(j));
+    }
+    Logger::GetInstance().Flush();
+    cout << "丢弃 " << Logger::GetInstance().GetDroppedCount() - dropped_before << " 条" << endl;
+    Logger::GetInstance().Initialize(LoggerConfig());
+}
+
 int main() {
     cout << "========================================" << endl;
     cout << "    日志模块测试程序" << endl;
@@ -173,6 +547,13 @@ int main() {
         TestAsyncLogging();
         TestFormatting();
         TestWithoutFileInfo();
+        TestAsyncOverflowPolicy();
+        TestBufferedFileLogging();
+        TestRotation();
+        TestFormattingPerformance();
+        TestDeferredLogging();
+        TestLevelCheckAndModules();
+        TestPerThreadBuffer();
 
         cout << "\n========================================" << endl;
         cout << "    所有测试完成！" << endl;
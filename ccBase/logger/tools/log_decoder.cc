@@ -0,0 +1,29 @@
+// 二进制日志解码工具：log_decoder <binary_log> [output]，不指定输出文件时输出到标准输出
+
+#include <fstream>
+#include <iostream>
+
+#include "log_decoder.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <binary_log> [output]" << std::endl;
+        return 1;
+    }
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Failed to open binary log file: " << argv[1] << std::endl;
+        return 1;
+    }
+    std::ofstream file;
+    if (argc > 2) {
+        file.open(argv[2]);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open output file: " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+    size_t count = cLogger::DecodeBinaryLog(in, argc > 2 ? file : std::cout);
+    std::cerr << "decoded " << count << " log entries" << std::endl;
+    return 0;
+}
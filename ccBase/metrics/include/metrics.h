@@ -0,0 +1,435 @@
+#ifndef __METRICS__
+#define __METRICS__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cMetrics {
+
+/**
+ * @brief 单调时钟的当前时间（纳秒）
+ */
+inline uint64_t NowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+/**
+ * @brief 当前线程使用的分片下标，线程第一次调用时按顺序分配
+ */
+inline size_t ThreadStripe() {
+    static std::atomic<size_t> next_stripe{0};
+    static thread_local size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed);
+    return stripe;
+}
+
+/**
+ * @brief 单调递增计数器
+ * 按线程分散到多个独占缓存行的分片上，多个线程同时计数时不争用同一个缓存行；读取时求和
+ */
+class Counter {
+   public:
+    static constexpr size_t kStripes = 8;
+
+    void Add(uint64_t value = 1) {
+        cells_[ThreadStripe() & (kStripes - 1)].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t Value() const {
+        uint64_t total = 0;
+        for (const Cell& cell : cells_) {
+            total += cell.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    void Reset() {
+        for (Cell& cell : cells_) {
+            cell.value.store(0, std::memory_order_relaxed);
+        }
+    }
+
+   private:
+    struct alignas(64) Cell {
+        std::atomic<uint64_t> value{0};
+    };
+
+    Cell cells_[kStripes];
+};
+
+/**
+ * @brief 可增可减的瞬时值，例如队列深度
+ */
+class Gauge {
+   public:
+    void Set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+    void Add(int64_t delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+    int64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+   private:
+    std::atomic<int64_t> value_{0};
+};
+
+/**
+ * @brief Histogram 某一时刻的副本，可以合并多个副本后再计算分位数
+ */
+struct HistogramSnapshot {
+    std::vector<uint64_t> buckets;
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+
+    double Mean() const { return count == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(count); }
+
+    /**
+     * @brief 第 percent 百分位的值（percent 取 0~100），返回所在桶的上界，误差不超过 1/32
+     */
+    uint64_t Percentile(double percent) const;
+
+    void Merge(const HistogramSnapshot& other) {
+        if (buckets.size() < other.buckets.size()) {
+            buckets.resize(other.buckets.size(), 0);
+        }
+        for (size_t i = 0; i < other.buckets.size(); ++i) {
+            buckets[i] += other.buckets[i];
+        }
+        count += other.count;
+        sum += other.sum;
+        max = std::max(max, other.max);
+    }
+
+    /**
+     * @brief 减去同一直方图更早的副本，得到两次采集之间记录的分布；max 无法相减，保留为累计最大值
+     */
+    void Subtract(const HistogramSnapshot& earlier) {
+        for (size_t i = 0; i < buckets.size() && i < earlier.buckets.size(); ++i) {
+            buckets[i] -= std::min(buckets[i], earlier.buckets[i]);
+        }
+        count -= std::min(count, earlier.count);
+        sum -= std::min(sum, earlier.sum);
+    }
+};
+
+/**
+ * @brief HDR 风格的对数线性直方图，用于记录延迟（纳秒）等非负整数
+ * 小于 32 的值各占一个桶，之后每个 2 的幂区间等分为 32 个桶，覆盖整个 uint64_t 范围，相对误差不超过 1/32；
+ * 记录只做两三次 relaxed 原子操作，不加锁，可以常开。
+ * 桶数组（约 15 KB）在第一次记录时才分配，从未记录过的直方图只占几十字节，嵌在各模块中的直方图不常用时不占内存
+ */
+class Histogram {
+   public:
+    Histogram() = default;
+    ~Histogram() { delete[] buckets_.load(std::memory_order_relaxed); }
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    static constexpr int kSubBucketBits = 5;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static constexpr size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    static size_t BucketIndex(uint64_t value) {
+        if (value < kSubBuckets) {
+            return static_cast<size_t>(value);
+        }
+        int exponent = 63 - __builtin_clzll(value);
+        return static_cast<size_t>(exponent - kSubBucketBits + 1) * kSubBuckets +
+               static_cast<size_t>((value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1));
+    }
+
+    // 第 index 个桶能容纳的最大值
+    static uint64_t BucketUpperBound(size_t index) {
+        if (index < kSubBuckets) {
+            return index;
+        }
+        int exponent = static_cast<int>(index / kSubBuckets) + kSubBucketBits - 1;
+        uint64_t lower = (kSubBuckets + index % kSubBuckets) << (exponent - kSubBucketBits);
+        return lower + (uint64_t(1) << (exponent - kSubBucketBits)) - 1;
+    }
+
+    void Record(uint64_t value) {
+        Buckets()[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    HistogramSnapshot Snapshot() const {
+        HistogramSnapshot snapshot;
+        snapshot.buckets.resize(kBucketCount);
+        const std::atomic<uint64_t>* buckets = buckets_.load(std::memory_order_acquire);
+        for (size_t i = 0; buckets != nullptr && i < kBucketCount; ++i) {
+            snapshot.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+            snapshot.count += snapshot.buckets[i];
+        }
+        snapshot.sum = sum_.load(std::memory_order_relaxed);
+        snapshot.max = max_.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    // 与并发的 Record 之间不同步，只应在没有记录时调用（例如两轮性能测试之间）
+    void Reset() {
+        std::atomic<uint64_t>* buckets = buckets_.load(std::memory_order_acquire);
+        for (size_t i = 0; buckets != nullptr && i < kBucketCount; ++i) {
+            buckets[i].store(0, std::memory_order_relaxed);
+        }
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+   private:
+    // 第一次记录时分配并清零，多个线程同时分配时只保留一份
+    std::atomic<uint64_t>* Buckets() {
+        std::atomic<uint64_t>* buckets = buckets_.load(std::memory_order_acquire);
+        if (buckets != nullptr) {
+            return buckets;
+        }
+        std::atomic<uint64_t>* created = new std::atomic<uint64_t>[kBucketCount]();
+        if (buckets_.compare_exchange_strong(buckets, created, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return created;
+        }
+        delete[] created;
+        return buckets;
+    }
+
+    std::atomic<std::atomic<uint64_t>*> buckets_{nullptr};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+inline uint64_t HistogramSnapshot::Percentile(double percent) const {
+    if (count == 0) {
+        return 0;
+    }
+    double clamped = std::min(std::max(percent, 0.0), 100.0);
+    uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(count) + 0.5), 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(Histogram::BucketUpperBound(i), max);
+        }
+    }
+    return max;
+}
+
+inline std::atomic<uint32_t>& SampleMaskRef() {
+    static std::atomic<uint32_t> mask(15);
+    return mask;
+}
+
+/**
+ * @brief 设置延迟抽样的全局间隔，默认每个抽样点每个线程 16 次记录一次；性能测试中设为 1 记录全部
+ * @param rate 向上取整为 2 的幂
+ */
+inline void SetSampleRate(uint32_t rate) {
+    uint32_t power = 1;
+    while (power < rate && power < (1u << 31)) {
+        power <<= 1;
+    }
+    SampleMaskRef().store(power - 1, std::memory_order_relaxed);
+}
+
+inline uint32_t GetSampleRate() { return SampleMaskRef().load(std::memory_order_relaxed) + 1; }
+
+/**
+ * @brief 按 SetSampleRate 的间隔抽样，Tag 区分不同的抽样点，每个线程每个抽样点独立计数
+ */
+template <typename Tag>
+inline bool ShouldSample() {
+    static thread_local uint32_t tick = 0;
+    return (++tick & SampleMaskRef().load(std::memory_order_relaxed)) == 0;
+}
+
+/**
+ * @brief 析构时把经过的时间（纳秒）记入直方图，histogram 为空时什么也不做，通常配合 ShouldSample 使用：
+ * cMetrics::ScopedTimer timer(cMetrics::ShouldSample<Tag>() ? &histogram : nullptr);
+ */
+class ScopedTimer {
+   public:
+    explicit ScopedTimer(Histogram* histogram) : histogram_(histogram), start_ns_(histogram ? NowNs() : 0) {}
+    ~ScopedTimer() {
+        if (histogram_ != nullptr) {
+            histogram_->Record(NowNs() - start_ns_);
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+   private:
+    Histogram* histogram_;
+    uint64_t start_ns_;
+};
+
+/**
+ * @brief 一个导出的指标值
+ */
+struct Sample {
+    std::string name;
+    double value;
+};
+
+using Samples = std::vector<Sample>;
+
+/**
+ * @brief 把直方图展开为 name.count/.mean/.p50/.p90/.p99/.p999/.max 几个指标
+ */
+inline void AppendHistogram(Samples& samples, const std::string& name, const HistogramSnapshot& snapshot) {
+    samples.push_back({name + ".count", static_cast<double>(snapshot.count)});
+    samples.push_back({name + ".mean", snapshot.Mean()});
+    samples.push_back({name + ".p50", static_cast<double>(snapshot.Percentile(50))});
+    samples.push_back({name + ".p90", static_cast<double>(snapshot.Percentile(90))});
+    samples.push_back({name + ".p99", static_cast<double>(snapshot.Percentile(99))});
+    samples.push_back({name + ".p999", static_cast<double>(snapshot.Percentile(99.9))});
+    samples.push_back({name + ".max", static_cast<double>(snapshot.max)});
+}
+
+class Registry;
+
+/**
+ * @brief AddCollector 返回的注册句柄，析构时注销采集函数；只能移动
+ */
+class Registration {
+   public:
+    Registration() = default;
+    Registration(Registry* registry, uint64_t id) : registry_(registry), id_(id) {}
+    Registration(Registration&& other) noexcept
+        : registry_(std::exchange(other.registry_, nullptr)), id_(other.id_) {}
+    Registration& operator=(Registration&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            registry_ = std::exchange(other.registry_, nullptr);
+            id_ = other.id_;
+        }
+        return *this;
+    }
+    Registration(const Registration&) = delete;
+    Registration& operator=(const Registration&) = delete;
+    ~Registration() { Reset(); }
+
+    inline void Reset();
+
+   private:
+    Registry* registry_ = nullptr;
+    uint64_t id_ = 0;
+};
+
+/**
+ * @brief 指标注册表，监控导出与性能测试从这里读取同一份指标
+ * 按名称创建的 Counter/Gauge/Histogram 与注册表同生命周期，返回的引用始终有效；
+ * 组件通过 AddCollector 注册采集函数，Collect 时调用，采集函数在注册表的锁内执行，不能再访问注册表
+ */
+class Registry {
+   public:
+    using Collector = std::function<void(Samples&)>;
+
+    // 全局注册表不析构，Logger 等单例析构时注销采集函数仍然安全
+    static Registry& Global() {
+        static Registry* registry = new Registry();
+        return *registry;
+    }
+
+    Registry() = default;
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    Counter& GetCounter(const std::string& name) { return GetOrCreate(counters_, name); }
+    Gauge& GetGauge(const std::string& name) { return GetOrCreate(gauges_, name); }
+    Histogram& GetHistogram(const std::string& name) { return GetOrCreate(histograms_, name); }
+
+    /**
+     * @brief 注册采集函数，返回的句柄析构时注销；注销会等待正在进行的 Collect 结束
+     */
+    Registration AddCollector(Collector collector) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t id = next_id_++;
+        collectors_.emplace(id, std::move(collector));
+        return Registration(this, id);
+    }
+
+    /**
+     * @brief 采集全部指标，按名称排序
+     */
+    Samples Collect() const {
+        Samples samples;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const auto& entry : counters_) {
+                samples.push_back({entry.first, static_cast<double>(entry.second->Value())});
+            }
+            for (const auto& entry : gauges_) {
+                samples.push_back({entry.first, static_cast<double>(entry.second->Value())});
+            }
+            for (const auto& entry : histograms_) {
+                AppendHistogram(samples, entry.first, entry.second->Snapshot());
+            }
+            for (const auto& entry : collectors_) {
+                entry.second(samples);
+            }
+        }
+        std::stable_sort(samples.begin(), samples.end(),
+                         [](const Sample& a, const Sample& b) { return a.name < b.name; });
+        return samples;
+    }
+
+    /**
+     * @brief 以每行 "名称 值" 的文本格式输出全部指标，便于监控系统抓取
+     */
+    std::string Dump() const {
+        std::ostringstream out;
+        for (const Sample& sample : Collect()) {
+            out << sample.name << ' ' << sample.value << '\n';
+        }
+        return out.str();
+    }
+
+   private:
+    friend class Registration;
+
+    template <typename Metric>
+    Metric& GetOrCreate(std::map<std::string, std::unique_ptr<Metric>>& metrics, const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::unique_ptr<Metric>& metric = metrics[name];
+        if (!metric) {
+            metric = std::make_unique<Metric>();
+        }
+        return *metric;
+    }
+
+    void RemoveCollector(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        collectors_.erase(id);
+    }
+
+    mutable std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<Counter>> counters_;
+    std::map<std::string, std::unique_ptr<Gauge>> gauges_;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms_;
+    std::map<uint64_t, Collector> collectors_;
+    uint64_t next_id_ = 1;
+};
+
+inline void Registration::Reset() {
+    if (registry_ != nullptr) {
+        registry_->RemoveCollector(id_);
+        registry_ = nullptr;
+    }
+}
+
+}  // namespace cMetrics
+
+#endif  // __METRICS__
@@ -0,0 +1,249 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "logger.h"
+#include "metrics.h"
+#include "object_pool.h"
+#include "pub_sub.h"
+#include "thread_pool.h"
+
+using namespace cMetrics;
+using std::cout;
+using std::endl;
+
+// 在采集结果中按名称查找，找不到时返回 -1
+double FindSample(const Samples& samples, const std::string& name) {
+    for (const Sample& sample : samples) {
+        if (sample.name == name) {
+            return sample.value;
+        }
+    }
+    return -1;
+}
+
+void TestCounter() {
+    cout << "\n========== 测试1: 计数器 ==========" << endl;
+
+    Counter counter;
+    const int thread_count = 8;
+    const int add_count = 100000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&counter]() {
+            for (int j = 0; j < add_count; ++j) {
+                counter.Add();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    cout << thread_count << " 个线程并发计数: " << counter.Value() << "（期望 " << thread_count * add_count << "）"
+         << endl;
+
+    Gauge gauge;
+    gauge.Add(5);
+    gauge.Add(-8);
+    cout << "Gauge: " << gauge.Value() << "（期望 -3）" << endl;
+}
+
+void TestHistogram() {
+    cout << "\n========== 测试2: 直方图分位数 ==========" << endl;
+
+    Histogram histogram;
+    for (uint64_t value = 1; value <= 100000; ++value) {
+        histogram.Record(value);
+    }
+    HistogramSnapshot snapshot = histogram.Snapshot();
+    double p50_error = std::abs(static_cast<double>(snapshot.Percentile(50)) - 50000) / 50000;
+    double p99_error = std::abs(static_cast<double>(snapshot.Percentile(99)) - 99000) / 99000;
+    cout << "count: " << snapshot.count << "，mean: " << snapshot.Mean() << "（期望 50000.5），max: " << snapshot.max
+         << endl;
+    cout << "p50: " << snapshot.Percentile(50) << "，p99: " << snapshot.Percentile(99)
+         << "，p100: " << snapshot.Percentile(100) << "（期望 100000）" << endl;
+    cout << "相对误差不超过 1/32: " << (p50_error <= 1.0 / 32 && p99_error <= 1.0 / 32 ? "是" : "否") << endl;
+
+    // 每个桶的上界都落在自己的桶里，下一个值落在下一个桶
+    bool bounds_ok = true;
+    for (size_t i = 0; i + 1 < Histogram::kBucketCount; ++i) {
+        uint64_t upper = Histogram::BucketUpperBound(i);
+        bounds_ok = bounds_ok && Histogram::BucketIndex(upper) == i && Histogram::BucketIndex(upper + 1) == i + 1;
+    }
+    cout << "桶边界连续: " << (bounds_ok ? "是" : "否") << "，最大值所在桶: "
+         << Histogram::BucketIndex(UINT64_MAX) << "（期望 " << Histogram::kBucketCount - 1 << "）" << endl;
+
+    HistogramSnapshot merged = snapshot;
+    Histogram other;
+    other.Record(1000000);
+    merged.Merge(other.Snapshot());
+    cout << "合并后 count: " << merged.count << "（期望 100001），max: " << merged.max << "（期望 1000000）" << endl;
+
+    // 桶数组在第一次记录时分配，多个线程同时第一次记录时只保留一份
+    Histogram lazy;
+    cout << "sizeof(Histogram): " << sizeof(Histogram) << "，未记录时 count: " << lazy.Snapshot().count
+         << "（期望 0）" << endl;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&lazy]() {
+            for (int i = 0; i < 1000; ++i) {
+                lazy.Record(static_cast<uint64_t>(i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    cout << "并发首次记录后 count: " << lazy.Snapshot().count << "（期望 8000）" << endl;
+}
+
+void TestRegistry() {
+    cout << "\n========== 测试3: 注册表与导出 ==========" << endl;
+
+    Registry registry;
+    registry.GetCounter("app.requests").Add(3);
+    registry.GetCounter("app.requests").Add(2);
+    registry.GetGauge("app.connections").Set(7);
+    registry.GetHistogram("app.latency_ns").Record(100);
+    {
+        Registration registration = registry.AddCollector([](Samples& samples) { samples.push_back({"app.extra", 1}); });
+        Samples samples = registry.Collect();
+        cout << "app.requests: " << FindSample(samples, "app.requests") << "（期望 5），app.connections: "
+             << FindSample(samples, "app.connections") << "（期望 7），app.latency_ns.p50: "
+             << FindSample(samples, "app.latency_ns.p50") << "（期望 100），app.extra: "
+             << FindSample(samples, "app.extra") << "（期望 1）" << endl;
+    }
+    cout << "注册句柄析构后 app.extra: " << FindSample(registry.Collect(), "app.extra") << "（期望 -1）" << endl;
+
+    cout << "文本导出:\n" << registry.Dump();
+
+    SetSampleRate(5);
+    cout << "抽样间隔向上取整: " << GetSampleRate() << "（期望 8）" << endl;
+    SetSampleRate(16);
+}
+
+void TestComponentMetrics() {
+    cout << "\n========== 测试4: 组件指标 ==========" << endl;
+
+    // 记录全部延迟，便于检查数量
+    SetSampleRate(1);
+    Registry registry;
+
+    cThread::ThreadPool::ThreadPoolConfig config{2, 2, 1024, std::chrono::seconds(4)};
+    auto pool = std::make_unique<cThread::ThreadPool>(config);
+    pool->Start();
+    pool->ExportMetrics("pool", registry);
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 100; ++i) {
+        futures.push_back(pool->Submit([]() {}));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+    // 批量提交的任务同样统计排队时间
+    std::atomic<int> batch_done(0);
+    std::vector<cThread::SmallTask> batch;
+    for (int i = 0; i < 50; ++i) {
+        batch.emplace_back([&batch_done]() { ++batch_done; });
+    }
+    pool->PostBatch(batch);
+    while (batch_done.load() < 50) {
+        std::this_thread::yield();
+    }
+    pool->ShutDown();
+    pool->Post([]() {});
+    cThread::ThreadPool::Metrics pool_metrics = pool->GetMetrics();
+    Samples samples = registry.Collect();
+    cout << "线程池 submitted: " << pool_metrics.submitted << "（期望 150），rejected: " << pool_metrics.rejected
+         << "（期望 1），queue_wait_ns.count: " << FindSample(samples, "pool.queue_wait_ns.count")
+         << "（期望 150），run_ns.count: " << pool_metrics.run_ns.count << "（期望 150）" << endl;
+    pool.reset();
+    cout << "线程池析构后自动注销: " << (FindSample(registry.Collect(), "pool.submitted") < 0 ? "是" : "否") << endl;
+
+    cPubSub::PubSub<int> pubsub;
+    pubsub.ExportMetrics("pubsub", registry);
+    pubsub.Subscribe("orders", [](const std::string&, const int&) {});
+    pubsub.Subscribe("orders", [](const std::string&, const int&) {});
+    for (int i = 0; i < 10; ++i) {
+        pubsub.Publish("orders", i);
+    }
+    pubsub.Publish("nobody", 0);
+    samples = registry.Collect();
+    cout << "PubSub published: " << FindSample(samples, "pubsub.published") << "（期望 11），delivered: "
+         << FindSample(samples, "pubsub.delivered") << "（期望 20），unmatched: "
+         << FindSample(samples, "pubsub.unmatched") << "（期望 1）" << endl;
+
+    // 取消异步订阅后累计值不减少
+    struct InlineExecutor {
+        bool Post(std::function<void()> task) {
+            task();
+            return true;
+        }
+    } executor;
+    cPubSub::SubscriberId async_id =
+        pubsub.SubscribeAsync("orders", [](const std::string&, const int*, size_t) {}, executor);
+    for (int i = 0; i < 5; ++i) {
+        pubsub.Publish("orders", i);
+    }
+    double async_enqueued = FindSample(registry.Collect(), "pubsub.async_enqueued");
+    pubsub.Unsubscribe("orders", async_id);
+    samples = registry.Collect();
+    cout << "PubSub async_enqueued: " << async_enqueued << "（期望 5），取消订阅后: "
+         << FindSample(samples, "pubsub.async_enqueued") << "（期望 5），async_delivered: "
+         << FindSample(samples, "pubsub.async_delivered") << "（期望 5）" << endl;
+
+    cObjectPool::ObjectPool<int> object_pool([]() { return std::make_unique<int>(0); }, nullptr, 1);
+    object_pool.ExportMetrics("object_pool", registry);
+    {
+        auto first = object_pool.Acquire();
+    }
+    auto held = object_pool.Acquire();
+    auto timed_out = object_pool.AcquireFor(std::chrono::milliseconds(5));
+    samples = registry.Collect();
+    cout << "对象池 hit_ratio: " << FindSample(samples, "object_pool.hit_ratio") << "（期望 0.5），wait_ns.count: "
+         << FindSample(samples, "object_pool.wait_ns.count") << "（期望 1），等待至少 5ms: "
+         << (FindSample(samples, "object_pool.wait_ns.max") >= 5e6 ? "是" : "否") << endl;
+
+    cLogger::Logger& logger = cLogger::Logger::GetInstance();
+    cLogger::LoggerConfig logger_config;
+    logger_config.enable_console = false;
+    logger.Initialize(logger_config);
+    // 日志是单例，导出到与其同生命周期的全局注册表
+    logger.ExportMetrics("logger");
+    uint64_t logged = logger.GetMetrics().logged;
+    for (int i = 0; i < 10; ++i) {
+        logger.Log(cLogger::LogLevel::INFO, __FILE__, __LINE__, __FUNCTION__, "metrics");
+    }
+    samples = Registry::Global().Collect();
+    cout << "日志 logged 增加: " << FindSample(samples, "logger.logged") - static_cast<double>(logged)
+         << "（期望 10），emit_ns.p99 > 0: " << (FindSample(samples, "logger.emit_ns.p99") > 0 ? "是" : "否") << endl;
+
+    SetSampleRate(16);
+}
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "    运行指标模块测试程序" << endl;
+    cout << "========================================" << endl;
+
+    try {
+        TestCounter();
+        TestHistogram();
+        TestRegistry();
+        TestComponentMetrics();
+
+        cout << "\n========================================" << endl;
+        cout << "    所有测试完成！" << endl;
+        cout << "========================================" << endl;
+    } catch (const std::exception& e) {
+        cout << "测试异常: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}
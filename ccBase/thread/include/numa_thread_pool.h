@@ -0,0 +1,184 @@
+#ifndef __NUMA_THREAD_POOL__
+#define __NUMA_THREAD_POOL__
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "thread_pool.h"
+
+namespace cThread {
+
+/**
+ * NUMA 拓扑：每个节点包含的 CPU 编号列表
+ * Linux 下从 /sys/devices/system/node/nodeN/cpulist 读取，读取失败或其他平台时视为只有一个节点，包含全部 CPU
+ */
+class NumaTopology {
+   public:
+    static NumaTopology Detect() {
+        NumaTopology topology;
+#if defined(__linux__)
+        for (int node = 0;; ++node) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!file.is_open()) {
+                break;
+            }
+            std::string line;
+            std::getline(file, line);
+            std::vector<int> cpus = ParseCpuList(line);
+            if (!cpus.empty()) {
+                topology.nodes_.push_back(std::move(cpus));
+            }
+        }
+#endif
+        if (topology.nodes_.empty()) {
+            std::vector<int> cpus;
+            int cpu_num = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            for (int cpu = 0; cpu < cpu_num; ++cpu) {
+                cpus.push_back(cpu);
+            }
+            topology.nodes_.push_back(std::move(cpus));
+        }
+        return topology;
+    }
+
+    // 解析 "0-3,8-11" 形式的 CPU 列表
+    static std::vector<int> ParseCpuList(const std::string &text) {
+        std::vector<int> cpus;
+        std::stringstream ss(text);
+        std::string range;
+        while (std::getline(ss, range, ',')) {
+            if (range.empty()) {
+                continue;
+            }
+            size_t dash = range.find('-');
+            try {
+                int first = std::stoi(range.substr(0, dash));
+                int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                for (int cpu = first; cpu <= last; ++cpu) {
+                    cpus.push_back(cpu);
+                }
+            } catch (...) {
+                // 忽略无法解析的片段
+            }
+        }
+        return cpus;
+    }
+
+    int GetNodeCount() const { return static_cast<int>(nodes_.size()); }
+
+    const std::vector<int> &GetCpus(int node) const { return nodes_[node]; }
+
+    // 获取 CPU 所在的节点，未知时返回 0
+    int GetNodeOfCpu(int cpu) const {
+        for (size_t node = 0; node < nodes_.size(); ++node) {
+            for (int c : nodes_[node]) {
+                if (c == cpu) {
+                    return static_cast<int>(node);
+                }
+            }
+        }
+        return 0;
+    }
+
+   private:
+    std::vector<std::vector<int>> nodes_;
+};
+
+/**
+ * 按 NUMA 节点划分的线程池：每个节点一个 ThreadPool 子池，子池线程绑定到该节点的 CPU 上
+ * 提交任务时优先放入调用线程当前所在节点的子池，保持缓存和内存的局部性；也可以显式指定节点
+ * config 为每个子池的配置，其中 cpu_set 会被替换为节点的 CPU 列表，thread_name 会追加节点编号
+ */
+class NumaThreadPool {
+   public:
+    explicit NumaThreadPool(ThreadPool::ThreadPoolConfig config, NumaTopology topology = NumaTopology::Detect())
+        : topology_(std::move(topology)) {
+        for (int node = 0; node < topology_.GetNodeCount(); ++node) {
+            ThreadPool::ThreadPoolConfig node_config = config;
+            node_config.cpu_set = topology_.GetCpus(node);
+            node_config.thread_name = (config.thread_name.empty() ? std::string("pool") : config.thread_name) +
+                                      "n" + std::to_string(node);
+            pools_.push_back(std::make_unique<ThreadPool>(node_config));
+            for (int cpu : node_config.cpu_set) {
+                if (cpu >= static_cast<int>(cpu_to_node_.size())) {
+                    cpu_to_node_.resize(cpu + 1, 0);
+                }
+                cpu_to_node_[cpu] = node;
+            }
+        }
+    }
+
+    bool Start() {
+        bool ok = true;
+        for (auto &pool : pools_) {
+            ok = pool->Start() && ok;
+        }
+        return ok;
+    }
+
+    void ShutDown() {
+        for (auto &pool : pools_) {
+            pool->ShutDown();
+        }
+    }
+
+    void ShutDownNow() {
+        for (auto &pool : pools_) {
+            pool->ShutDownNow();
+        }
+    }
+
+    int GetNodeCount() const { return static_cast<int>(pools_.size()); }
+
+    ThreadPool &GetPool(int node) { return *pools_[node]; }
+
+    // 调用线程当前所在的节点，无法获取时返回 0
+    int GetCurrentNode() const {
+#if defined(__linux__)
+        int cpu = sched_getcpu();
+        if (cpu >= 0 && cpu < static_cast<int>(cpu_to_node_.size())) {
+            return cpu_to_node_[cpu];
+        }
+#endif
+        return 0;
+    }
+
+    template <typename F, typename... Args>
+    auto Run(F &&f, Args &&... args) {
+        return GetPool(GetCurrentNode()).Run(std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    template <typename F, typename... Args>
+    bool Post(F &&f, Args &&... args) {
+        return GetPool(GetCurrentNode()).Post(std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    template <typename F, typename... Args>
+    auto Submit(F &&f, Args &&... args) {
+        return GetPool(GetCurrentNode()).Submit(std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    // 提交到指定节点的子池
+    template <typename F, typename... Args>
+    bool PostToNode(int node, F &&f, Args &&... args) {
+        return GetPool(node).Post(std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    template <typename F, typename... Args>
+    auto SubmitToNode(int node, F &&f, Args &&... args) {
+        return GetPool(node).Submit(std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+   private:
+    NumaTopology topology_;
+    std::vector<int> cpu_to_node_;
+    std::vector<std::unique_ptr<ThreadPool>> pools_;
+};
+
+}  // namespace cThread
+
+#endif  // __NUMA_THREAD_POOL__
@@ -0,0 +1,106 @@
+#ifndef __RING_QUEUE__
+#define __RING_QUEUE__
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace cThread {
+
+/**
+ * 基于连续数组的双端环形队列，容量为 2 的幂，满时翻倍扩容
+ * 相比 std::deque/std::queue 没有分块节点，元素在内存中连续，稳定运行后入队出队不再分配内存
+ * 非线程安全，由使用者加锁
+ */
+template <typename T>
+class RingQueue {
+   public:
+    explicit RingQueue(size_t initial_capacity = 64) {
+        size_t capacity = 1;
+        while (capacity < initial_capacity) {
+            capacity <<= 1;
+        }
+        Allocate(capacity);
+    }
+
+    RingQueue(const RingQueue &) = delete;
+    RingQueue &operator=(const RingQueue &) = delete;
+
+    ~RingQueue() {
+        Clear();
+        ::operator delete(buffer_);
+    }
+
+    bool empty() const { return size_ == 0; }
+
+    size_t size() const { return size_; }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    template <typename... Args>
+    void emplace_back(Args &&... args) {
+        if (size_ == capacity()) {
+            Grow();
+        }
+        ::new (static_cast<void *>(&buffer_[(head_ + size_) & mask_])) T(std::forward<Args>(args)...);
+        ++size_;
+    }
+
+    template <typename... Args>
+    void emplace(Args &&... args) {
+        emplace_back(std::forward<Args>(args)...);
+    }
+
+    T &front() { return buffer_[head_]; }
+
+    T &back() { return buffer_[(head_ + size_ - 1) & mask_]; }
+
+    void pop_front() {
+        buffer_[head_].~T();
+        head_ = (head_ + 1) & mask_;
+        --size_;
+    }
+
+    void pop() { pop_front(); }
+
+    void pop_back() {
+        back().~T();
+        --size_;
+    }
+
+    void Clear() {
+        while (!empty()) {
+            pop_front();
+        }
+        head_ = 0;
+    }
+
+   private:
+    void Allocate(size_t capacity) {
+        buffer_ = static_cast<T *>(::operator new(capacity * sizeof(T)));
+        mask_ = capacity - 1;
+    }
+
+    void Grow() {
+        T *old_buffer = buffer_;
+        size_t old_mask = mask_;
+        Allocate(capacity() * 2);
+        for (size_t i = 0; i < size_; ++i) {
+            T &item = old_buffer[(head_ + i) & old_mask];
+            ::new (static_cast<void *>(&buffer_[i])) T(std::move(item));
+            item.~T();
+        }
+        head_ = 0;
+        ::operator delete(old_buffer);
+    }
+
+    T *buffer_ = nullptr;
+    size_t mask_ = 0;
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+}  // namespace cThread
+
+#endif  // __RING_QUEUE__
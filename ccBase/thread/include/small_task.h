@@ -0,0 +1,158 @@
+#ifndef __SMALL_TASK__
+#define __SMALL_TASK__
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace cThread {
+
+/**
+ * 小对象优化的只移动任务类型，用于替代线程池队列中的 std::function<void()>
+ * 可调用对象不超过 kInlineSize 字节、对齐要求不超过 max_align_t 且可无异常移动时，直接构造在内部缓冲区中，
+ * 整个生命周期不分配内存；否则退化为在堆上分配，也可以通过 allocator_arg 构造函数改为从指定的 memory_resource 分配
+ * 与 std::function 不同，可以存放 std::promise 等只能移动的对象
+ */
+class SmallTask {
+   public:
+    static constexpr size_t kInlineSize = 64;
+
+    SmallTask() noexcept = default;
+    SmallTask(std::nullptr_t) noexcept {}
+
+    template <typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, SmallTask>::value>>
+    SmallTask(F &&f) {
+        using Func = std::decay_t<F>;
+        if constexpr (IsInline<Func>()) {
+            ::new (static_cast<void *>(buffer_)) Func(std::forward<F>(f));
+            ops_ = &InlineOps<Func>::kOps;
+        } else {
+            ::new (static_cast<void *>(buffer_)) Func *(new Func(std::forward<F>(f)));
+            ops_ = &HeapOps<Func>::kOps;
+        }
+    }
+
+    /**
+     * 不能内联存放的可调用对象从 resource 分配，resource 为空时使用堆
+     * 任务可能在其他线程上销毁，resource 需要是线程安全的，并且比任务活得更久
+     */
+    template <typename F>
+    SmallTask(std::allocator_arg_t, std::pmr::memory_resource *resource, F &&f) {
+        using Func = std::decay_t<F>;
+        if constexpr (IsInline<Func>()) {
+            ::new (static_cast<void *>(buffer_)) Func(std::forward<F>(f));
+            ops_ = &InlineOps<Func>::kOps;
+        } else if (resource == nullptr) {
+            ::new (static_cast<void *>(buffer_)) Func *(new Func(std::forward<F>(f)));
+            ops_ = &HeapOps<Func>::kOps;
+        } else {
+            void *memory = resource->allocate(sizeof(Func), alignof(Func));
+            Func *func;
+            try {
+                func = ::new (memory) Func(std::forward<F>(f));
+            } catch (...) {
+                resource->deallocate(memory, sizeof(Func), alignof(Func));
+                throw;
+            }
+            ::new (static_cast<void *>(buffer_)) ResourceBox<Func>{func, resource};
+            ops_ = &ResourceOps<Func>::kOps;
+        }
+    }
+
+    SmallTask(SmallTask &&other) noexcept { MoveFrom(other); }
+
+    SmallTask &operator=(SmallTask &&other) noexcept {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    SmallTask(const SmallTask &) = delete;
+    SmallTask &operator=(const SmallTask &) = delete;
+
+    ~SmallTask() { Reset(); }
+
+    void operator()() { ops_->invoke(buffer_); }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+    // 可调用对象是否直接存放在内部缓冲区中
+    template <typename Func>
+    static constexpr bool IsInline() {
+        return sizeof(Func) <= kInlineSize && alignof(Func) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible<Func>::value;
+    }
+
+    void Reset() noexcept {
+        if (ops_ != nullptr) {
+            ops_->destroy(buffer_);
+            ops_ = nullptr;
+        }
+    }
+
+   private:
+    struct Ops {
+        void (*invoke)(void *storage);
+        void (*move)(void *dst, void *src) noexcept;
+        void (*destroy)(void *storage) noexcept;
+    };
+
+    template <typename Func>
+    struct InlineOps {
+        static void Invoke(void *storage) { (*static_cast<Func *>(storage))(); }
+        static void Move(void *dst, void *src) noexcept {
+            ::new (dst) Func(std::move(*static_cast<Func *>(src)));
+            static_cast<Func *>(src)->~Func();
+        }
+        static void Destroy(void *storage) noexcept { static_cast<Func *>(storage)->~Func(); }
+        static constexpr Ops kOps{&Invoke, &Move, &Destroy};
+    };
+
+    template <typename Func>
+    struct HeapOps {
+        static void Invoke(void *storage) { (**static_cast<Func **>(storage))(); }
+        static void Move(void *dst, void *src) noexcept { ::new (dst) Func *(*static_cast<Func **>(src)); }
+        static void Destroy(void *storage) noexcept { delete *static_cast<Func **>(storage); }
+        static constexpr Ops kOps{&Invoke, &Move, &Destroy};
+    };
+
+    template <typename Func>
+    struct ResourceBox {
+        Func *func;
+        std::pmr::memory_resource *resource;
+    };
+
+    template <typename Func>
+    struct ResourceOps {
+        static void Invoke(void *storage) { (*static_cast<ResourceBox<Func> *>(storage)->func)(); }
+        static void Move(void *dst, void *src) noexcept {
+            ::new (dst) ResourceBox<Func>(*static_cast<ResourceBox<Func> *>(src));
+        }
+        static void Destroy(void *storage) noexcept {
+            ResourceBox<Func> *box = static_cast<ResourceBox<Func> *>(storage);
+            box->func->~Func();
+            box->resource->deallocate(box->func, sizeof(Func), alignof(Func));
+        }
+        static constexpr Ops kOps{&Invoke, &Move, &Destroy};
+    };
+
+    void MoveFrom(SmallTask &other) noexcept {
+        if (other.ops_ != nullptr) {
+            other.ops_->move(buffer_, other.buffer_);
+            ops_ = other.ops_;
+            other.ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char buffer_[kInlineSize];
+    const Ops *ops_ = nullptr;
+};
+
+}  // namespace cThread
+
+#endif  // __SMALL_TASK__
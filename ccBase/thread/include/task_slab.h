@@ -0,0 +1,114 @@
+#ifndef __TASK_SLAB__
+#define __TASK_SLAB__
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace cThread {
+
+/**
+ * 固定大小内存块的线程安全 slab，用于分配任务结果（std::promise/std::future）的共享状态
+ * 不超过 kBlockSize 字节的请求从空闲链表中取，空闲链表为空时一次申请 kBlocksPerChunk 个块；
+ * 超过 kBlockSize 或对齐要求超过 max_align_t 的请求直接使用 operator new
+ * 释放的块只回到空闲链表，slab 析构时统一归还
+ */
+class TaskSlab {
+   public:
+    static constexpr size_t kBlockSize = 256;
+    static constexpr size_t kBlocksPerChunk = 64;
+
+    TaskSlab() = default;
+    TaskSlab(const TaskSlab &) = delete;
+    TaskSlab &operator=(const TaskSlab &) = delete;
+
+    void *Allocate(size_t bytes, size_t alignment) {
+        if (bytes > kBlockSize || alignment > alignof(std::max_align_t)) {
+            return ::operator new(bytes);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_list_ == nullptr) {
+            Grow();
+        }
+        Block *block = free_list_;
+        free_list_ = block->next;
+        return block;
+    }
+
+    void Deallocate(void *ptr, size_t bytes, size_t alignment) noexcept {
+        if (bytes > kBlockSize || alignment > alignof(std::max_align_t)) {
+            ::operator delete(ptr);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        Block *block = static_cast<Block *>(ptr);
+        block->next = free_list_;
+        free_list_ = block;
+    }
+
+    // 获取 slab 已经申请的块总数
+    size_t GetCapacity() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return chunks_.size() * kBlocksPerChunk;
+    }
+
+   private:
+    struct Block {
+        Block *next;
+    };
+
+    void Grow() {
+        std::unique_ptr<unsigned char[]> chunk(new unsigned char[kBlockSize * kBlocksPerChunk]);
+        for (size_t i = kBlocksPerChunk; i-- > 0;) {
+            Block *block = reinterpret_cast<Block *>(chunk.get() + i * kBlockSize);
+            block->next = free_list_;
+            free_list_ = block;
+        }
+        chunks_.push_back(std::move(chunk));
+    }
+
+    mutable std::mutex mutex_;
+    Block *free_list_ = nullptr;
+    std::vector<std::unique_ptr<unsigned char[]>> chunks_;
+};
+
+/**
+ * 从 TaskSlab 分配内存的标准分配器，持有 slab 的 shared_ptr，
+ * 因此 future 的生命周期即使超过线程池，共享状态的释放依然安全
+ */
+template <typename T>
+class SlabAllocator {
+   public:
+    using value_type = T;
+
+    explicit SlabAllocator(std::shared_ptr<TaskSlab> slab) noexcept : slab_(std::move(slab)) {}
+
+    template <typename U>
+    SlabAllocator(const SlabAllocator<U> &other) noexcept : slab_(other.slab_) {}
+
+    T *allocate(size_t n) { return static_cast<T *>(slab_->Allocate(n * sizeof(T), alignof(T))); }
+
+    void deallocate(T *ptr, size_t n) noexcept { slab_->Deallocate(ptr, n * sizeof(T), alignof(T)); }
+
+    template <typename U>
+    bool operator==(const SlabAllocator<U> &other) const noexcept {
+        return slab_ == other.slab_;
+    }
+
+    template <typename U>
+    bool operator!=(const SlabAllocator<U> &other) const noexcept {
+        return slab_ != other.slab_;
+    }
+
+   private:
+    template <typename U>
+    friend class SlabAllocator;
+
+    std::shared_ptr<TaskSlab> slab_;
+};
+
+}  // namespace cThread
+
+#endif  // __TASK_SLAB__
@@ -1,30 +1,235 @@
 #ifndef __THREAD_POOL__
 #define __THREAD_POOL__
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <future>
 #include <iostream>
 #include <list>
 #include <memory>
+#include <memory_resource>
 #include <mutex>
 #include <queue>
+#include <string>
 #include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
 
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#endif
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "metrics.h"
+#include "ring_queue.h"
+#include "small_task.h"
+#include "task_slab.h"
+#include "timing_wheel.h"
+
 using std::cout;
 using std::endl;
 
+/**
+ * 线程池生命周期跟踪开关
+ * 编译时定义 CTHREAD_ENABLE_TRACE 后，线程的创建、等待、退出以及线程池的启动、关闭等事件会回调
+ * ThreadPool::SetTraceHook 设置的函数（默认输出到 cout）；未定义时所有跟踪点展开为空，
+ * 工作线程取任务的临界区内不包含任何 I/O
+ */
+#ifdef CTHREAD_ENABLE_TRACE
+#define CTHREAD_TRACE(event, thread_id, value) ::cThread::ThreadPool::Trace(event, thread_id, value)
+#else
+#define CTHREAD_TRACE(event, thread_id, value) ((void)0)
+#endif
+
 namespace cThread {
 
+/**
+ * 线程池跟踪事件，thread_id 为 -1 表示与具体线程无关的事件
+ * kInitBegin: value 为核心线程数；kThreadAdd: value 为 ThreadFlag；kResize: thread_id 为原线程数，value 为目标线程数
+ * kWaitBegin/kWaitEnd: 线程开始/结束等待任务（等待期间持有 task_mutex_ 的部分在这两个事件之间）
+ */
+enum class TraceEvent {
+    kInitBegin = 0,
+    kInitEnd,
+    kThreadAdd,
+    kWaitBegin,
+    kWaitEnd,
+    kThreadStop,
+    kThreadShutdown,
+    kThreadShutdownNow,
+    kThreadExit,
+    kShutdown,
+    kShutdownNow,
+    kResize
+};
+
+/**
+ * 任务优先级，数值越小优先级越高
+ */
+enum class TaskPriority { kHigh = 0, kNormal = 1, kLow = 2 };
+
+/**
+ * 队列中的任务，enqueue_ns 为被抽中统计排队时间的任务的入队时刻，未被抽中时为 0
+ */
+struct QueuedTask {
+    SmallTask task;
+    uint64_t enqueue_ns = 0;
+
+    QueuedTask() = default;
+    QueuedTask(SmallTask &&task, uint64_t enqueue_ns) : task(std::move(task)), enqueue_ns(enqueue_ns) {}
+};
+
+/**
+ * 按优先级分层的任务队列，每个优先级一个 RingQueue，非线程安全，由 ThreadPool 的 task_mutex_ 保护
+ * 出队时默认取最高优先级的任务；为防止低优先级任务饿死，记录每个非空的低优先级队列被跳过的次数，
+ * 达到 starvation_threshold 后优先取一次该队列的任务，starvation_threshold <= 0 表示严格按优先级
+ */
+class PriorityTaskQueue {
+   public:
+    static constexpr int kLevels = 3;
+
+    explicit PriorityTaskQueue(int starvation_threshold = 16) : starvation_threshold_(starvation_threshold) {}
+
+    void SetStarvationThreshold(int starvation_threshold) { starvation_threshold_ = starvation_threshold; }
+
+    bool empty() const { return size_ == 0; }
+
+    size_t size() const { return size_; }
+
+    size_t size(TaskPriority priority) const { return queues_[static_cast<int>(priority)].size(); }
+
+    void Push(QueuedTask &&task, TaskPriority priority) {
+        queues_[static_cast<int>(priority)].emplace_back(std::move(task));
+        ++size_;
+    }
+
+    void Clear() {
+        for (auto &queue : queues_) {
+            queue.Clear();
+        }
+        size_ = 0;
+    }
+
+    // 调用者保证队列非空，priority 返回取出任务的优先级
+    QueuedTask Pop(TaskPriority *priority = nullptr) {
+        int chosen = -1;
+        if (starvation_threshold_ > 0) {
+            for (int level = kLevels - 1; level > 0; --level) {
+                if (!queues_[level].empty() && skipped_[level] >= starvation_threshold_) {
+                    chosen = level;
+                    break;
+                }
+            }
+        }
+        if (chosen < 0) {
+            for (int level = 0; level < kLevels; ++level) {
+                if (!queues_[level].empty()) {
+                    chosen = level;
+                    break;
+                }
+            }
+        }
+        for (int level = chosen + 1; level < kLevels; ++level) {
+            if (!queues_[level].empty()) {
+                ++skipped_[level];
+            }
+        }
+        skipped_[chosen] = 0;
+        QueuedTask task = std::move(queues_[chosen].front());
+        queues_[chosen].pop_front();
+        --size_;
+        if (priority != nullptr) {
+            *priority = static_cast<TaskPriority>(chosen);
+        }
+        return task;
+    }
+
+   private:
+    RingQueue<QueuedTask> queues_[kLevels];
+    int skipped_[kLevels] = {0, 0, 0};
+    size_t size_ = 0;
+    int starvation_threshold_;
+};
+
 class ThreadPool {
    public:
     using PoolSeconds = std::chrono::seconds;
 
+    /**
+     * 任务调度模式
+     * kGlobalQueue: 所有任务进入同一个全局队列，由 task_mutex_ 保护
+     *
+     * kWorkStealing: 每个线程拥有自己的本地双端队列，线程池内部线程提交的任务进入该线程的本地队列，
+     * 外部线程提交的任务进入全局队列；空闲线程依次从本地队列、全局队列、随机的其他线程队列中获取任务
+     */
+    enum class SchedulerMode { kGlobalQueue = 0, kWorkStealing = 1 };
+
+    /**
+     * Cache 线程自适应伸缩配置
+     * enabled: 开启后提交任务时不再直接创建 Cache 线程，而是由独立的控制线程每隔 tick 采样一次队列深度、
+     * 空闲线程数和出队速率，用 队列深度 / 出队速率 估算排队延迟（EWMA 平滑），
+     * 当 队列深度 > 空闲线程数 且估算延迟 > target_latency 连续 grow_hysteresis 次时，
+     * 一次最多新增 max_grow_step 个 Cache 线程，线程总数不超过 max_threads
+     *
+     * idle_timeout: 开启后 Cache 线程空闲超过该时间即被回收，取代秒级的 time_out
+     */
+    struct ElasticConfig {
+        bool enabled = false;
+        std::chrono::milliseconds tick{10};
+        std::chrono::microseconds target_latency{1000};
+        int grow_hysteresis = 2;
+        int max_grow_step = 4;
+        std::chrono::milliseconds idle_timeout{200};
+    };
+
+    /**
+     * 自适应伸缩的实时统计，由 GetElasticStats 返回
+     * queue_latency_us 为估算的排队延迟（EWMA），dequeue_rate 为最近一个采样周期内每秒出队的任务数，
+     * grow_events/shrink_events 为累计新增/回收的 Cache 线程数，overload_ticks 为当前连续过载的采样次数
+     */
+    struct ElasticStats {
+        int total_threads = 0;
+        int waiting_threads = 0;
+        int queue_depth = 0;
+        double queue_latency_us = 0;
+        double dequeue_rate = 0;
+        uint64_t grow_events = 0;
+        uint64_t shrink_events = 0;
+        int overload_ticks = 0;
+    };
+
+    /**
+     * 运行指标，由 GetMetrics 返回，ExportMetrics 导出到 cMetrics::Registry 的也是同一份数据
+     * submitted/completed/rejected 为累计提交、执行完成、因线程池关闭或不可用被拒绝的任务数，queue_depth 为尚未开始执行的任务数，
+     * steal_attempts/steal_hits 为工作窃取模式下尝试窃取和窃取成功的次数；
+     * queue_wait_ns 为抽样记录的任务从 Post/Submit 入队到开始执行的时间，run_ns 为抽样记录的任务执行时间，
+     * idle_wait_ns 为工作线程每次阻塞等待任务的时间，抽样间隔见 cMetrics::SetSampleRate
+     */
+    struct Metrics {
+        uint64_t submitted = 0;
+        uint64_t completed = 0;
+        uint64_t rejected = 0;
+        uint64_t steal_attempts = 0;
+        uint64_t steal_hits = 0;
+        int queue_depth = 0;
+        int total_threads = 0;
+        int waiting_threads = 0;
+        cMetrics::HistogramSnapshot queue_wait_ns;
+        cMetrics::HistogramSnapshot run_ns;
+        cMetrics::HistogramSnapshot idle_wait_ns;
+    };
+
     /** 线程池的配置
      * core_threads: 核心线程个数，线程池中最少拥有的线程个数，初始化就会创建好的线程，常驻于线程池
      *
@@ -35,12 +240,40 @@ class ThreadPool {
      *
      * time_out: Cache线程的超时时间，Cache线程指的是max_threads-core_threads的线程,
      * 当time_out时间内没有执行任务，此线程就会被自动回收
+     *
+     * scheduler_mode: 任务调度方式，默认所有任务进入同一个全局队列；
+     * kWorkStealing 模式下每个线程拥有本地队列，详见 SchedulerMode
+     *
+     * starvation_threshold: 全局队列中非空的低优先级队列最多被连续跳过的次数，超过后优先执行一个低优先级任务，
+     * <= 0 表示严格按优先级执行，详见 PriorityTaskQueue
+     *
+     * cpu_set: 线程允许运行的 CPU 编号列表，为空表示不设置亲和性（仅 Linux 生效）
+     *
+     * pin_core_threads: 为 true 时第 i 个核心线程绑定到 cpu_set[i % cpu_set.size()] 这一个 CPU 上，
+     * 否则所有线程都绑定到整个 cpu_set；Cache 线程总是绑定到整个 cpu_set
+     *
+     * thread_name: 线程名前缀，非空时线程名为 "thread_name-线程ID"，超过 15 个字符会被截断，便于在 top/perf 中区分
+     *
+     * elastic: Cache 线程的自适应伸缩配置，详见 ElasticConfig
+     *
+     * task_resource: 非空时，Post/Submit 中无法内联存放进 SmallTask 的任务从该 memory_resource 分配（例如 cAllocator::SyncSizeClassPool），
+     * 任务在工作线程上释放，资源必须线程安全并且比线程池活得更久
+     *
+     * timer_tick: RunAfter/RunEvery 使用的时间轮精度，第一次设置定时器时才创建时间轮线程
      */
     struct ThreadPoolConfig {
         int core_threads;
         int max_threads;
         int max_task_size;
         PoolSeconds time_out;
+        SchedulerMode scheduler_mode = SchedulerMode::kGlobalQueue;
+        int starvation_threshold = 16;
+        std::vector<int> cpu_set = {};
+        bool pin_core_threads = false;
+        std::string thread_name = {};
+        ElasticConfig elastic = {};
+        std::pmr::memory_resource *task_resource = nullptr;
+        std::chrono::milliseconds timer_tick = std::chrono::milliseconds(1);
     };
 
     /**
@@ -60,27 +293,44 @@ class ThreadPool {
 
     /**
      * 线程池中线程存在的基本单位，每个线程都有个自定义的ID，有线程种类标识和状态
+     * local_tasks 为 kWorkStealing 模式下的本地任务队列：本线程从尾部取，其他线程从头部窃取，
+     * 只存放普通优先级的任务，指定了高/低优先级的任务总是进入全局队列
      */
     struct ThreadWrapper {
         ThreadPtr ptr;
         ThreadId id;
         ThreadFlagAtomic flag;
         ThreadStateAtomic state;
+        std::mutex local_mutex;
+        RingQueue<QueuedTask> local_tasks;
+        std::atomic<bool> finished;
 
         ThreadWrapper() {
             ptr = nullptr;
             id = 0;
             state.store(ThreadState::kInit);
+            finished.store(false);
         }
     };
     using ThreadWrapperPtr = std::shared_ptr<ThreadWrapper>;
     using ThreadPoolLock = std::unique_lock<std::mutex>;
+    using StealList = std::vector<ThreadWrapperPtr>;
 
     ThreadPool(ThreadPoolConfig config) : config_(config) {
         this->total_function_num_.store(0);
         this->waiting_thread_num_.store(0);
+        this->pending_task_num_.store(0);
+        this->global_task_num_.store(0);
+        this->global_high_task_num_.store(0);
+        this->task_slab_ = std::make_shared<TaskSlab>();
+        this->tasks_.SetStarvationThreshold(config_.starvation_threshold);
+        std::atomic_store(&this->steal_list_, std::make_shared<const StealList>());
 
         this->thread_id_.store(0);
+        this->live_thread_num_.store(0);
+        this->finished_task_num_.store(0);
+        this->grow_event_num_.store(0);
+        this->shrink_event_num_.store(0);
         this->is_shutdown_.store(false);
         this->is_shutdown_now_.store(false);
 
@@ -91,7 +341,18 @@ class ThreadPool {
         }
     }
 
-    ~ThreadPool() { ShutDown(); }
+    // 在任务中关闭时调用线程被 detach，析构时等待它执行完退出流程，之后才能释放成员
+    ~ThreadPool() {
+        ShutDown();
+        int self_num = 0;
+        {
+            std::lock_guard<std::mutex> lock(this->threads_mutex_);
+            self_num = (this->detached_thread_id_ == std::this_thread::get_id()) ? 1 : 0;
+        }
+        while (this->live_thread_num_.load() > self_num) {
+            std::this_thread::yield();
+        }
+    }
 
     bool Reset(ThreadPoolConfig config) {
         if (!IsValidConfig(config)) {
@@ -100,6 +361,13 @@ class ThreadPool {
         if (config_.core_threads != config.core_threads) {
             return false;
         }
+        if (config_.scheduler_mode != config.scheduler_mode || config_.elastic.enabled != config.elastic.enabled) {
+            return false;
+        }
+        {
+            ThreadPoolLock lock(this->task_mutex_);
+            this->tasks_.SetStarvationThreshold(config.starvation_threshold);
+        }
         config_ = config;
         return true;
     }
@@ -110,167 +378,1095 @@ class ThreadPool {
             return false;
         }
         int core_thread_num = config_.core_threads;
-        cout << "Init thread num " << core_thread_num << endl;
+        CTHREAD_TRACE(TraceEvent::kInitBegin, -1, core_thread_num);
         while (core_thread_num-- > 0) {
             AddThread(GetNextThreadId());
         }
-        cout << "Init thread end" << endl;
+        if (config_.elastic.enabled && !controller_thread_.joinable()) {
+            controller_thread_ = std::thread([this]() { ControllerLoop(); });
+        }
+        CTHREAD_TRACE(TraceEvent::kInitEnd, -1, 0);
         return true;
     }
 
     // 获取正在处于等待状态的线程的个数
     int GetWaitingThreadSize() { return this->waiting_thread_num_.load(); }
 
-    // 获取线程池中当前线程的总个数
-    int GetTotalThreadSize() { return this->worker_threads_.size(); }
+    // 获取线程池中当前线程的总个数（不包括已经超时退出的 Cache 线程）
+    int GetTotalThreadSize() { return this->live_thread_num_.load(); }
+
+    // 获取队列中尚未开始执行的任务个数
+    int GetPendingTaskSize() { return this->pending_task_num_.load(); }
+
+    // 获取自适应伸缩的实时统计，未开启 elastic 时排队延迟和出队速率始终为 0
+    ElasticStats GetElasticStats() {
+        ElasticStats stats;
+        {
+            std::lock_guard<std::mutex> lock(this->controller_mutex_);
+            stats = this->elastic_stats_;
+        }
+        stats.total_threads = GetTotalThreadSize();
+        stats.waiting_threads = GetWaitingThreadSize();
+        stats.queue_depth = GetPendingTaskSize();
+        stats.grow_events = this->grow_event_num_.load();
+        stats.shrink_events = this->shrink_event_num_.load();
+        return stats;
+    }
+
+    // 获取运行指标，详见 Metrics
+    Metrics GetMetrics() {
+        Metrics metrics;
+        // 先读 completed，completed >= submitted 时可以确定读取时所有已提交的任务都执行完了
+        metrics.completed = this->finished_task_num_.load();
+        metrics.submitted = static_cast<uint64_t>(this->total_function_num_.load());
+        metrics.rejected = this->rejected_task_num_.Value();
+        metrics.steal_attempts = this->steal_attempt_num_.Value();
+        metrics.steal_hits = this->steal_hit_num_.Value();
+        metrics.queue_depth = GetPendingTaskSize();
+        metrics.total_threads = GetTotalThreadSize();
+        metrics.waiting_threads = GetWaitingThreadSize();
+        metrics.queue_wait_ns = this->queue_wait_ns_.Snapshot();
+        metrics.run_ns = this->run_ns_.Snapshot();
+        metrics.idle_wait_ns = this->idle_wait_ns_.Snapshot();
+        return metrics;
+    }
+
+    /**
+     * 把运行指标以 prefix.submitted、prefix.queue_wait_ns.p99 等名称注册到 registry，每次 Collect 时读取 GetMetrics；
+     * 再次调用时替换之前的注册，线程池析构时自动注销。不要与 GetMetrics 以外的接口并发调用
+     */
+    void ExportMetrics(const std::string &prefix, cMetrics::Registry &registry = cMetrics::Registry::Global()) {
+        this->metrics_registration_ = registry.AddCollector([this, prefix](cMetrics::Samples &samples) {
+            Metrics metrics = GetMetrics();
+            samples.push_back({prefix + ".submitted", static_cast<double>(metrics.submitted)});
+            samples.push_back({prefix + ".completed", static_cast<double>(metrics.completed)});
+            samples.push_back({prefix + ".rejected", static_cast<double>(metrics.rejected)});
+            samples.push_back({prefix + ".steal_attempts", static_cast<double>(metrics.steal_attempts)});
+            samples.push_back({prefix + ".steal_hits", static_cast<double>(metrics.steal_hits)});
+            samples.push_back({prefix + ".queue_depth", static_cast<double>(metrics.queue_depth)});
+            samples.push_back({prefix + ".total_threads", static_cast<double>(metrics.total_threads)});
+            samples.push_back({prefix + ".waiting_threads", static_cast<double>(metrics.waiting_threads)});
+            cMetrics::AppendHistogram(samples, prefix + ".queue_wait_ns", metrics.queue_wait_ns);
+            cMetrics::AppendHistogram(samples, prefix + ".run_ns", metrics.run_ns);
+            cMetrics::AppendHistogram(samples, prefix + ".idle_wait_ns", metrics.idle_wait_ns);
+        });
+    }
+
+    /**
+     * 调整线程数到 thread_num，限制在 [core_threads, max_threads] 内
+     * 扩容时新增 Cache 线程，缩容时停止处于等待状态的 Cache 线程，核心线程不会被回收
+     */
+    void Resize(int thread_num) {
+        thread_num = std::min(std::max(thread_num, config_.core_threads), config_.max_threads);
+        int old_thread_num = GetTotalThreadSize();
+        CTHREAD_TRACE(TraceEvent::kResize, old_thread_num, thread_num);
+        if (thread_num > old_thread_num) {
+            while (thread_num-- > old_thread_num) {
+                AddThread(GetNextThreadId(), ThreadFlag::kCache);
+            }
+        } else {
+            int diff = old_thread_num - thread_num;
+            {
+                // 被停止的线程退出后由 ReapFinishedThreads/JoinAll 负责 join
+                std::lock_guard<std::mutex> lock(this->threads_mutex_);
+                for (auto &thread_ptr : worker_threads_) {
+                    if (diff == 0) {
+                        break;
+                    }
+                    // 只停止仍在等待的线程：线程同时被唤醒并标记为运行时 CAS 失败，跳过该线程
+                    ThreadState expected = ThreadState::kWaiting;
+                    if (thread_ptr->flag.load() == ThreadFlag::kCache &&
+                        thread_ptr->state.compare_exchange_strong(expected, ThreadState::kStop)) {
+                        --diff;
+                    }
+                }
+            }
+            { ThreadPoolLock lock(this->task_mutex_); }
+            this->task_cv_.notify_all();
+        }
+    }
 
     // 放在线程池中执行函数
     template <typename F, typename... Args>
     auto Run(F &&f, Args &&... args) -> std::shared_ptr<std::future<std::result_of_t<F(Args...)>>> {
-        if (this->is_shutdown_.load() || this->is_shutdown_now_.load() || !IsAvailable()) {
+        if (!IsAccepting()) {
+            this->rejected_task_num_.Add(1);
             return nullptr;
         }
-        if (GetWaitingThreadSize() == 0 && GetTotalThreadSize() < config_.max_threads) {
-            AddThread(GetNextThreadId(), ThreadFlag::kCache);
-        }
-
         using return_type = std::result_of_t<F(Args...)>;
         auto task = std::make_shared<std::packaged_task<return_type()>>(
             std::bind(std::forward<F>(f), std::forward<Args>(args)...));
-        total_function_num_++;
-
         std::future<return_type> res = task->get_future();
-        {
-            ThreadPoolLock lock(this->task_mutex_);
-            this->tasks_.emplace([task]() { (*task)(); });
+        if (!Enqueue([task]() { (*task)(); })) {
+            return nullptr;
         }
-        this->task_cv_.notify_one();
         return std::make_shared<std::future<std::result_of_t<F(Args...)>>>(std::move(res));
     }
 
+    /**
+     * 放在线程池中执行函数，不关心返回值（fire-and-forget）
+     * 任务以 SmallTask 形式入队，可调用对象及参数不超过 SmallTask::kInlineSize 时整个提交过程不分配内存，
+     * 任务抛出的异常会被忽略
+     * @return 线程池不可用时返回 false
+     */
+    template <typename F, typename... Args>
+    bool Post(F &&f, Args &&... args) {
+        return PostWithPriority(TaskPriority::kNormal, std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    // 以指定优先级执行 Post
+    template <typename F, typename... Args>
+    bool PostWithPriority(TaskPriority priority, F &&f, Args &&... args) {
+        if constexpr (sizeof...(Args) == 0) {
+            return Enqueue(MakeTask(std::forward<F>(f)), priority);
+        } else {
+            return Enqueue(
+                MakeTask([func = std::forward<F>(f), params = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                    std::apply(func, params);
+                }),
+                priority);
+        }
+    }
+
+#if defined(__cpp_impl_coroutine)
+    /**
+     * 协程切换到线程池中继续执行：co_await pool.Schedule();
+     * 恢复协程的任务只有一个协程句柄，以 SmallTask 形式入队不分配内存；线程池不接受任务时协程在当前线程继续执行
+     */
+    auto Schedule() { return ScheduleAwaiter{this}; }
+
+    struct ScheduleAwaiter {
+        ThreadPool *pool;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) {
+            return pool->Post([handle]() { handle.resume(); });
+        }
+        void await_resume() const noexcept {}
+    };
+#endif
+
+    /**
+     * 放在线程池中执行函数，直接返回 std::future
+     * promise 的共享状态从线程池私有的 TaskSlab 中分配，避免 Run 中 packaged_task、std::function、
+     * shared_ptr<future> 的多次堆分配；线程池不可用时返回的 future 在 get() 时抛出 broken_promise
+     */
+    template <typename F, typename... Args>
+    auto Submit(F &&f, Args &&... args) -> std::future<std::result_of_t<F(Args...)>> {
+        return SubmitWithPriority(TaskPriority::kNormal, std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    // 以指定优先级执行 Submit
+    template <typename F, typename... Args>
+    auto SubmitWithPriority(TaskPriority priority, F &&f, Args &&... args)
+        -> std::future<std::result_of_t<F(Args...)>> {
+        using return_type = std::result_of_t<F(Args...)>;
+        std::promise<return_type> promise(std::allocator_arg, SlabAllocator<return_type>(this->task_slab_));
+        std::future<return_type> res = promise.get_future();
+        auto task = [promise = std::move(promise), func = std::forward<F>(f),
+                     params = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+            try {
+                if constexpr (std::is_void<return_type>::value) {
+                    std::apply(func, params);
+                    promise.set_value();
+                } else {
+                    promise.set_value(std::apply(func, params));
+                }
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        };
+        Enqueue(MakeTask(std::move(task)), priority);
+        return res;
+    }
+
+    /**
+     * 批量提交任务：只获取一次队列锁放入全部任务，并按任务数唤醒相应数量的等待线程
+     * tasks 中的任务会被移走，任务抛出的异常会被忽略
+     * @return 成功提交的任务个数，线程池不可用时返回 0
+     */
+    size_t PostBatch(std::vector<SmallTask> &tasks, TaskPriority priority = TaskPriority::kNormal) {
+        size_t count =
+            EnqueueBatch(tasks.size(), [&tasks](size_t i) { return std::move(tasks[i]); }, priority);
+        if (count > 0) {
+            tasks.clear();
+        }
+        return count;
+    }
+
+    /**
+     * delay 之后在线程池中执行一次 f，任务抛出的异常会被忽略
+     * 定时器放在分层时间轮中，设置和取消都是 O(1)；同一 tick 到期的任务通过 PostBatch 一次提交，
+     * 线程池已经开始关闭时到期的任务直接丢弃
+     * @return 定时器ID，线程池不可用时返回 0
+     */
+    template <typename Rep, typename Period, typename F>
+    cTimer::TimerId RunAfter(std::chrono::duration<Rep, Period> delay, F &&f) {
+        std::lock_guard<std::mutex> lock(this->timer_mutex_);
+        cTimer::TimingWheel *timer = GetTimerLocked();
+        return timer != nullptr ? timer->RunAfter(delay, std::forward<F>(f)) : 0;
+    }
+
+    /**
+     * 每隔 interval 在线程池中执行一次 f，第一次在 interval 之后；f 执行得比 interval 慢时会有多次调用同时进行
+     * @return 定时器ID，线程池不可用时返回 0
+     */
+    template <typename Rep, typename Period, typename F>
+    cTimer::TimerId RunEvery(std::chrono::duration<Rep, Period> interval, F &&f) {
+        std::lock_guard<std::mutex> lock(this->timer_mutex_);
+        cTimer::TimingWheel *timer = GetTimerLocked();
+        return timer != nullptr ? timer->RunEvery(interval, std::forward<F>(f)) : 0;
+    }
+
+    /**
+     * 取消 RunAfter/RunEvery 设置的定时器，已经提交到线程池的任务仍会执行
+     * @return 定时器还在等待时返回 true
+     */
+    bool CancelTimer(cTimer::TimerId id) {
+        std::lock_guard<std::mutex> lock(this->timer_mutex_);
+        return this->timer_ != nullptr && this->timer_->Cancel(id);
+    }
+
+    /**
+     * 并行执行 [begin, end) 区间内每个下标的 func(i)
+     * 区间按 grain 切分成块后通过 PostBatch 一次提交，grain 为 0 时按线程数自动切分（每个线程约 4 块）
+     * 返回的 future 在所有块执行完成后就绪，任意一块抛出的第一个异常会通过 future 传出，之后未开始的块直接跳过
+     * 注意：不要在本线程池的任务中阻塞等待该 future，所有线程都在等待时会死锁
+     */
+    template <typename Index, typename Func>
+    std::future<void> ParallelFor(Index begin, Index end, Func &&func, size_t grain = 0) {
+        static_assert(std::is_integral<Index>::value, "ParallelFor requires an integral index");
+        auto state = std::make_shared<ParallelForState<std::decay_t<Func>>>(std::forward<Func>(func));
+        std::future<void> res = state->promise.get_future();
+        if (end <= begin) {
+            state->promise.set_value();
+            return res;
+        }
+        size_t total = static_cast<size_t>(end - begin);
+        grain = GetGrainSize(total, grain);
+        size_t chunk_num = (total + grain - 1) / grain;
+        state->remaining.store(chunk_num);
+        EnqueueBatch(chunk_num, [state, begin, total, grain](size_t chunk) {
+            size_t first = chunk * grain;
+            size_t last = std::min(total, first + grain);
+            return [state, lo = begin + static_cast<Index>(first), hi = begin + static_cast<Index>(last)]() {
+                if (!state->failed.load()) {
+                    try {
+                        for (Index i = lo; i < hi; ++i) {
+                            state->func(i);
+                        }
+                    } catch (...) {
+                        state->SetError(std::current_exception());
+                    }
+                }
+                state->FinishChunk();
+            };
+        });
+        return res;
+    }
+
+    /**
+     * 并行归约 [begin, end) 区间
+     * body(lo, hi, identity) 计算一块的局部结果，reduce(a, b) 合并两个结果；
+     * 各块结果按区间顺序合并，结果与切分方式无关（要求 reduce 满足结合律）
+     * 切分、异常与等待的约定同 ParallelFor
+     */
+    template <typename Index, typename T, typename Body, typename Reduce>
+    std::future<T> ParallelReduce(Index begin, Index end, T identity, Body &&body, Reduce &&reduce,
+                                  size_t grain = 0) {
+        static_assert(std::is_integral<Index>::value, "ParallelReduce requires an integral index");
+        using State = ParallelReduceState<T, std::decay_t<Body>, std::decay_t<Reduce>>;
+        auto state = std::make_shared<State>(std::forward<Body>(body), std::forward<Reduce>(reduce), identity);
+        std::future<T> res = state->promise.get_future();
+        if (end <= begin) {
+            state->promise.set_value(identity);
+            return res;
+        }
+        size_t total = static_cast<size_t>(end - begin);
+        grain = GetGrainSize(total, grain);
+        size_t chunk_num = (total + grain - 1) / grain;
+        state->remaining.store(chunk_num);
+        state->partials.assign(chunk_num, identity);
+        EnqueueBatch(chunk_num, [state, begin, total, grain](size_t chunk) {
+            size_t first = chunk * grain;
+            size_t last = std::min(total, first + grain);
+            return [state, chunk, lo = begin + static_cast<Index>(first), hi = begin + static_cast<Index>(last)]() {
+                if (!state->failed.load()) {
+                    try {
+                        state->partials[chunk] = state->func(lo, hi, state->identity);
+                    } catch (...) {
+                        state->SetError(std::current_exception());
+                    }
+                }
+                state->FinishChunk();
+            };
+        });
+        return res;
+    }
+
     // 获取当前线程池已经执行过的函数个数
     int GetRunnedFuncNum() { return total_function_num_.load(); }
 
-    // 关掉线程池，内部还没有执行的任务会继续执行
+    // 关掉线程池，内部还没有执行的任务会继续执行，返回时所有线程都已退出并被 join
+    // 在本线程池的任务中调用时，调用线程在任务返回后才退出，由析构函数等待
     void ShutDown() {
         ShutDown(false);
-        cout << "shutdown" << endl;
     }
 
-    // 执行关掉线程池，内部还没有执行的任务直接取消，不会再执行
+    // 执行关掉线程池，内部还没有执行的任务直接取消，不会再执行，返回时所有线程都已退出并被 join
     void ShutDownNow() {
         ShutDown(true);
-        cout << "shutdown now" << endl;
     }
 
     // 当前线程池是否可用
     bool IsAvailable() { return is_available_.load(); }
 
+    using TraceHook = void (*)(TraceEvent event, int thread_id, int value);
+
+    /**
+     * 设置跟踪回调，传入 nullptr 恢复默认的 cout 输出；只有定义 CTHREAD_ENABLE_TRACE 时才会被调用
+     * 回调可能在持有 task_mutex_ 时执行，可以转发到 cLogger 的异步模式以避免阻塞
+     */
+    static void SetTraceHook(TraceHook hook) { TraceHookRef().store(hook != nullptr ? hook : &DefaultTraceHook); }
+
+    static void Trace(TraceEvent event, int thread_id, int value) { TraceHookRef().load()(event, thread_id, value); }
+
    private:
+    static std::atomic<TraceHook> &TraceHookRef() {
+        static std::atomic<TraceHook> hook(&DefaultTraceHook);
+        return hook;
+    }
+
+    static void DefaultTraceHook(TraceEvent event, int thread_id, int value) {
+        switch (event) {
+            case TraceEvent::kInitBegin:
+                cout << "Init thread num " << value << endl;
+                break;
+            case TraceEvent::kInitEnd:
+                cout << "Init thread end" << endl;
+                break;
+            case TraceEvent::kThreadAdd:
+                cout << "AddThread " << thread_id << " flag " << value << endl;
+                break;
+            case TraceEvent::kWaitBegin:
+                cout << "thread id " << thread_id << " running start" << endl;
+                break;
+            case TraceEvent::kWaitEnd:
+                cout << "thread id " << thread_id << " running wait end" << endl;
+                break;
+            case TraceEvent::kThreadStop:
+                cout << "thread id " << thread_id << " state stop" << endl;
+                break;
+            case TraceEvent::kThreadShutdown:
+                cout << "thread id " << thread_id << " shutdown" << endl;
+                break;
+            case TraceEvent::kThreadShutdownNow:
+                cout << "thread id " << thread_id << " shutdown now" << endl;
+                break;
+            case TraceEvent::kThreadExit:
+                cout << "thread id " << thread_id << " running end" << endl;
+                break;
+            case TraceEvent::kShutdown:
+                cout << "shutdown" << endl;
+                break;
+            case TraceEvent::kShutdownNow:
+                cout << "shutdown now" << endl;
+                break;
+            case TraceEvent::kResize:
+                cout << "old num " << thread_id << " resize " << value << endl;
+                break;
+        }
+    }
+
+    bool IsAccepting() { return !this->is_shutdown_.load() && !this->is_shutdown_now_.load() && IsAvailable(); }
+
+    // 第一次设置定时器时创建时间轮，到期的任务批量提交到本线程池；线程池不可用时返回 nullptr，调用者必须持有 timer_mutex_
+    cTimer::TimingWheel *GetTimerLocked() {
+        if (!IsAccepting()) {
+            return nullptr;
+        }
+        if (this->timer_ == nullptr) {
+            this->timer_ = std::make_unique<cTimer::TimingWheel>(
+                config_.timer_tick, [this](std::vector<SmallTask> &tasks) {
+                    // 关闭过程中到期的任务被拒绝并计入 rejected，清空后时间轮不会在自己的线程中执行它们
+                    PostBatch(tasks);
+                    tasks.clear();
+                });
+        }
+        return this->timer_.get();
+    }
+
+    // 按 task_resource 构造任务，未配置时与直接转换为 SmallTask 相同
+    template <typename F>
+    SmallTask MakeTask(F &&f) {
+        if constexpr (std::is_same<std::decay_t<F>, SmallTask>::value) {
+            return std::move(f);
+        } else {
+            return SmallTask(std::allocator_arg, config_.task_resource, std::forward<F>(f));
+        }
+    }
+
+    // 所有提交接口的公共入队路径：按需创建 Cache 线程，再根据调度模式放入对应队列
+    bool Enqueue(SmallTask task, TaskPriority priority = TaskPriority::kNormal) {
+        if (!IsAccepting()) {
+            this->rejected_task_num_.Add(1);
+            return false;
+        }
+        QueuedTask queued(std::move(task), SampleEnqueueTime());
+        if (!config_.elastic.enabled && GetWaitingThreadSize() == 0 && GetTotalThreadSize() < config_.max_threads) {
+            AddThread(GetNextThreadId(), ThreadFlag::kCache);
+        }
+        total_function_num_++;
+        if (config_.scheduler_mode == SchedulerMode::kWorkStealing) {
+            PushWorkStealing(std::move(queued), priority);
+        } else {
+            {
+                ThreadPoolLock lock(this->task_mutex_);
+                this->tasks_.Push(std::move(queued), priority);
+                ++this->pending_task_num_;
+            }
+            this->task_cv_.notify_one();
+        }
+        return true;
+    }
+
+    /**
+     * 批量入队：make_task(i) 生成第 i 个任务，全部任务在一次加锁内放入队列
+     * 未开启 elastic 时按需一次性补足 Cache 线程，再按任务数唤醒等待线程
+     */
+    template <typename Generator>
+    size_t EnqueueBatch(size_t count, Generator &&make_task, TaskPriority priority = TaskPriority::kNormal) {
+        if (count == 0) {
+            return 0;
+        }
+        if (!IsAccepting()) {
+            this->rejected_task_num_.Add(count);
+            return 0;
+        }
+        int spawn_num = std::min(static_cast<int>(std::min<size_t>(count, config_.max_threads)) - GetWaitingThreadSize(),
+                                 config_.max_threads - GetTotalThreadSize());
+        while (!config_.elastic.enabled && spawn_num-- > 0) {
+            AddThread(GetNextThreadId(), ThreadFlag::kCache);
+        }
+        total_function_num_ += static_cast<int>(count);
+
+        WorkerContext &context = CurrentWorker();
+        if (config_.scheduler_mode == SchedulerMode::kWorkStealing && priority == TaskPriority::kNormal &&
+            context.pool == this && context.wrapper != nullptr) {
+            {
+                std::lock_guard<std::mutex> lock(context.wrapper->local_mutex);
+                for (size_t i = 0; i < count; ++i) {
+                    context.wrapper->local_tasks.emplace_back(make_task(i), SampleEnqueueTime());
+                }
+            }
+            this->pending_task_num_ += static_cast<int>(count);
+            if (this->waiting_thread_num_.load() > 0) {
+                { ThreadPoolLock lock(this->task_mutex_); }
+                NotifyWorkers(count);
+            }
+            return count;
+        }
+        {
+            ThreadPoolLock lock(this->task_mutex_);
+            for (size_t i = 0; i < count; ++i) {
+                this->tasks_.Push(QueuedTask(make_task(i), SampleEnqueueTime()), priority);
+            }
+            this->pending_task_num_ += static_cast<int>(count);
+            if (config_.scheduler_mode == SchedulerMode::kWorkStealing) {
+                this->global_task_num_ += static_cast<int>(count);
+                if (priority == TaskPriority::kHigh) {
+                    this->global_high_task_num_ += static_cast<int>(count);
+                }
+            }
+        }
+        NotifyWorkers(count);
+        return count;
+    }
+
+    void NotifyWorkers(size_t count) {
+        if (count >= static_cast<size_t>(GetWaitingThreadSize())) {
+            this->task_cv_.notify_all();
+        } else {
+            while (count-- > 0) {
+                this->task_cv_.notify_one();
+            }
+        }
+    }
+
+    size_t GetGrainSize(size_t total, size_t grain) {
+        if (grain > 0) {
+            return grain;
+        }
+        size_t chunk_num = static_cast<size_t>(std::max(config_.max_threads, 1)) * 4;
+        return std::max<size_t>(1, (total + chunk_num - 1) / chunk_num);
+    }
+
+    /**
+     * ParallelFor/ParallelReduce 一次调用中所有块共享的状态：记录剩余块数和第一个异常，
+     * 最后完成的块负责设置 future 的结果
+     */
+    struct ParallelStateBase {
+        void SetError(std::exception_ptr e) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = e;
+                failed.store(true);
+            }
+        }
+
+        // 返回 true 表示当前块是最后一块
+        bool FinishChunk() { return remaining.fetch_sub(1) == 1; }
+
+        std::atomic<size_t> remaining{0};
+        std::atomic<bool> failed{false};
+        std::mutex error_mutex;
+        std::exception_ptr error;
+    };
+
+    template <typename Func>
+    struct ParallelForState : ParallelStateBase {
+        template <typename F>
+        explicit ParallelForState(F &&f) : func(std::forward<F>(f)) {}
+
+        void FinishChunk() {
+            if (ParallelStateBase::FinishChunk()) {
+                if (this->error) {
+                    promise.set_exception(this->error);
+                } else {
+                    promise.set_value();
+                }
+            }
+        }
+
+        Func func;
+        std::promise<void> promise;
+    };
+
+    template <typename T, typename Body, typename Reduce>
+    struct ParallelReduceState : ParallelStateBase {
+        template <typename B, typename R>
+        ParallelReduceState(B &&b, R &&r, T init)
+            : func(std::forward<B>(b)), reduce(std::forward<R>(r)), identity(std::move(init)) {}
+
+        void FinishChunk() {
+            if (ParallelStateBase::FinishChunk()) {
+                if (this->error) {
+                    promise.set_exception(this->error);
+                    return;
+                }
+                try {
+                    T result = identity;
+                    for (auto &partial : partials) {
+                        result = reduce(std::move(result), std::move(partial));
+                    }
+                    promise.set_value(std::move(result));
+                } catch (...) {
+                    promise.set_exception(std::current_exception());
+                }
+            }
+        }
+
+        Body func;
+        Reduce reduce;
+        T identity;
+        std::vector<T> partials;
+        std::promise<T> promise;
+    };
+
+    // Post/PostBatch 的任务没有 future 可以传递异常，这里吞掉异常避免工作线程退出
+    void RunTask(QueuedTask &task) {
+        if (task.enqueue_ns != 0) {
+            this->queue_wait_ns_.Record(cMetrics::NowNs() - task.enqueue_ns);
+        }
+        {
+            cMetrics::ScopedTimer timer(cMetrics::ShouldSample<RunSample>() ? &this->run_ns_ : nullptr);
+            try {
+                task.task();
+            } catch (...) {
+            }
+        }
+        this->finished_task_num_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * 设置关闭标志后唤醒并 join 所有线程；标志在 task_mutex_ 内设置，避免等待中的线程错过唤醒
+     * 在本线程池的任务中调用时当前线程无法 join 自己，会被 detach
+     * ShutDownNow 时 join 之后丢弃剩余任务，对应的 future 会得到 broken_promise
+     */
     void ShutDown(bool is_now) {
-        if (is_available_.load()) {
+        if (!is_available_.exchange(false)) {
+            return;
+        }
+        // 先停止时间轮，之后不会再有到期的定时任务提交进来
+        std::unique_ptr<cTimer::TimingWheel> timer;
+        {
+            std::lock_guard<std::mutex> lock(this->timer_mutex_);
+            timer.swap(this->timer_);
+        }
+        timer.reset();
+        {
+            ThreadPoolLock lock(this->task_mutex_);
             if (is_now) {
                 this->is_shutdown_now_.store(true);
             } else {
                 this->is_shutdown_.store(true);
             }
-            this->task_cv_.notify_all();
-            is_available_.store(false);
+        }
+        this->task_cv_.notify_all();
+        { std::lock_guard<std::mutex> lock(this->controller_mutex_); }
+        this->controller_cv_.notify_all();
+        if (this->controller_thread_.joinable()) {
+            this->controller_thread_.join();
+        }
+        JoinAll();
+        if (is_now) {
+            ThreadPoolLock lock(this->task_mutex_);
+            this->tasks_.Clear();
+            this->global_task_num_.store(0);
+            this->global_high_task_num_.store(0);
+            this->pending_task_num_.store(0);
+        }
+        // 只在真正执行关闭时记录，重复调用（例如析构时）直接返回
+        CTHREAD_TRACE(is_now ? TraceEvent::kShutdownNow : TraceEvent::kShutdown, -1, 0);
+    }
+
+    void JoinAll() {
+        std::list<ThreadWrapperPtr> threads;
+        {
+            std::lock_guard<std::mutex> lock(this->threads_mutex_);
+            threads.swap(this->worker_threads_);
+        }
+        for (auto &thread_ptr : threads) {
+            if (!thread_ptr->ptr || !thread_ptr->ptr->joinable()) {
+                continue;
+            }
+            if (thread_ptr->ptr->get_id() == std::this_thread::get_id()) {
+                {
+                    std::lock_guard<std::mutex> lock(this->threads_mutex_);
+                    this->detached_thread_id_ = std::this_thread::get_id();
+                }
+                thread_ptr->ptr->detach();
+            } else {
+                thread_ptr->ptr->join();
+            }
+        }
+    }
+
+    // join 已经退出的线程（超时回收的 Cache 线程），调用者持有 threads_mutex_
+    void ReapFinishedThreads() {
+        for (auto iter = worker_threads_.begin(); iter != worker_threads_.end();) {
+            if ((*iter)->finished.load()) {
+                if ((*iter)->ptr->joinable()) {
+                    (*iter)->ptr->join();
+                }
+                iter = worker_threads_.erase(iter);
+            } else {
+                ++iter;
+            }
         }
     }
 
     void AddThread(int id) { AddThread(id, ThreadFlag::kCore); }
 
     void AddThread(int id, ThreadFlag thread_flag) {
-        cout << "AddThread " << id << " flag " << static_cast<int>(thread_flag) << endl;
+        std::lock_guard<std::mutex> lock(this->threads_mutex_);
+        if (this->is_shutdown_ || this->is_shutdown_now_) {
+            return;
+        }
+        ReapFinishedThreads();
+        CTHREAD_TRACE(TraceEvent::kThreadAdd, id, static_cast<int>(thread_flag));
         ThreadWrapperPtr thread_ptr = std::make_shared<ThreadWrapper>();
         thread_ptr->id.store(id);
         thread_ptr->flag.store(thread_flag);
+        if (config_.scheduler_mode == SchedulerMode::kWorkStealing) {
+            RegisterStealTarget(thread_ptr);
+        }
+        ++this->live_thread_num_;
         auto func = [this, thread_ptr]() {
-            for (;;) {
-                std::function<void()> task;
-                {
-                    ThreadPoolLock lock(this->task_mutex_);
-                    if (thread_ptr->state.load() == ThreadState::kStop) {
-                        break;
-                    }
-                    cout << "thread id " << thread_ptr->id.load() << " running start" << endl;
-                    thread_ptr->state.store(ThreadState::kWaiting);
-                    ++this->waiting_thread_num_;
-                    bool is_timeout = false;
-                    if (thread_ptr->flag.load() == ThreadFlag::kCore) {
-                        this->task_cv_.wait(lock, [this, thread_ptr] {
-                            return (this->is_shutdown_ || this->is_shutdown_now_ || !this->tasks_.empty() ||
-                                    thread_ptr->state.load() == ThreadState::kStop);
-                        });
-                    } else {
-                        this->task_cv_.wait_for(lock, this->config_.time_out, [this, thread_ptr] {
-                            return (this->is_shutdown_ || this->is_shutdown_now_ || !this->tasks_.empty() ||
-                                    thread_ptr->state.load() == ThreadState::kStop);
-                        });
-                        is_timeout = !(this->is_shutdown_ || this->is_shutdown_now_ || !this->tasks_.empty() ||
-                                       thread_ptr->state.load() == ThreadState::kStop);
-                    }
-                    --this->waiting_thread_num_;
-                    cout << "thread id " << thread_ptr->id.load() << " running wait end" << endl;
-
-                    if (is_timeout) {
-                        thread_ptr->state.store(ThreadState::kStop);
-                    }
-
-                    if (thread_ptr->state.load() == ThreadState::kStop) {
-                        cout << "thread id " << thread_ptr->id.load() << " state stop" << endl;
-                        break;
-                    }
-                    if (this->is_shutdown_ && this->tasks_.empty()) {
-                        cout << "thread id " << thread_ptr->id.load() << " shutdown" << endl;
-                        break;
-                    }
-                    if (this->is_shutdown_now_) {
-                        cout << "thread id " << thread_ptr->id.load() << " shutdown now" << endl;
-                        break;
-                    }
-                    thread_ptr->state.store(ThreadState::kRunning);
-                    task = std::move(this->tasks_.front());
-                    this->tasks_.pop();
-                }
-                task();
+            ApplyThreadAttributes(thread_ptr.get());
+            if (config_.scheduler_mode == SchedulerMode::kWorkStealing) {
+                WorkStealingLoop(thread_ptr);
+            } else {
+                GlobalQueueLoop(thread_ptr);
             }
-            cout << "thread id " << thread_ptr->id.load() << " running end" << endl;
+            --this->live_thread_num_;
+            thread_ptr->finished.store(true);
         };
         thread_ptr->ptr = std::make_shared<std::thread>(std::move(func));
-        if (thread_ptr->ptr->joinable()) {
-            thread_ptr->ptr->detach();
-        }
         this->worker_threads_.emplace_back(std::move(thread_ptr));
     }
 
-    void Resize(int thread_num) {
-        if (thread_num < config_.core_threads) return;
-        int old_thread_num = worker_threads_.size();
-        cout << "old num " << old_thread_num << " resize " << thread_num << endl;
-        if (thread_num > old_thread_num) {
-            while (thread_num-- > old_thread_num) {
-                AddThread(GetNextThreadId());
+    // 在新线程内设置线程名和 CPU 亲和性，失败时忽略
+    void ApplyThreadAttributes(ThreadWrapper *wrapper) {
+        std::string name;
+        if (!config_.thread_name.empty()) {
+            name = config_.thread_name + "-" + std::to_string(wrapper->id.load());
+            if (name.size() > 15) {
+                name.resize(15);
             }
-        } else {
-            int diff = old_thread_num - thread_num;
-            auto iter = worker_threads_.begin();
-            while (iter != worker_threads_.end()) {
-                if (diff == 0) {
+        }
+#if defined(__linux__)
+        if (!name.empty()) {
+            pthread_setname_np(pthread_self(), name.c_str());
+        }
+        if (!config_.cpu_set.empty()) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            if (config_.pin_core_threads && wrapper->flag.load() == ThreadFlag::kCore) {
+                CPU_SET(config_.cpu_set[wrapper->id.load() % config_.cpu_set.size()], &cpus);
+            } else {
+                for (int cpu : config_.cpu_set) {
+                    CPU_SET(cpu, &cpus);
+                }
+            }
+            pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        }
+#elif defined(__APPLE__)
+        if (!name.empty()) {
+            pthread_setname_np(name.c_str());
+        }
+#endif
+    }
+
+    // 全局队列模式的线程执行体：所有线程竞争同一个 tasks_
+    void GlobalQueueLoop(ThreadWrapperPtr thread_ptr) {
+        for (;;) {
+            QueuedTask task;
+            {
+                ThreadPoolLock lock(this->task_mutex_);
+                if (thread_ptr->state.load() == ThreadState::kStop) {
                     break;
                 }
-                auto thread_ptr = *iter;
-                if (thread_ptr->flag.load() == ThreadFlag::kCache &&
-                    thread_ptr->state.load() == ThreadState::kWaiting) {  // wait
-                    thread_ptr->state.store(ThreadState::kStop);          // stop;
-                    --diff;
-                    iter = worker_threads_.erase(iter);
+                CTHREAD_TRACE(TraceEvent::kWaitBegin, thread_ptr->id.load(), 0);
+                SetStateUnlessStopped(*thread_ptr, ThreadState::kWaiting);
+                ++this->waiting_thread_num_;
+                // 队列非空时不会阻塞，只记录真正等待的时间
+                uint64_t wait_start_ns = this->tasks_.empty() ? cMetrics::NowNs() : 0;
+                bool is_timeout = false;
+                if (thread_ptr->flag.load() == ThreadFlag::kCore) {
+                    this->task_cv_.wait(lock, [this, thread_ptr] {
+                        return (this->is_shutdown_ || this->is_shutdown_now_ || !this->tasks_.empty() ||
+                                thread_ptr->state.load() == ThreadState::kStop);
+                    });
                 } else {
-                    ++iter;
+                    this->task_cv_.wait_for(lock, GetCacheIdleTimeout(), [this, thread_ptr] {
+                        return (this->is_shutdown_ || this->is_shutdown_now_ || !this->tasks_.empty() ||
+                                thread_ptr->state.load() == ThreadState::kStop);
+                    });
+                    is_timeout = !(this->is_shutdown_ || this->is_shutdown_now_ || !this->tasks_.empty() ||
+                                   thread_ptr->state.load() == ThreadState::kStop);
+                }
+                --this->waiting_thread_num_;
+                if (wait_start_ns != 0) {
+                    this->idle_wait_ns_.Record(cMetrics::NowNs() - wait_start_ns);
+                }
+                CTHREAD_TRACE(TraceEvent::kWaitEnd, thread_ptr->id.load(), 0);
+
+                if (is_timeout) {
+                    thread_ptr->state.store(ThreadState::kStop);
+                    ++this->shrink_event_num_;
+                }
+
+                if (thread_ptr->state.load() == ThreadState::kStop) {
+                    CTHREAD_TRACE(TraceEvent::kThreadStop, thread_ptr->id.load(), 0);
+                    break;
+                }
+                if (this->is_shutdown_ && this->tasks_.empty()) {
+                    CTHREAD_TRACE(TraceEvent::kThreadShutdown, thread_ptr->id.load(), 0);
+                    break;
+                }
+                if (this->is_shutdown_now_) {
+                    CTHREAD_TRACE(TraceEvent::kThreadShutdownNow, thread_ptr->id.load(), 0);
+                    break;
                 }
+                SetStateUnlessStopped(*thread_ptr, ThreadState::kRunning);
+                task = this->tasks_.Pop();
+                --this->pending_task_num_;
+            }
+            RunTask(task);
+        }
+        CTHREAD_TRACE(TraceEvent::kThreadExit, thread_ptr->id.load(), 0);
+    }
+
+    /**
+     * 工作窃取模式的线程执行体
+     * 依次尝试：全局队列中的高优先级任务 -> 本地队列尾部 -> 全局队列 -> 随机选择其他线程从其本地队列头部窃取，
+     * 都取不到任务时才在 task_cv_ 上等待，pending_task_num_ 统计所有队列中尚未执行的任务数
+     */
+    void WorkStealingLoop(ThreadWrapperPtr thread_ptr) {
+        WorkerContext &context = CurrentWorker();
+        context.pool = this;
+        context.wrapper = thread_ptr.get();
+        uint32_t seed = static_cast<uint32_t>(thread_ptr->id.load()) * 2654435761u + 1;
+        for (;;) {
+            if (thread_ptr->state.load() == ThreadState::kStop) {
+                CTHREAD_TRACE(TraceEvent::kThreadStop, thread_ptr->id.load(), 0);
+                break;
+            }
+            if (this->is_shutdown_now_) {
+                CTHREAD_TRACE(TraceEvent::kThreadShutdownNow, thread_ptr->id.load(), 0);
+                break;
+            }
+            QueuedTask task;
+            if ((this->global_high_task_num_.load() > 0 && TryPopGlobal(task)) || TryPopLocal(thread_ptr.get(), task) ||
+                TryPopGlobal(task) || TrySteal(thread_ptr.get(), seed, task)) {
+                SetStateUnlessStopped(*thread_ptr, ThreadState::kRunning);
+                RunTask(task);
+                continue;
+            }
+
+            ThreadPoolLock lock(this->task_mutex_);
+            if (this->is_shutdown_ && this->pending_task_num_.load() == 0) {
+                CTHREAD_TRACE(TraceEvent::kThreadShutdown, thread_ptr->id.load(), 0);
+                break;
+            }
+            CTHREAD_TRACE(TraceEvent::kWaitBegin, thread_ptr->id.load(), 0);
+            SetStateUnlessStopped(*thread_ptr, ThreadState::kWaiting);
+            ++this->waiting_thread_num_;
+            auto is_ready = [this, thread_ptr] {
+                return (this->is_shutdown_ || this->is_shutdown_now_ || this->pending_task_num_.load() > 0 ||
+                        thread_ptr->state.load() == ThreadState::kStop);
+            };
+            bool is_timeout = false;
+            uint64_t wait_start_ns = cMetrics::NowNs();
+            if (thread_ptr->flag.load() == ThreadFlag::kCore) {
+                this->task_cv_.wait(lock, is_ready);
+            } else {
+                is_timeout = !this->task_cv_.wait_for(lock, GetCacheIdleTimeout(), is_ready);
+            }
+            --this->waiting_thread_num_;
+            this->idle_wait_ns_.Record(cMetrics::NowNs() - wait_start_ns);
+            CTHREAD_TRACE(TraceEvent::kWaitEnd, thread_ptr->id.load(), 0);
+            if (is_timeout) {
+                thread_ptr->state.store(ThreadState::kStop);
+                ++this->shrink_event_num_;
             }
-            this->task_cv_.notify_all();
+        }
+        HandOffLocalTasks(thread_ptr.get());
+        UnregisterStealTarget(thread_ptr);
+        context.pool = nullptr;
+        context.wrapper = nullptr;
+        CTHREAD_TRACE(TraceEvent::kThreadExit, thread_ptr->id.load(), 0);
+    }
+
+    // 线程修改自己的状态，已被 Resize 标记为 kStop 时保持不变，使停止请求不会被覆盖
+    static void SetStateUnlessStopped(ThreadWrapper &wrapper, ThreadState state) {
+        ThreadState current = wrapper.state.load();
+        while (current != ThreadState::kStop && !wrapper.state.compare_exchange_weak(current, state)) {
+        }
+    }
+
+    /**
+     * 工作窃取模式的线程退出前把本地队列中剩余的任务移到全局队列，由其他线程继续执行
+     * 只有本线程会向自己的本地队列放任务，移出之后不会再有新任务进入；pending_task_num_ 不变
+     */
+    void HandOffLocalTasks(ThreadWrapper *wrapper) {
+        if (this->is_shutdown_now_) {  // 立即关闭时丢弃未执行的任务
+            return;
+        }
+        RingQueue<QueuedTask> remaining;
+        {
+            std::lock_guard<std::mutex> lock(wrapper->local_mutex);
+            while (!wrapper->local_tasks.empty()) {
+                remaining.emplace_back(std::move(wrapper->local_tasks.front()));
+                wrapper->local_tasks.pop_front();
+            }
+        }
+        if (remaining.empty()) {
+            return;
+        }
+        size_t count = remaining.size();
+        {
+            ThreadPoolLock lock(this->task_mutex_);
+            while (!remaining.empty()) {
+                this->tasks_.Push(std::move(remaining.front()), TaskPriority::kNormal);
+                remaining.pop_front();
+            }
+            this->global_task_num_ += static_cast<int>(count);
+        }
+        NotifyWorkers(count);
+    }
+
+    /**
+     * 工作窃取模式下提交任务：当前线程是本线程池的线程且为普通优先级时放入其本地队列，否则放入全局队列
+     * 放入本地队列时只有存在等待中的线程才需要获取 task_mutex_ 去唤醒，
+     * pending_task_num_ 与 waiting_thread_num_ 的先写后读保证不会丢失唤醒
+     */
+    void PushWorkStealing(QueuedTask task, TaskPriority priority) {
+        WorkerContext &context = CurrentWorker();
+        if (priority == TaskPriority::kNormal && context.pool == this && context.wrapper != nullptr) {
+            {
+                std::lock_guard<std::mutex> lock(context.wrapper->local_mutex);
+                context.wrapper->local_tasks.emplace_back(std::move(task));
+            }
+            ++this->pending_task_num_;
+            if (this->waiting_thread_num_.load() > 0) {
+                { ThreadPoolLock lock(this->task_mutex_); }
+                this->task_cv_.notify_one();
+            }
+            return;
+        }
+        {
+            ThreadPoolLock lock(this->task_mutex_);
+            this->tasks_.Push(std::move(task), priority);
+            ++this->global_task_num_;
+            ++this->pending_task_num_;
+            if (priority == TaskPriority::kHigh) {
+                ++this->global_high_task_num_;
+            }
+        }
+        this->task_cv_.notify_one();
+    }
+
+    bool TryPopLocal(ThreadWrapper *wrapper, QueuedTask &task) {
+        std::lock_guard<std::mutex> lock(wrapper->local_mutex);
+        if (wrapper->local_tasks.empty()) {
+            return false;
+        }
+        task = std::move(wrapper->local_tasks.back());
+        wrapper->local_tasks.pop_back();
+        --this->pending_task_num_;
+        return true;
+    }
+
+    bool TryPopGlobal(QueuedTask &task) {
+        if (this->global_task_num_.load() == 0) {
+            return false;
+        }
+        ThreadPoolLock lock(this->task_mutex_);
+        if (this->tasks_.empty()) {
+            return false;
+        }
+        TaskPriority priority;
+        task = this->tasks_.Pop(&priority);
+        --this->global_task_num_;
+        --this->pending_task_num_;
+        if (priority == TaskPriority::kHigh) {
+            --this->global_high_task_num_;
+        }
+        return true;
+    }
+
+    // 从随机位置开始遍历其他线程，窃取其本地队列头部（最早提交）的任务，锁被占用时直接跳过
+    bool TrySteal(ThreadWrapper *self, uint32_t &seed, QueuedTask &task) {
+        std::shared_ptr<const StealList> targets = std::atomic_load(&this->steal_list_);
+        size_t count = targets->size();
+        if (count < 2) {
+            return false;
+        }
+        this->steal_attempt_num_.Add(1);
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        size_t start = seed % count;
+        for (size_t i = 0; i < count; ++i) {
+            ThreadWrapper *victim = (*targets)[(start + i) % count].get();
+            if (victim == self) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(victim->local_mutex, std::try_to_lock);
+            if (!lock.owns_lock() || victim->local_tasks.empty()) {
+                continue;
+            }
+            task = std::move(victim->local_tasks.front());
+            victim->local_tasks.pop_front();
+            --this->pending_task_num_;
+            this->steal_hit_num_.Add(1);
+            return true;
+        }
+        return false;
+    }
+
+    // 窃取目标列表采用写时复制，窃取时无需持有 steal_mutex_
+    void RegisterStealTarget(const ThreadWrapperPtr &thread_ptr) {
+        std::lock_guard<std::mutex> lock(this->steal_mutex_);
+        auto targets = std::make_shared<StealList>(*std::atomic_load(&this->steal_list_));
+        targets->push_back(thread_ptr);
+        std::atomic_store(&this->steal_list_, std::shared_ptr<const StealList>(std::move(targets)));
+    }
+
+    void UnregisterStealTarget(const ThreadWrapperPtr &thread_ptr) {
+        std::lock_guard<std::mutex> lock(this->steal_mutex_);
+        auto targets = std::make_shared<StealList>(*std::atomic_load(&this->steal_list_));
+        targets->erase(std::remove(targets->begin(), targets->end(), thread_ptr), targets->end());
+        std::atomic_store(&this->steal_list_, std::shared_ptr<const StealList>(std::move(targets)));
+    }
+
+    // 记录当前线程所属的线程池及其 ThreadWrapper，用于判断任务是否由池内线程提交
+    struct WorkerContext {
+        ThreadPool *pool = nullptr;
+        ThreadWrapper *wrapper = nullptr;
+    };
+
+    static WorkerContext &CurrentWorker() {
+        static thread_local WorkerContext context;
+        return context;
+    }
+
+    // cMetrics::ShouldSample 的抽样点
+    struct QueueWaitSample {};
+    struct RunSample {};
+
+    // 被抽中统计排队时间的任务返回当前时间，随任务一起入队，否则返回 0
+    static uint64_t SampleEnqueueTime() { return cMetrics::ShouldSample<QueueWaitSample>() ? cMetrics::NowNs() : 0; }
+
+    // Cache 线程的空闲超时时间，开启 elastic 时使用毫秒级的 idle_timeout
+    std::chrono::milliseconds GetCacheIdleTimeout() {
+        if (config_.elastic.enabled && config_.elastic.idle_timeout.count() > 0) {
+            return config_.elastic.idle_timeout;
+        }
+        return std::chrono::duration_cast<std::chrono::milliseconds>(config_.time_out);
+    }
+
+    /**
+     * 自适应伸缩控制线程：每个 tick 根据出队速率估算排队延迟，连续过载 grow_hysteresis 次才扩容，
+     * 扩容后过载计数清零，避免突发流量一次创建大量线程；缩容由 Cache 线程自身的 idle_timeout 完成
+     */
+    void ControllerLoop() {
+        auto last_time = std::chrono::steady_clock::now();
+        uint64_t last_finished = this->finished_task_num_.load();
+        double latency_ewma = 0;
+        int overload_ticks = 0;
+        std::unique_lock<std::mutex> lock(this->controller_mutex_);
+        for (;;) {
+            auto is_stop = [this] { return this->is_shutdown_ || this->is_shutdown_now_; };
+            if (this->controller_cv_.wait_for(lock, config_.elastic.tick, is_stop)) {
+                break;
+            }
+            auto now = std::chrono::steady_clock::now();
+            double seconds = std::chrono::duration<double>(now - last_time).count();
+            uint64_t finished = this->finished_task_num_.load();
+            double rate = seconds > 0 ? (finished - last_finished) / seconds : 0;
+            last_time = now;
+            last_finished = finished;
+
+            int depth = GetPendingTaskSize();
+            int waiting = GetWaitingThreadSize();
+            double latency_us = 0;
+            if (depth > 0) {
+                // 整个采样周期内没有任务完成时，至少已经排队了一个周期
+                latency_us = rate > 0 ? depth / rate * 1e6 : seconds * 1e6;
+            }
+            latency_ewma = 0.7 * latency_ewma + 0.3 * latency_us;
+
+            bool is_overload = depth > waiting && latency_ewma > config_.elastic.target_latency.count();
+            overload_ticks = is_overload ? overload_ticks + 1 : 0;
+            if (overload_ticks >= config_.elastic.grow_hysteresis) {
+                int grow_num = std::min({config_.elastic.max_grow_step, config_.max_threads - GetTotalThreadSize(),
+                                         depth - waiting});
+                lock.unlock();
+                for (int i = 0; i < grow_num; ++i) {
+                    AddThread(GetNextThreadId(), ThreadFlag::kCache);
+                }
+                if (grow_num > 0) {
+                    this->grow_event_num_ += grow_num;
+                }
+                lock.lock();
+                overload_ticks = 0;
+            }
+            this->elastic_stats_.queue_latency_us = latency_ewma;
+            this->elastic_stats_.dequeue_rate = rate;
+            this->elastic_stats_.overload_ticks = overload_ticks;
         }
     }
 
@@ -286,19 +1482,50 @@ class ThreadPool {
    private:
     ThreadPoolConfig config_;
 
+    std::mutex threads_mutex_;
     std::list<ThreadWrapperPtr> worker_threads_;
 
-    std::queue<std::function<void()>> tasks_;
+    PriorityTaskQueue tasks_;
+    std::shared_ptr<TaskSlab> task_slab_;
     std::mutex task_mutex_;
     std::condition_variable task_cv_;
 
+    std::mutex steal_mutex_;
+    std::shared_ptr<const StealList> steal_list_;
+
     std::atomic<int> total_function_num_;
     std::atomic<int> waiting_thread_num_;
+    std::atomic<int> pending_task_num_;
+    std::atomic<int> global_task_num_;
+    std::atomic<int> global_high_task_num_;
     std::atomic<int> thread_id_;
+    std::atomic<int> live_thread_num_;
+    std::thread::id detached_thread_id_;  // 在任务中关闭线程池时被 detach 的调用线程，由 threads_mutex_ 保护
+    std::atomic<uint64_t> finished_task_num_;
+
+    std::thread controller_thread_;
+    std::mutex controller_mutex_;
+    std::condition_variable controller_cv_;
+    ElasticStats elastic_stats_;
+    std::atomic<uint64_t> grow_event_num_;
+    std::atomic<uint64_t> shrink_event_num_;
+
+    std::mutex timer_mutex_;
+    std::unique_ptr<cTimer::TimingWheel> timer_;
+
+    cMetrics::Counter rejected_task_num_;
+    cMetrics::Counter steal_attempt_num_;
+    cMetrics::Counter steal_hit_num_;
+    cMetrics::Histogram queue_wait_ns_;
+    cMetrics::Histogram run_ns_;
+    cMetrics::Histogram idle_wait_ns_;
 
     std::atomic<bool> is_shutdown_now_;
     std::atomic<bool> is_shutdown_;
     std::atomic<bool> is_available_;
+
+    // 放在最后，最先析构，注销之后不会再有采集函数访问其他成员
+    cMetrics::Registration metrics_registration_;
 };
 
 }  // namespace cThread
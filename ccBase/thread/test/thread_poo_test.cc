@@ -1,12 +1,14 @@
 #include <iostream>
+#include <memory>
+#include "numa_thread_pool.h"
 #include "thread_pool.h"
 
 using namespace cThread;
 using std::cout;
 using std::endl;
 
-int main() {
-    cout << "hello" << endl;
+void TestBasicThreadPool() {
+    cout << "\n========== 测试1: 线程池基本功能 ==========" << endl;
     ThreadPool pool(ThreadPool::ThreadPoolConfig{4, 5, 6, std::chrono::seconds(4)});
     pool.Start();
     std::this_thread::sleep_for(std::chrono::seconds(4));
@@ -34,6 +36,304 @@ int main() {
     cout << "---------------" << endl;
     pool.ShutDownNow();
     getchar();
+}
+
+void TestWorkStealing() {
+    cout << "\n========== 测试2: 工作窃取调度 ==========" << endl;
+    ThreadPool::ThreadPoolConfig config{4, 4, 6, std::chrono::seconds(4)};
+    config.scheduler_mode = ThreadPool::SchedulerMode::kWorkStealing;
+    ThreadPool pool(config);
+    pool.Start();
+
+    // 外部线程提交的任务进入全局队列，任务内部再提交的子任务进入执行线程的本地队列
+    const int parent_count = 8;
+    const int child_count = 100;
+    std::atomic<int> finished(0);
+    for (int i = 0; i < parent_count; ++i) {
+        pool.Run([&pool, &finished, child_count]() {
+            for (int j = 0; j < child_count; ++j) {
+                pool.Run([&finished]() { finished++; });
+            }
+        });
+    }
+    // 子任务在池内线程的本地队列中，不能在任务内部阻塞等待，这里在外部等待全部完成
+    while (finished.load() < parent_count * child_count) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    cout << "预期完成子任务数: " << parent_count * child_count << endl;
+    cout << "实际完成子任务数: " << finished.load() << endl;
+
+    pool.ShutDown();
+}
+
+void TestPostAndSubmit() {
+    cout << "\n========== 测试3: Post / Submit 提交 ==========" << endl;
+    ThreadPool pool(ThreadPool::ThreadPoolConfig{2, 2, 6, std::chrono::seconds(4)});
+    pool.Start();
+
+    std::atomic<int> counter(0);
+    auto add_one = [&counter]() { counter++; };
+    cout << "Post 任务是否内联存储: " << (SmallTask::IsInline<decltype(add_one)>() ? "是" : "否") << endl;
+    const int post_count = 1000;
+    for (int i = 0; i < post_count; ++i) {
+        pool.Post(add_one);
+    }
+    pool.Post([&counter](int delta) { counter += delta; }, 10);
+
+    auto square = pool.Submit([](int x) { return x * x; }, 12);
+    auto text = pool.Submit([]() { return std::string("submit"); });
+    auto failed = pool.Submit([]() -> int { throw std::runtime_error("submit 异常"); });
+    cout << "Submit 结果: " << square.get() << ", " << text.get() << endl;
+    try {
+        failed.get();
+    } catch (const std::exception &e) {
+        cout << "捕获异常: " << e.what() << endl;
+    }
+
+    while (counter.load() < post_count + 10) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    cout << "Post 计数: " << counter.load() << " (预期 " << post_count + 10 << ")" << endl;
+
+    pool.ShutDown();
+}
+
+void TestBatchAndParallel() {
+    cout << "\n========== 测试4: 批量提交与并行算法 ==========" << endl;
+    ThreadPool pool(ThreadPool::ThreadPoolConfig{4, 4, 6, std::chrono::seconds(4)});
+    pool.Start();
+
+    std::atomic<int> counter(0);
+    std::vector<SmallTask> batch;
+    for (int i = 0; i < 100; ++i) {
+        batch.emplace_back([&counter]() { counter++; });
+    }
+    cout << "批量提交任务数: " << pool.PostBatch(batch) << endl;
+
+    std::vector<int> values(10000, 0);
+    auto done = pool.ParallelFor(0, static_cast<int>(values.size()), [&values](int i) { values[i] = i; });
+    done.get();
+    long long expected = 0;
+    for (int i = 0; i < static_cast<int>(values.size()); ++i) {
+        expected += i;
+    }
+
+    auto sum = pool.ParallelReduce(
+        size_t(0), values.size(), 0LL,
+        [&values](size_t lo, size_t hi, long long init) {
+            for (size_t i = lo; i < hi; ++i) {
+                init += values[i];
+            }
+            return init;
+        },
+        [](long long a, long long b) { return a + b; }, 128);
+    cout << "ParallelReduce 结果: " << sum.get() << " (预期 " << expected << ")" << endl;
+
+    auto failed = pool.ParallelFor(0, 100, [](int i) {
+        if (i == 42) {
+            throw std::runtime_error("ParallelFor 异常");
+        }
+    });
+    try {
+        failed.get();
+    } catch (const std::exception &e) {
+        cout << "捕获异常: " << e.what() << endl;
+    }
+
+    while (counter.load() < 100) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    cout << "批量任务计数: " << counter.load() << endl;
+
+    pool.ShutDown();
+}
+
+// 用单线程线程池阻塞住唯一的线程，按 低->普通->高 的顺序提交任务，放行后打印实际执行顺序
+std::string RunPriorityOrder(int starvation_threshold, int high_count, int low_count) {
+    ThreadPool::ThreadPoolConfig config{1, 1, 6, std::chrono::seconds(4)};
+    config.starvation_threshold = starvation_threshold;
+    ThreadPool pool(config);
+    pool.Start();
+
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    pool.Post([opened]() { opened.wait(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::mutex order_mutex;
+    std::string order;
+    auto record = [&order_mutex, &order](char tag) {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(tag);
+    };
+    for (int i = 0; i < low_count; ++i) {
+        pool.PostWithPriority(TaskPriority::kLow, record, 'L');
+    }
+    pool.PostWithPriority(TaskPriority::kNormal, record, 'N');
+    for (int i = 0; i < high_count; ++i) {
+        pool.PostWithPriority(TaskPriority::kHigh, record, 'H');
+    }
+    gate.set_value();
+    pool.SubmitWithPriority(TaskPriority::kLow, []() {}).get();
+
+    pool.ShutDown();
+    return order;
+}
+
+void TestPriority() {
+    cout << "\n========== 测试5: 任务优先级 ==========" << endl;
+    cout << "严格优先级执行顺序: " << RunPriorityOrder(16, 3, 3) << " (预期 HHHNLLL)" << endl;
+    cout << "防饿死执行顺序: " << RunPriorityOrder(2, 6, 2) << " (预期 HHLNHLHHH)" << endl;
+}
+
+void TestAffinityAndNuma() {
+    cout << "\n========== 测试6: CPU 亲和性、线程名与 NUMA 子池 ==========" << endl;
+    ThreadPool::ThreadPoolConfig config{2, 2, 6, std::chrono::seconds(4)};
+    config.cpu_set = {0};
+    config.pin_core_threads = true;
+    config.thread_name = "worker";
+    ThreadPool pool(config);
+    pool.Start();
+    auto info = pool.Submit([]() {
+        std::string result;
+#if defined(__linux__)
+        char name[16] = {0};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        result = std::string(name) + " on cpu " + std::to_string(sched_getcpu());
+#endif
+        return result;
+    });
+    cout << "线程信息: " << info.get() << endl;
+    pool.ShutDown();
+    cout << "ShutDown 返回后线程数: " << pool.GetTotalThreadSize() << endl;
+
+    // 在任务中关闭线程池：调用线程被 detach，析构等待它执行完任务剩余部分后才释放
+    std::atomic<bool> epilogue_done(false);
+    {
+        auto inner_pool = std::make_unique<ThreadPool>(ThreadPool::ThreadPoolConfig{2, 2, 6, std::chrono::seconds(4)});
+        inner_pool->Start();
+        ThreadPool *raw_pool = inner_pool.get();
+        inner_pool->Post([raw_pool, &epilogue_done]() {
+            raw_pool->ShutDown();
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            epilogue_done.store(true);
+        });
+        while (inner_pool->IsAvailable()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    cout << "任务中关闭后析构，任务已完成: " << epilogue_done.load() << "（期望 1）" << endl;
+
+    ThreadPool::ThreadPoolConfig node_config{1, 2, 6, std::chrono::seconds(4)};
+    NumaThreadPool numa_pool(node_config);
+    numa_pool.Start();
+    cout << "NUMA 节点数: " << numa_pool.GetNodeCount() << ", 当前节点: " << numa_pool.GetCurrentNode() << endl;
+    std::vector<std::future<int>> results;
+    for (int node = 0; node < numa_pool.GetNodeCount(); ++node) {
+        results.push_back(numa_pool.SubmitToNode(node, [node]() { return node; }));
+    }
+    for (auto &result : results) {
+        cout << "子池任务完成，节点: " << result.get() << endl;
+    }
+    cout << "本地节点任务结果: " << numa_pool.Submit([]() { return 7; }).get() << endl;
+    numa_pool.ShutDown();
+}
+
+std::atomic<int> g_trace_event_count(0);
+
+void CountTraceEvent(TraceEvent /*event*/, int /*thread_id*/, int /*value*/) { g_trace_event_count++; }
+
+void TestTraceHook() {
+    cout << "\n========== 测试7: 跟踪回调 ==========" << endl;
+    ThreadPool::SetTraceHook(&CountTraceEvent);
+    {
+        ThreadPool pool(ThreadPool::ThreadPoolConfig{2, 2, 6, std::chrono::seconds(4)});
+        pool.Start();
+        pool.Submit([]() {}).get();
+        pool.ShutDown();
+    }
+    ThreadPool::SetTraceHook(nullptr);
+#ifdef CTHREAD_ENABLE_TRACE
+    cout << "已开启跟踪，收到事件数: " << g_trace_event_count.load() << endl;
+#else
+    cout << "未定义 CTHREAD_ENABLE_TRACE，收到事件数: " << g_trace_event_count.load() << endl;
+#endif
+}
+
+void TestElasticSizing() {
+    cout << "\n========== 测试8: 自适应伸缩 ==========" << endl;
+    ThreadPool::ThreadPoolConfig config{2, 8, 6, std::chrono::seconds(4)};
+    config.elastic.enabled = true;
+    config.elastic.idle_timeout = std::chrono::milliseconds(100);
+    ThreadPool pool(config);
+    pool.Start();
+    std::atomic<int> done{0};
+    for (int i = 0; i < 200; ++i) {
+        pool.Post([&done]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            done++;
+        });
+    }
+    int peak_threads = 0;
+    while (done.load() < 200) {
+        peak_threads = std::max(peak_threads, pool.GetTotalThreadSize());
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ThreadPool::ElasticStats stats = pool.GetElasticStats();
+    cout << "峰值线程数: " << peak_threads << " 扩容: " << stats.grow_events << " 估算延迟(us): " << stats.queue_latency_us
+         << endl;
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    stats = pool.GetElasticStats();
+    cout << "空闲后线程数: " << stats.total_threads << " 回收: " << stats.shrink_events << endl;
+    if (peak_threads <= 2 || stats.total_threads != 2) {
+        cout << "自适应伸缩结果错误" << endl;
+    }
+    pool.Resize(5);
+    cout << "Resize(5) 后线程数: " << pool.GetTotalThreadSize() << endl;
+    pool.ShutDown();
+}
+
+void TestResizeWorkStealing() {
+    cout << "\n========== 测试9: 工作窃取模式下反复 Resize ==========" << endl;
+    ThreadPool::ThreadPoolConfig config{2, 8, 6, std::chrono::seconds(4)};
+    config.scheduler_mode = ThreadPool::SchedulerMode::kWorkStealing;
+    ThreadPool pool(config);
+    pool.Start();
+    // 子任务进入执行线程的本地队列，被缩容停止的线程退出前要把它们交回全局队列
+    const int parent_count = 200;
+    const int child_count = 20;
+    std::atomic<int> finished(0);
+    for (int i = 0; i < parent_count; ++i) {
+        pool.Run([&pool, &finished, child_count]() {
+            for (int j = 0; j < child_count; ++j) {
+                pool.Run([&finished]() { finished++; });
+            }
+        });
+        if (i % 10 == 0) {
+            pool.Resize(8);
+            pool.Resize(2);
+        }
+    }
+    // 关闭后池内提交的子任务会被拒绝，先在外部等待全部完成；本地任务丢失时这里会超时
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (finished.load() < parent_count * child_count && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    pool.ShutDown();
+    cout << "完成子任务数: " << finished.load() << "（期望 " << parent_count * child_count << "）" << endl;
+}
+
+int main() {
+    cout << "hello" << endl;
+    TestWorkStealing();
+    TestPostAndSubmit();
+    TestBatchAndParallel();
+    TestPriority();
+    TestAffinityAndNuma();
+    TestTraceHook();
+    TestElasticSizing();
+    TestResizeWorkStealing();
+    TestBasicThreadPool();
     cout << "world" << endl;
     return 0;
 }
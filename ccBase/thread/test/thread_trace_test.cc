@@ -0,0 +1,80 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include "thread_pool.h"
+
+// 本测试以 -DCTHREAD_ENABLE_TRACE 编译，检查跟踪回调收到线程池的生命周期事件
+#ifndef CTHREAD_ENABLE_TRACE
+#error "thread_trace_test 需要定义 CTHREAD_ENABLE_TRACE"
+#endif
+
+using namespace cThread;
+using std::cout;
+using std::endl;
+
+const int kEventNum = static_cast<int>(TraceEvent::kResize) + 1;
+std::atomic<int> g_event_count[kEventNum];
+
+void CountEvent(TraceEvent event, int /*thread_id*/, int /*value*/) { g_event_count[static_cast<int>(event)]++; }
+
+int EventCount(TraceEvent event) { return g_event_count[static_cast<int>(event)].load(); }
+
+void ResetEventCount() {
+    for (auto &count : g_event_count) {
+        count.store(0);
+    }
+}
+
+void RunLifecycle(ThreadPool::SchedulerMode mode) {
+    ResetEventCount();
+    ThreadPool::ThreadPoolConfig config{2, 4, 6, std::chrono::seconds(4)};
+    config.scheduler_mode = mode;
+    {
+        ThreadPool pool(config);
+        pool.Start();
+        pool.Submit([]() {}).get();
+        pool.Resize(3);
+        pool.ShutDown();
+    }
+    cout << "kInitBegin: " << EventCount(TraceEvent::kInitBegin) << " kInitEnd: " << EventCount(TraceEvent::kInitEnd)
+         << "（期望 1, 1）" << endl;
+    cout << "kResize: " << EventCount(TraceEvent::kResize) << "（期望 1）" << endl;
+    cout << "kThreadAdd: " << EventCount(TraceEvent::kThreadAdd)
+         << " kThreadExit: " << EventCount(TraceEvent::kThreadExit)
+         << " kThreadShutdown: " << EventCount(TraceEvent::kThreadShutdown) << "（期望 3, 3, 3）" << endl;
+    cout << "kWaitBegin 与 kWaitEnd 相等: " << (EventCount(TraceEvent::kWaitBegin) == EventCount(TraceEvent::kWaitEnd))
+         << "（期望 1）" << endl;
+    cout << "kShutdown: " << EventCount(TraceEvent::kShutdown) << " kShutdownNow: " << EventCount(TraceEvent::kShutdownNow)
+         << "（期望 1, 0）" << endl;
+}
+
+void TestGlobalQueueTrace() {
+    cout << "\n========== 测试1: 全局队列模式的跟踪事件 ==========" << endl;
+    RunLifecycle(ThreadPool::SchedulerMode::kGlobalQueue);
+}
+
+void TestWorkStealingTrace() {
+    cout << "\n========== 测试2: 工作窃取模式的跟踪事件 ==========" << endl;
+    RunLifecycle(ThreadPool::SchedulerMode::kWorkStealing);
+}
+
+void TestShutDownNowTrace() {
+    cout << "\n========== 测试3: ShutDownNow 的跟踪事件 ==========" << endl;
+    ResetEventCount();
+    {
+        ThreadPool pool(ThreadPool::ThreadPoolConfig{2, 2, 6, std::chrono::seconds(4)});
+        pool.Start();
+        pool.ShutDownNow();
+    }
+    cout << "kShutdownNow: " << EventCount(TraceEvent::kShutdownNow)
+         << " kThreadExit: " << EventCount(TraceEvent::kThreadExit) << "（期望 1, 2）" << endl;
+}
+
+int main() {
+    ThreadPool::SetTraceHook(&CountEvent);
+    TestGlobalQueueTrace();
+    TestWorkStealingTrace();
+    TestShutDownNowTrace();
+    ThreadPool::SetTraceHook(nullptr);
+    return 0;
+}
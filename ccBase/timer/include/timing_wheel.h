@@ -0,0 +1,347 @@
+#ifndef __TIMING_WHEEL__
+#define __TIMING_WHEEL__
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "small_task.h"
+
+namespace cTimer {
+
+/**
+ * 定时器ID，0 表示无效；高 32 位是节点的代数，低 32 位是节点下标加一，节点复用后旧ID自动失效
+ */
+using TimerId = uint64_t;
+
+/**
+ * 分层时间轮
+ * 共 kLevels 层，每层 kSlots 个槽，第 L 层一个槽覆盖 kSlots^L 个 tick，默认 1ms 一个 tick 时可表示约 49 天，
+ * 更远的定时器先放在最高层，到期前逐层下移。定时器节点放在数组中，槽内用下标串成双向链表，
+ * 因此插入和取消都是 O(1)，大量设置后又取消的超时定时器只是在链表中挂上再摘下，不分配内存（可调用对象不超过 SmallTask::kInlineSize 时）。
+ *
+ * 时间轮线程每到一个有定时器的 tick（或每 kSlots 个 tick 一次的下移点）醒来，把到期的任务收集到一批中交给 dispatcher，
+ * 例如线程池的 PostBatch；没有 dispatcher 或 dispatcher 没有取走的任务在时间轮线程中直接执行，任务抛出的异常会被忽略
+ */
+class TimingWheel {
+   public:
+    using Clock = std::chrono::steady_clock;
+    using Dispatcher = std::function<void(std::vector<cThread::SmallTask> &tasks)>;
+
+    static constexpr int kSlotBits = 8;
+    static constexpr uint32_t kSlots = 1u << kSlotBits;
+    static constexpr int kLevels = 4;
+
+    /**
+     * @param tick 时间精度，定时器最多晚一个 tick 执行
+     * @param dispatcher 执行到期任务的方式，为空时在时间轮线程中执行
+     */
+    explicit TimingWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(1), Dispatcher dispatcher = nullptr)
+        : tick_(std::max(tick, std::chrono::milliseconds(1))), dispatcher_(std::move(dispatcher)), start_(Clock::now()) {
+        std::fill(std::begin(heads_), std::end(heads_), kNil);
+    }
+
+    ~TimingWheel() { Stop(); }
+
+    TimingWheel(const TimingWheel &) = delete;
+    TimingWheel &operator=(const TimingWheel &) = delete;
+
+    /**
+     * 启动时间轮线程，RunAfter/RunEvery 会自动调用
+     */
+    void Start() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        StartLocked();
+    }
+
+    /**
+     * 停止时间轮线程，正在分发的一批任务会先完成；尚未到期的定时器保留，再次 Start 后超时的定时器立即执行
+     */
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) {
+                return;
+            }
+            running_ = false;
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    /**
+     * delay 之后执行一次 f
+     * @return 定时器ID
+     */
+    template <typename Rep, typename Period, typename F>
+    TimerId RunAfter(std::chrono::duration<Rep, Period> delay, F &&f) {
+        return Add(ToTicks(delay), 0, cThread::SmallTask(std::forward<F>(f)), nullptr);
+    }
+
+    /**
+     * 每隔 interval 执行一次 f，第一次在 interval 之后；按固定频率计时，与 f 的执行时间无关，
+     * 分发到线程池时 f 执行得比 interval 慢会有多次调用同时进行
+     * @return 定时器ID，Cancel 之后不会再分发新的调用
+     */
+    template <typename Rep, typename Period, typename F>
+    TimerId RunEvery(std::chrono::duration<Rep, Period> interval, F &&f) {
+        auto func = std::make_shared<std::decay_t<F>>(std::forward<F>(f));
+        uint64_t ticks = ToTicks(interval);
+        return Add(ticks, ticks, nullptr, [func]() { (*func)(); });
+    }
+
+    /**
+     * 取消定时器
+     * @return 定时器还在等待时返回 true；已经执行过的一次性定时器或无效ID返回 false
+     */
+    bool Cancel(TimerId id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t index = static_cast<uint32_t>(id & 0xffffffffu) - 1;
+        if (id == 0 || index >= nodes_.size()) {
+            return false;
+        }
+        Node &node = nodes_[index];
+        if (node.generation != static_cast<uint32_t>(id >> 32) || node.bucket == kNil) {
+            return false;
+        }
+        Unlink(index);
+        FreeNode(index);
+        return true;
+    }
+
+    // 等待中的定时器个数
+    size_t GetTimerCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return timer_count_;
+    }
+
+   private:
+    static constexpr uint32_t kNil = std::numeric_limits<uint32_t>::max();
+    static constexpr uint64_t kMaxTicks = (uint64_t(1) << (kSlotBits * kLevels)) - 1;
+
+    struct Node {
+        uint32_t prev = kNil;
+        uint32_t next = kNil;    // 空闲时指向下一个空闲节点
+        uint32_t bucket = kNil;  // 所在的槽，空闲时为 kNil
+        uint32_t generation = 0;
+        uint64_t expire = 0;  // 到期的 tick
+        uint64_t period = 0;  // 周期的 tick 数，0 表示一次性定时器
+        cThread::SmallTask task;
+        std::function<void()> repeat;
+    };
+
+    template <typename Rep, typename Period>
+    uint64_t ToTicks(std::chrono::duration<Rep, Period> duration) const {
+        auto ms = std::chrono::ceil<std::chrono::milliseconds>(duration).count();
+        return ms > tick_.count() ? static_cast<uint64_t>((ms + tick_.count() - 1) / tick_.count()) : 1;
+    }
+
+    uint64_t NowTick() const { return static_cast<uint64_t>((Clock::now() - start_) / tick_); }
+
+    TimerId Add(uint64_t ticks, uint64_t period, cThread::SmallTask task, std::function<void()> repeat) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (timer_count_ == 0) {
+            // 时间轮空闲时线程不会醒来推进时间，先追上当前时间，避免醒来后逐个 tick 补走空闲的时间
+            current_tick_ = std::max(current_tick_, NowTick());
+        }
+        uint32_t index = AllocNode();
+        Node &node = nodes_[index];
+        node.expire = std::max(NowTick(), current_tick_) + ticks;
+        node.period = period;
+        node.task = std::move(task);
+        node.repeat = std::move(repeat);
+        Link(index);
+        timer_count_++;
+        StartLocked();
+        if (node.expire < wake_tick_) {
+            wake_tick_ = node.expire;
+            cv_.notify_one();
+        }
+        return (uint64_t(node.generation) << 32) | (index + 1);
+    }
+
+    uint32_t AllocNode() {
+        if (free_head_ == kNil) {
+            nodes_.emplace_back();
+            return static_cast<uint32_t>(nodes_.size() - 1);
+        }
+        uint32_t index = free_head_;
+        free_head_ = nodes_[index].next;
+        return index;
+    }
+
+    void FreeNode(uint32_t index) {
+        Node &node = nodes_[index];
+        node.generation++;
+        node.bucket = kNil;
+        node.task = nullptr;
+        node.repeat = nullptr;
+        node.next = free_head_;
+        free_head_ = index;
+        timer_count_--;
+    }
+
+    // 按距离当前 tick 的远近放入对应层的槽，超出范围时先放在最高层最远的位置
+    void Link(uint32_t index) {
+        Node &node = nodes_[index];
+        uint64_t delta = node.expire > current_tick_ ? node.expire - current_tick_ : 0;
+        uint64_t expire = delta > kMaxTicks ? current_tick_ + kMaxTicks : node.expire;
+        delta = std::min(delta, kMaxTicks);
+        int level = 0;
+        while (level < kLevels - 1 && delta >= (uint64_t(1) << (kSlotBits * (level + 1)))) {
+            level++;
+        }
+        uint32_t bucket = level * kSlots + static_cast<uint32_t>((expire >> (kSlotBits * level)) & (kSlots - 1));
+        node.bucket = bucket;
+        node.prev = kNil;
+        node.next = heads_[bucket];
+        if (node.next != kNil) {
+            nodes_[node.next].prev = index;
+        }
+        heads_[bucket] = index;
+    }
+
+    void Unlink(uint32_t index) {
+        Node &node = nodes_[index];
+        if (node.prev != kNil) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            heads_[node.bucket] = node.next;
+        }
+        if (node.next != kNil) {
+            nodes_[node.next].prev = node.prev;
+        }
+        node.prev = node.next = kNil;
+    }
+
+    // 取下整个槽的链表
+    uint32_t TakeBucket(uint32_t bucket) {
+        uint32_t head = heads_[bucket];
+        heads_[bucket] = kNil;
+        return head;
+    }
+
+    /**
+     * 把时间推进到 now，到期的任务追加到 batch；周期定时器按下一次到期时间重新放入时间轮
+     */
+    void AdvanceLocked(uint64_t now, std::vector<cThread::SmallTask> &batch) {
+        if (timer_count_ == 0) {
+            current_tick_ = std::max(current_tick_, now);
+            return;
+        }
+        while (current_tick_ < now) {
+            uint64_t tick = ++current_tick_;
+            // 进入高层槽覆盖的区间时，把该槽中的定时器按剩余时间重新分配到低层
+            for (int level = 1; level < kLevels && (tick & ((uint64_t(1) << (kSlotBits * level)) - 1)) == 0; ++level) {
+                uint32_t bucket = level * kSlots + static_cast<uint32_t>((tick >> (kSlotBits * level)) & (kSlots - 1));
+                for (uint32_t index = TakeBucket(bucket); index != kNil;) {
+                    uint32_t next = nodes_[index].next;
+                    Link(index);
+                    index = next;
+                }
+            }
+            for (uint32_t index = TakeBucket(static_cast<uint32_t>(tick & (kSlots - 1))); index != kNil;) {
+                Node &node = nodes_[index];
+                uint32_t next = node.next;
+                if (node.period == 0) {
+                    batch.push_back(std::move(node.task));
+                    FreeNode(index);
+                } else {
+                    batch.emplace_back(node.repeat);
+                    node.expire += node.period;
+                    Link(index);
+                }
+                index = next;
+            }
+        }
+    }
+
+    // 下一个需要醒来的 tick：第 0 层中下一个非空的槽，或者下一次下移的位置
+    uint64_t NextWakeTickLocked() const {
+        uint64_t boundary = (current_tick_ | (kSlots - 1)) + 1;
+        for (uint64_t tick = current_tick_ + 1; tick < boundary; ++tick) {
+            if (heads_[tick & (kSlots - 1)] != kNil) {
+                return tick;
+            }
+        }
+        return boundary;
+    }
+
+    void StartLocked() {
+        if (!running_) {
+            if (thread_.joinable()) {
+                thread_.join();
+            }
+            running_ = true;
+            thread_ = std::thread(&TimingWheel::Run, this);
+        }
+    }
+
+    void Run() {
+        std::vector<cThread::SmallTask> batch;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_) {
+            AdvanceLocked(NowTick(), batch);
+            if (!batch.empty()) {
+                lock.unlock();
+                Dispatch(batch);
+                lock.lock();
+                continue;
+            }
+            if (timer_count_ == 0) {
+                wake_tick_ = std::numeric_limits<uint64_t>::max();
+                cv_.wait(lock);
+            } else {
+                wake_tick_ = NextWakeTickLocked();
+                cv_.wait_until(lock, start_ + tick_ * static_cast<int64_t>(wake_tick_));
+            }
+        }
+    }
+
+    void Dispatch(std::vector<cThread::SmallTask> &batch) {
+        if (dispatcher_) {
+            dispatcher_(batch);
+        }
+        for (cThread::SmallTask &task : batch) {
+            if (task) {
+                try {
+                    task();
+                } catch (...) {
+                    // 忽略定时任务中的异常，避免时间轮线程退出
+                }
+            }
+        }
+        batch.clear();
+    }
+
+    const std::chrono::milliseconds tick_;
+    Dispatcher dispatcher_;
+    const Clock::time_point start_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+    bool running_ = false;
+
+    std::vector<Node> nodes_;
+    uint32_t free_head_ = kNil;
+    uint32_t heads_[kLevels * kSlots];
+    size_t timer_count_ = 0;
+    uint64_t current_tick_ = 0;  // 已经处理到的 tick
+    uint64_t wake_tick_ = std::numeric_limits<uint64_t>::max();  // 时间轮线程计划醒来的 tick
+};
+
+}  // namespace cTimer
+
+#endif  // __TIMING_WHEEL__
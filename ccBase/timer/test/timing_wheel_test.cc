@@ -0,0 +1,181 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "thread_pool.h"
+#include "timing_wheel.h"
+
+using namespace cTimer;
+using std::cout;
+using std::endl;
+
+void TestRunAfter() {
+    cout << "\n========== 测试1: 一次性定时器 ==========" << endl;
+
+    TimingWheel wheel;
+    std::mutex mutex;
+    std::vector<int> order;
+    auto record = [&mutex, &order](int value) {
+        return [&mutex, &order, value]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(value);
+        };
+    };
+    auto start = std::chrono::steady_clock::now();
+    wheel.RunAfter(std::chrono::milliseconds(30), record(3));
+    wheel.RunAfter(std::chrono::milliseconds(10), record(1));
+    wheel.RunAfter(std::chrono::milliseconds(20), record(2));
+    // 超过第 0 层范围，需要从第 1 层下移
+    std::atomic<long> elapsed_ms{0};
+    wheel.RunAfter(std::chrono::milliseconds(300), [&]() {
+        elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start)
+                         .count();
+    });
+    cout << "等待中的定时器: " << wheel.GetTimerCount() << "（期望 4）" << endl;
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+
+    cout << "执行顺序:";
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int value : order) {
+        cout << " " << value;
+    }
+    cout << "（期望 1 2 3）" << endl;
+    cout << "300ms 定时器实际耗时: " << elapsed_ms.load() << " ms，剩余定时器: " << wheel.GetTimerCount() << endl;
+
+    // 异常不会影响后续定时器
+    std::atomic<bool> after_throw{false};
+    wheel.RunAfter(std::chrono::milliseconds(1), []() { throw std::runtime_error("定时任务异常"); });
+    wheel.RunAfter(std::chrono::milliseconds(5), [&after_throw]() { after_throw = true; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    cout << "异常之后的定时器执行: " << (after_throw ? "是" : "否") << endl;
+}
+
+void TestRunEvery() {
+    cout << "\n========== 测试2: 周期定时器 ==========" << endl;
+
+    TimingWheel wheel;
+    std::atomic<int> count{0};
+    TimerId id = wheel.RunEvery(std::chrono::milliseconds(10), [&count]() { count++; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(105));
+    wheel.Cancel(id);
+    int stopped = count.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    cout << "100ms 内执行次数: " << stopped << "（期望约 10），取消后不再执行: " << (count.load() == stopped ? "是" : "否")
+         << endl;
+}
+
+void TestCancel() {
+    cout << "\n========== 测试3: 取消定时器 ==========" << endl;
+
+    TimingWheel wheel;
+    std::atomic<int> fired{0};
+    TimerId cancelled = wheel.RunAfter(std::chrono::milliseconds(20), [&fired]() { fired += 100; });
+    TimerId kept = wheel.RunAfter(std::chrono::milliseconds(20), [&fired]() { fired++; });
+    cout << "取消等待中的定时器: " << (wheel.Cancel(cancelled) ? "成功" : "失败") << "，重复取消: "
+         << (wheel.Cancel(cancelled) ? "成功" : "失败") << endl;
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    cout << "执行结果: " << fired.load() << "（期望 1），取消已执行的定时器: " << (wheel.Cancel(kept) ? "成功" : "失败")
+         << endl;
+
+    // 节点复用后旧ID失效
+    TimerId reused = wheel.RunAfter(std::chrono::seconds(10), []() {});
+    cout << "复用节点后取消旧ID: " << (wheel.Cancel(kept) ? "成功" : "失败") << "，取消新ID: "
+         << (wheel.Cancel(reused) ? "成功" : "失败") << "，无效ID: " << (wheel.Cancel(0) ? "成功" : "失败") << endl;
+}
+
+void TestTimeoutPerformance() {
+    cout << "\n========== 测试4: 设置后取消的超时定时器 ==========" << endl;
+
+    TimingWheel wheel;
+    const int timer_count = 1000000;
+    std::vector<TimerId> ids;
+    ids.reserve(timer_count);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < timer_count; ++i) {
+        ids.push_back(wheel.RunAfter(std::chrono::seconds(10), []() {}));
+    }
+    auto inserted = std::chrono::high_resolution_clock::now();
+    for (TimerId id : ids) {
+        wheel.Cancel(id);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto insert_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(inserted - start).count();
+    auto cancel_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - inserted).count();
+    cout << timer_count << " 个定时器，设置: " << insert_ns / timer_count << " ns/次，取消: " << cancel_ns / timer_count
+         << " ns/次，剩余定时器: " << wheel.GetTimerCount() << endl;
+
+    // 第二轮复用第一轮的节点
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < timer_count; ++i) {
+        wheel.Cancel(wheel.RunAfter(std::chrono::seconds(10), []() {}));
+    }
+    end = std::chrono::high_resolution_clock::now();
+    cout << "复用节点时设置并取消: "
+         << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / timer_count << " ns/次" << endl;
+}
+
+void TestThreadPoolTimer() {
+    cout << "\n========== 测试5: 线程池定时任务 ==========" << endl;
+
+    cThread::ThreadPool::ThreadPoolConfig config{4, 4, 1024, std::chrono::seconds(4)};
+    cThread::ThreadPool pool(config);
+    pool.Start();
+
+    std::atomic<int> fired{0};
+    std::mutex mutex;
+    std::vector<std::thread::id> threads;
+    for (int i = 0; i < 1000; ++i) {
+        pool.RunAfter(std::chrono::milliseconds(20), [&]() {
+            fired++;
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.push_back(std::this_thread::get_id());
+        });
+    }
+    std::atomic<int> ticks{0};
+    cTimer::TimerId periodic = pool.RunEvery(std::chrono::milliseconds(10), [&ticks]() { ticks++; });
+    cTimer::TimerId cancelled = pool.RunAfter(std::chrono::milliseconds(20), [&fired]() { fired += 10000; });
+    cout << "取消线程池定时器: " << (pool.CancelTimer(cancelled) ? "成功" : "失败") << endl;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    pool.CancelTimer(periodic);
+    cout << "同一 tick 到期的任务执行: " << fired.load() << "（期望 1000），周期任务执行次数: " << ticks.load()
+         << "（期望约 10）" << endl;
+    bool on_caller = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto id : threads) {
+            on_caller = on_caller || id == std::this_thread::get_id();
+        }
+    }
+    cout << "任务在线程池线程中执行: " << (!on_caller ? "是" : "否") << endl;
+
+    pool.RunAfter(std::chrono::seconds(10), [&fired]() { fired += 10000; });
+    pool.ShutDown();
+    cout << "关闭后设置定时器返回: " << pool.RunAfter(std::chrono::milliseconds(1), []() {}) << "（期望 0）"
+         << endl;
+}
+
+int main() {
+    cout << "========================================" << endl;
+    cout << "    定时器模块测试程序" << endl;
+    cout << "========================================" << endl;
+
+    try {
+        TestRunAfter();
+        TestRunEvery();
+        TestCancel();
+        TestTimeoutPerformance();
+        TestThreadPoolTimer();
+
+        cout << "\n========================================" << endl;
+        cout << "    所有测试完成！" << endl;
+        cout << "========================================" << endl;
+    } catch (const std::exception& e) {
+        cout << "测试异常: " << e.what() << endl;
+        return 1;
+    }
+
+    return 0;
+}